@@ -6,6 +6,7 @@
 #include <string>
 #include <vector>
 #include "Identifier.h"
+#include "Arena.h"
 
 namespace NodeType {
     enum ASTNodeType {
@@ -41,6 +42,14 @@ namespace BinOpType {
     };
 }
 
+namespace IdStorage {
+    enum Type {
+        Unresolved,
+        Local,
+        Global
+    };
+}
+
 struct ASTNode {
     NodeType::ASTNodeType type;
 
@@ -48,21 +57,16 @@ struct ASTNode {
         type = NodeType::Undefined;
     };
 
+    // nodes live in an Arena and are never deleted one by one, so members must not own memory
     virtual ~ASTNode() {};
 };
 
 struct ProgramTranslationNode : ASTNode {
-    std::vector<ASTNode*> statements;
+    ArenaArray<ASTNode*> statements;
 
     ProgramTranslationNode() {
         type = NodeType::ProgramTranslation;
     }
-
-    ~ProgramTranslationNode() {
-        for (const auto& currentStmt : statements) {
-            delete currentStmt;
-        }
-    }
 };
 
 struct BinOpNode : ASTNode {
@@ -75,18 +79,18 @@ struct BinOpNode : ASTNode {
         left = nullptr;
         right = nullptr;
     }
-
-    ~BinOpNode() {
-        delete left;
-        delete right;
-    }
 };
 
 struct ConstNumberNode : ASTNode {
     double value;
+    // exact value of integer constants, may differ from value above 2^53
+    bool isInt;
+    long long intValue;
 
     ConstNumberNode() {
         type = NodeType::ConstNumber;
+        isInt = false;
+        intValue = 0;
     }
 };
 
@@ -99,12 +103,17 @@ struct ConstBoolNode : ASTNode {
 };
 
 struct IdentifierNode : ASTNode {
-    std::string name;
+    StringRef name;
     ValueType::Type valueType;
+    // resolved by SemanticAnalyzer: slot in the current function frame or index in the globals array
+    IdStorage::Type storage;
+    unsigned long slot;
 
     IdentifierNode() {
         type = NodeType::Id;
         valueType = ValueType::Undefined;
+        storage = IdStorage::Unresolved;
+        slot = 0;
     }
 };
 
@@ -117,45 +126,25 @@ struct DeclVarNode : ASTNode {
         id = nullptr;
         expr = nullptr;
     }
-
-    ~DeclVarNode() {
-        delete id;
-        delete expr;
-    }
 };
 
 struct BlockStmtNode : ASTNode {
-    std::vector<ASTNode*> stmtList;
+    ArenaArray<ASTNode*> stmtList;
 
     BlockStmtNode() {
         type = NodeType::CompoundStmt;
     }
-
-    ~BlockStmtNode() {
-        for (const auto& currentStmt : stmtList) {
-            delete currentStmt;
-        }
-    }
 };
 
 struct IfStmtNode : ASTNode {
     ASTNode* condition;
     BlockStmtNode* body;
-    std::vector<IfStmtNode*> elseIfStmts;
+    ArenaArray<IfStmtNode*> elseIfStmts;
     BlockStmtNode* elseBody;
 
     IfStmtNode() {
         type = NodeType::IfStmt;
     }
-
-    ~IfStmtNode() {
-        delete condition;
-        delete body;
-        for (const auto& currentElseIfStmt : elseIfStmts) {
-            delete currentElseIfStmt;
-        }
-        delete elseBody;
-    }
 };
 
 struct ForLoopNode : ASTNode {
@@ -163,16 +152,11 @@ struct ForLoopNode : ASTNode {
     ASTNode* condition;
     BinOpNode* inc;
     BlockStmtNode* body;
+    unsigned int line;
 
     ForLoopNode() {
         type = NodeType::ForLoop;
-    }
-
-    ~ForLoopNode() {
-        delete init;
-        delete condition;
-        delete inc;
-        delete body;
+        line = 0;
     }
 };
 
@@ -182,10 +166,6 @@ struct ReturnStmtNode : ASTNode {
     ReturnStmtNode() {
         type = NodeType::ReturnStmt;
     }
-
-    ~ReturnStmtNode() {
-        delete expression;
-    }
 };
 
 struct BreakStmtNode : ASTNode {
@@ -195,37 +175,33 @@ struct BreakStmtNode : ASTNode {
 };
 
 struct FuncCallNode : ASTNode {
-    std::string name;
-    std::vector<ASTNode*> args;
+    StringRef name;
+    ArenaArray<ASTNode*> args;
     unsigned long argsSize;
 
     FuncCallNode() {
         type = NodeType::FuncCall;
     }
-
-    ~FuncCallNode() {
-        for (const auto& currentArg : args) {
-            delete currentArg;
-        }
-    }
 };
 
 struct DeclFuncNode : ASTNode {
-    std::string name;
+    StringRef name;
     ValueType::Type returnType;
-    std::vector<IdentifierNode*> args;
+    ArenaArray<IdentifierNode*> args;
     unsigned long argsSize;
     BlockStmtNode* body;
+    unsigned long frameSize;
+    // 0 for built-in functions
+    unsigned int line;
+    // set by the semantic analyzer when the function doesn't touch globals, doesn't print
+    // and calls only pure functions, so its result depends only on the arguments
+    bool isPure;
 
     DeclFuncNode() {
         type = NodeType::DeclFunc;
-    }
-
-    ~DeclFuncNode() {
-        for (const auto currentId : args) {
-            delete currentId;
-        }
-        delete body;
+        frameSize = 0;
+        line = 0;
+        isPure = false;
     }
 };
 
@@ -0,0 +1,270 @@
+#include "ASTOptimizer.h"
+
+namespace {
+    bool isConstNumber(ASTNode* node, double value) {
+        return node->type == NodeType::ConstNumber && static_cast<ConstNumberNode*>(node)->value == value;
+    }
+}
+
+unsigned long ASTOptimizer::optimize(ProgramTranslationNode* root) {
+    removedNodesCount = 0;
+
+    for (auto& currentStatement : root->statements) {
+        currentStatement = optimizeStatement(currentStatement);
+    }
+
+    return removedNodesCount;
+}
+
+ASTNode* ASTOptimizer::optimizeStatement(ASTNode* node) {
+    switch (node->type) {
+        case NodeType::BinOp: {
+            BinOpNode* binOp = static_cast<BinOpNode*>(node);
+            if (binOp->binOpType == BinOpType::OperatorAssign) {
+                binOp->right = optimizeExpression(binOp->right);
+                return binOp;
+            }
+            return optimizeExpression(binOp);
+        }
+        case NodeType::FuncCall: {
+            return optimizeExpression(node);
+        }
+        case NodeType::DeclVar: {
+            DeclVarNode* declVar = static_cast<DeclVarNode*>(node);
+            if (declVar->expr != nullptr) {
+                declVar->expr = optimizeExpression(declVar->expr);
+            }
+            break;
+        }
+        case NodeType::DeclFunc: {
+            optimizeBlockStmt(static_cast<DeclFuncNode*>(node)->body);
+            break;
+        }
+        case NodeType::IfStmt: {
+            IfStmtNode* ifStmt = static_cast<IfStmtNode*>(node);
+            ifStmt->condition = optimizeExpression(ifStmt->condition);
+            optimizeBlockStmt(ifStmt->body);
+            for (const auto& currentElseIfStmt : ifStmt->elseIfStmts) {
+                optimizeStatement(currentElseIfStmt);
+            }
+            if (ifStmt->elseBody != nullptr) {
+                optimizeBlockStmt(ifStmt->elseBody);
+            }
+            break;
+        }
+        case NodeType::ForLoop: {
+            ForLoopNode* forLoop = static_cast<ForLoopNode*>(node);
+            if (forLoop->init != nullptr) {
+                forLoop->init = optimizeStatement(forLoop->init);
+            }
+            if (forLoop->condition != nullptr) {
+                forLoop->condition = optimizeExpression(forLoop->condition);
+            }
+            if (forLoop->inc != nullptr) {
+                optimizeStatement(forLoop->inc);
+            }
+            optimizeBlockStmt(forLoop->body);
+            break;
+        }
+        case NodeType::ReturnStmt: {
+            ReturnStmtNode* returnStmt = static_cast<ReturnStmtNode*>(node);
+            if (returnStmt->expression != nullptr) {
+                returnStmt->expression = optimizeExpression(returnStmt->expression);
+            }
+            break;
+        }
+        default: {
+        }
+    }
+
+    return node;
+}
+
+void ASTOptimizer::optimizeBlockStmt(BlockStmtNode* node) {
+    for (auto& currentStatement : node->stmtList) {
+        currentStatement = optimizeStatement(currentStatement);
+    }
+}
+
+ASTNode* ASTOptimizer::optimizeExpression(ASTNode* node) {
+    if (node->type == NodeType::FuncCall) {
+        FuncCallNode* funcCall = static_cast<FuncCallNode*>(node);
+        for (auto& currentArg : funcCall->args) {
+            currentArg = optimizeExpression(currentArg);
+        }
+    } else if (node->type == NodeType::BinOp) {
+        BinOpNode* binOp = static_cast<BinOpNode*>(node);
+        if (binOp->binOpType == BinOpType::OperatorAssign) {
+            binOp->right = optimizeExpression(binOp->right);
+            return binOp;
+        }
+
+        binOp->left = optimizeExpression(binOp->left);
+        binOp->right = optimizeExpression(binOp->right);
+        return foldBinOp(binOp);
+    }
+
+    return node;
+}
+
+ASTNode* ASTOptimizer::foldBinOp(BinOpNode* node) {
+    switch (node->binOpType) {
+        case BinOpType::OperatorPlus:
+        case BinOpType::OperatorMinus:
+        case BinOpType::OperatorMul:
+        case BinOpType::OperatorDiv:
+            return foldMath(node);
+        case BinOpType::OperatorBoolAND:
+        case BinOpType::OperatorBoolOR:
+            return foldBool(node);
+        case BinOpType::OperatorEqual:
+        case BinOpType::OperatorLess:
+        case BinOpType::OperatorGreater:
+            return foldComparison(node);
+        default: {
+            return node;
+        }
+    }
+}
+
+ASTNode* ASTOptimizer::foldMath(BinOpNode* node) {
+    if (node->left->type == NodeType::ConstNumber && node->right->type == NodeType::ConstNumber) {
+        // only exact integer results are folded, bash arithmetic is integer only
+        ConstNumberNode* left = static_cast<ConstNumberNode*>(node->left);
+        ConstNumberNode* right = static_cast<ConstNumberNode*>(node->right);
+        if (!left->isInt || !right->isInt) {
+            return node;
+        }
+
+        long long value;
+        bool isExact;
+        switch (node->binOpType) {
+            case BinOpType::OperatorPlus:
+                isExact = IntArithmetic::add(left->intValue, right->intValue, value);
+                break;
+            case BinOpType::OperatorMinus:
+                isExact = IntArithmetic::sub(left->intValue, right->intValue, value);
+                break;
+            case BinOpType::OperatorMul:
+                isExact = IntArithmetic::mul(left->intValue, right->intValue, value);
+                break;
+            default: {
+                // division by zero and fractions are left to the backend
+                isExact = IntArithmetic::div(left->intValue, right->intValue, value);
+            }
+        }
+        if (!isExact) {
+            return node;
+        }
+
+        left->intValue = value;
+        left->value = static_cast<double>(value);
+        return replace(node, left);
+    }
+
+    switch (node->binOpType) {
+        case BinOpType::OperatorPlus: {
+            if (isConstNumber(node->left, 0)) {
+                return replace(node, node->right);
+            }
+            if (isConstNumber(node->right, 0)) {
+                return replace(node, node->left);
+            }
+            break;
+        }
+        case BinOpType::OperatorMul: {
+            if (isConstNumber(node->left, 1)) {
+                return replace(node, node->right);
+            }
+            if (isConstNumber(node->right, 1)) {
+                return replace(node, node->left);
+            }
+            break;
+        }
+        case BinOpType::OperatorMinus: {
+            if (isConstNumber(node->right, 0)) {
+                return replace(node, node->left);
+            }
+            break;
+        }
+        case BinOpType::OperatorDiv: {
+            if (isConstNumber(node->right, 1)) {
+                return replace(node, node->left);
+            }
+            break;
+        }
+        default: {
+        }
+    }
+
+    return node;
+}
+
+ASTNode* ASTOptimizer::foldBool(BinOpNode* node) {
+    bool isAND = node->binOpType == BinOpType::OperatorBoolAND;
+
+    // constant left operand decides whether the right one is evaluated at all
+    if (node->left->type == NodeType::ConstBool) {
+        bool lhs = static_cast<ConstBoolNode*>(node->left)->value;
+        return replace(node, lhs == isAND ? node->right : node->left);
+    }
+
+    // e && true, e || false, the other way round e would have to be free of side effects
+    if (node->right->type == NodeType::ConstBool && static_cast<ConstBoolNode*>(node->right)->value == isAND) {
+        return replace(node, node->left);
+    }
+
+    return node;
+}
+
+ASTNode* ASTOptimizer::foldComparison(BinOpNode* node) {
+    if (node->left->type == NodeType::ConstNumber && node->right->type == NodeType::ConstNumber) {
+        double lhs = static_cast<ConstNumberNode*>(node->left)->value;
+        double rhs = static_cast<ConstNumberNode*>(node->right)->value;
+
+        bool value;
+        if (node->binOpType == BinOpType::OperatorEqual) {
+            value = lhs == rhs;
+        } else if (node->binOpType == BinOpType::OperatorLess) {
+            value = lhs < rhs;
+        } else {
+            value = lhs > rhs;
+        }
+        return replace(node, newConstBool(value));
+    }
+
+    if (node->binOpType == BinOpType::OperatorEqual &&
+        node->left->type == NodeType::ConstBool && node->right->type == NodeType::ConstBool) {
+        ConstBoolNode* left = static_cast<ConstBoolNode*>(node->left);
+        left->value = left->value == static_cast<ConstBoolNode*>(node->right)->value;
+        return replace(node, left);
+    }
+
+    return node;
+}
+
+ASTNode* ASTOptimizer::replace(ASTNode* node, ASTNode* replacement) {
+    removedNodesCount += countNodes(node) - countNodes(replacement);
+    return replacement;
+}
+
+ASTNode* ASTOptimizer::newConstBool(bool value) {
+    ConstBoolNode* node = arena.create<ConstBoolNode>();
+    node->value = value;
+    return node;
+}
+
+unsigned long ASTOptimizer::countNodes(ASTNode* node) {
+    unsigned long count = 1;
+
+    if (node->type == NodeType::BinOp) {
+        BinOpNode* binOp = static_cast<BinOpNode*>(node);
+        count += countNodes(binOp->left) + countNodes(binOp->right);
+    } else if (node->type == NodeType::FuncCall) {
+        for (const auto& currentArg : static_cast<FuncCallNode*>(node)->args) {
+            count += countNodes(currentArg);
+        }
+    }
+
+    return count;
+}
@@ -0,0 +1,41 @@
+#ifndef REPL_ASTOPTIMIZER_H
+#define REPL_ASTOPTIMIZER_H
+
+#include "ASTNode.h"
+#include "Arena.h"
+#include "IntArithmetic.h"
+
+// folds constant subexpressions and simplifies identities, runs on programs accepted by SemanticAnalyzer
+class ASTOptimizer {
+private:
+    ASTNode* optimizeStatement(ASTNode* node);
+
+    void optimizeBlockStmt(BlockStmtNode* node);
+
+    ASTNode* optimizeExpression(ASTNode* node);
+
+    ASTNode* foldBinOp(BinOpNode* node);
+
+    ASTNode* foldMath(BinOpNode* node);
+
+    ASTNode* foldBool(BinOpNode* node);
+
+    ASTNode* foldComparison(BinOpNode* node);
+
+    ASTNode* replace(ASTNode* node, ASTNode* replacement);
+
+    ASTNode* newConstBool(bool value);
+
+    unsigned long countNodes(ASTNode* node);
+
+    Arena& arena;
+
+    unsigned long removedNodesCount;
+public:
+    explicit ASTOptimizer(Arena& arena) : arena(arena), removedNodesCount(0) {};
+
+    // returns the number of nodes removed from the tree
+    unsigned long optimize(ProgramTranslationNode* root);
+};
+
+#endif //REPL_ASTOPTIMIZER_H
@@ -0,0 +1,56 @@
+#include "Arena.h"
+
+Arena::Block* Arena::newBlock(unsigned long minSize) {
+    unsigned long size = minSize > blockSize ? minSize : blockSize;
+
+    Block* block = static_cast<Block*>(::operator new(sizeof(Block) + size));
+    block->next = head;
+    block->size = size;
+    block->used = 0;
+
+    head = block;
+    return block;
+}
+
+void* Arena::allocate(unsigned long size, unsigned long align) {
+    if (head != nullptr) {
+        char* data = reinterpret_cast<char*>(head + 1);
+        unsigned long start = (reinterpret_cast<unsigned long>(data + head->used) + align - 1) & ~(align - 1);
+        unsigned long offset = start - reinterpret_cast<unsigned long>(data);
+        if (offset + size <= head->size) {
+            head->used = offset + size;
+            return data + offset;
+        }
+    }
+
+    // worst case padding is align - 1 bytes
+    Block* block = newBlock(size + align - 1);
+    char* data = reinterpret_cast<char*>(block + 1);
+    unsigned long start = (reinterpret_cast<unsigned long>(data) + align - 1) & ~(align - 1);
+    unsigned long offset = start - reinterpret_cast<unsigned long>(data);
+    block->used = offset + size;
+    return data + offset;
+}
+
+StringRef Arena::copyString(const StringRef& str) {
+    char* data = static_cast<char*>(allocate(str.length + 1, 1));
+    std::memcpy(data, str.data, str.length);
+    data[str.length] = '\0';
+    return StringRef(data, str.length);
+}
+
+void Arena::release() {
+    while (head != nullptr) {
+        Block* next = head->next;
+        ::operator delete(head);
+        head = next;
+    }
+}
+
+unsigned long Arena::getBlocksCount() const {
+    unsigned long count = 0;
+    for (Block* block = head; block != nullptr; block = block->next) {
+        count++;
+    }
+    return count;
+}
@@ -0,0 +1,96 @@
+#ifndef REPL_ARENA_H
+#define REPL_ARENA_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <new>
+#include <vector>
+#include "StringRef.h"
+
+// fixed-size array stored in an Arena
+template<typename T>
+struct ArenaArray {
+    T* items;
+    unsigned long count;
+
+    ArenaArray() : items(nullptr), count(0) {};
+
+    T* begin() const {
+        return items;
+    }
+
+    T* end() const {
+        return items + count;
+    }
+
+    unsigned long size() const {
+        return count;
+    }
+
+    bool empty() const {
+        return count == 0;
+    }
+
+    T& operator[](unsigned long index) const {
+        return items[index];
+    }
+};
+
+// bump allocator: objects are never destroyed one by one, the whole arena is freed at once,
+// so everything allocated here must not own memory outside of the arena
+class Arena {
+private:
+    struct Block {
+        Block* next;
+        unsigned long size;
+        unsigned long used;
+    };
+
+    Block* newBlock(unsigned long minSize);
+
+    Block* head;
+
+    unsigned long blockSize;
+public:
+    explicit Arena(unsigned long blockSize = 64 * 1024) : head(nullptr), blockSize(blockSize) {};
+
+    Arena(Arena&& other) : head(other.head), blockSize(other.blockSize) {
+        other.head = nullptr;
+    }
+
+    Arena(const Arena&) = delete;
+
+    Arena& operator=(const Arena&) = delete;
+
+    ~Arena() {
+        release();
+    }
+
+    void* allocate(unsigned long size, unsigned long align);
+
+    template<typename T>
+    T* create() {
+        return new(allocate(sizeof(T), alignof(T))) T;
+    }
+
+    template<typename T>
+    ArenaArray<T> copyArray(const std::vector<T>& items) {
+        ArenaArray<T> array;
+        if (!items.empty()) {
+            array.items = static_cast<T*>(allocate(sizeof(T) * items.size(), alignof(T)));
+            std::copy(items.begin(), items.end(), array.items);
+            array.count = items.size();
+        }
+        return array;
+    }
+
+    StringRef copyString(const StringRef& str);
+
+    // frees every block at once, all pointers into the arena become dangling
+    void release();
+
+    unsigned long getBlocksCount() const;
+};
+
+#endif //REPL_ARENA_H
@@ -1,5 +1,8 @@
 #include "BashGenerator.h"
 
+// functions return values through this global instead of printing them in a subshell
+static const char* const returnVariable = "__return";
+
 std::string BashGenerator::generate(ProgramTranslationNode* root) {
     std::string result;
 
@@ -11,39 +14,117 @@ std::string BashGenerator::generate(ProgramTranslationNode* root) {
 }
 
 std::string BashGenerator::generateStatement(ASTNode* node) {
-    std::string result;
+    // calls used as values are hoisted into separate commands placed before the statement
+    std::string oldPendingCalls;
+    oldPendingCalls.swap(pendingCalls);
+    unsigned long oldCallTempCount = callTempCount;
+    callTempCount = 0;
+    FuncCallNode* oldLastHoistedCall = lastHoistedCall;
+    lastHoistedCall = nullptr;
 
-    addTabs(result);
+    std::string statement;
 
     if (node->type == NodeType::BinOp) {
         BinOpNode* binOp = static_cast<BinOpNode*>(node);
-        result += generateBinaryExprAssign(binOp);
+        statement = generateBinaryExprAssign(binOp);
     } else if (node->type == NodeType::DeclVar) {
         DeclVarNode* declVar = static_cast<DeclVarNode*>(node);
-        result += generateDeclVar(declVar);
+        statement = generateDeclVar(declVar);
+        if (functionScope) {
+            // function variables must be local, otherwise recursive calls overwrite them
+            statement = "local " + (statement.empty() ? generateId(declVar->id) : statement);
+        }
     } else if (node->type == NodeType::FuncCall) {
         FuncCallNode* funcCall = static_cast<FuncCallNode*>(node);
-        result += generateFuncCall(funcCall);
+        lastHoistedCall = findLastCall(funcCall->args);
+        statement = generateFuncCall(funcCall);
     } else if (node->type == NodeType::ReturnStmt) {
         ReturnStmtNode* returnStmt = static_cast<ReturnStmtNode*>(node);
-        result += generateReturnStmt(returnStmt);
+        statement = generateReturnStmt(returnStmt);
     } else if (node->type == NodeType::BreakStmt) {
-        result += generateBreakStmt();
+        statement = generateBreakStmt();
     } else if (node->type == NodeType::DeclFunc) {
         DeclFuncNode* declFunc = static_cast<DeclFuncNode*>(node);
-        result += generateDeclFunc(declFunc);
+        statement = generateDeclFunc(declFunc);
     } else if (node->type == NodeType::IfStmt) {
         IfStmtNode* ifStmt = static_cast<IfStmtNode*>(node);
-        result += generateIfStmt(ifStmt);
+        statement = generateIfStmt(ifStmt);
     } else if (node->type == NodeType::ForLoop) {
         ForLoopNode* forLoop = static_cast<ForLoopNode*>(node);
-        result += generateForLoop(forLoop);
+        statement = generateForLoop(forLoop);
     }
 
-    result += "\n";
+    std::string result = pendingCalls;
+    addTabs(result);
+    result += statement + "\n";
+
+    pendingCalls.swap(oldPendingCalls);
+    callTempCount = oldCallTempCount;
+    lastHoistedCall = oldLastHoistedCall;
+
     return result;
 }
 
+std::string BashGenerator::generateHoistedValue(ASTNode* node) {
+    lastHoistedCall = findLastCall(node);
+    return generateGetValue(node);
+}
+
+std::string BashGenerator::generateCondition(ASTNode* node) {
+    std::string condStmt = generateHoistedValue(node);
+    if (node->type == NodeType::BinOp) {
+        condStmt = condStmt.substr(3, condStmt.size() - 5); // remove $(( and ))
+    }
+    return condStmt;
+}
+
+std::string BashGenerator::hoistFuncCall(FuncCallNode* node) {
+    std::string call = generateFuncCall(node);
+    addTabs(pendingCalls);
+    pendingCalls += call + "\n";
+
+    // the last hoisted call of a statement can be read right from the return variable
+    if (node == lastHoistedCall) {
+        return returnVariable;
+    }
+
+    callTempCount++;
+    std::string tempName = "__call" + std::to_string(callTempCount);
+    addTabs(pendingCalls);
+    pendingCalls += (functionScope ? "local " : "") + tempName + "=$" + returnVariable + "\n";
+    return tempName;
+}
+
+FuncCallNode* BashGenerator::findLastCall(ASTNode* node) {
+    // calls are hoisted in post-order: arguments first, left operand before right one
+    if (node->type == NodeType::FuncCall) {
+        FuncCallNode* funcCall = static_cast<FuncCallNode*>(node);
+        if (isFuncReserved(funcCall->name)) {
+            return findLastCall(funcCall->args);
+        }
+        return funcCall;
+    } else if (node->type == NodeType::BinOp) {
+        BinOpNode* binOp = static_cast<BinOpNode*>(node);
+        FuncCallNode* lastCall = findLastCall(binOp->right);
+        return lastCall != nullptr ? lastCall : findLastCall(binOp->left);
+    }
+    return nullptr;
+}
+
+FuncCallNode* BashGenerator::findLastCall(const ArenaArray<ASTNode*>& nodes) {
+    for (unsigned long currentNodeNum = nodes.size(); currentNodeNum > 0; currentNodeNum--) {
+        FuncCallNode* lastCall = findLastCall(nodes[currentNodeNum - 1]);
+        if (lastCall != nullptr) {
+            return lastCall;
+        }
+    }
+    return nullptr;
+}
+
+bool BashGenerator::containsCall(ASTNode* node) {
+    return node != nullptr && findLastCall(node) != nullptr;
+}
+
 std::string BashGenerator::generateGetValue(ASTNode* node) {
     std::string result;
 
@@ -61,7 +142,7 @@ std::string BashGenerator::generateGetValue(ASTNode* node) {
         result = "$" + generateBinaryExprMath(binOp);
     } else if (node->type == NodeType::FuncCall) {
         FuncCallNode* funcCall = static_cast<FuncCallNode*>(node);
-        result = "$(" + generateFuncCall(funcCall) + ")";
+        result = "$" + hoistFuncCall(funcCall);
     }
 
     return result;
@@ -71,7 +152,7 @@ std::string BashGenerator::generateBinaryExprAssign(BinOpNode* node) {
     std::string result;
     IdentifierNode* id = static_cast<IdentifierNode*>(node->left);
 
-    result = generateId(id) + "=" + generateGetValue(node->right);
+    result = generateId(id) + "=" + generateHoistedValue(node->right);
 
     return result;
 }
@@ -85,6 +166,10 @@ std::string BashGenerator::generateConstBool(ConstBoolNode* node) {
 }
 
 std::string BashGenerator::generateConstNumber(ConstNumberNode* node) {
+    if (node->isInt) {
+        return std::to_string(node->intValue);
+    }
+
     std::string stringNum = std::to_string(std::round(node->value));
     while (stringNum.back() == '0') {
         stringNum.pop_back();
@@ -104,7 +189,7 @@ std::string BashGenerator::generateDeclVar(DeclVarNode* node) {
 
     // since assignment operator is right-associative first generate rhs expression
     if (node->expr != nullptr) {
-        rhsExpr = generateGetValue(node->expr);
+        rhsExpr = generateHoistedValue(node->expr);
     }
 
     if (blockScope) {
@@ -121,7 +206,43 @@ std::string BashGenerator::generateDeclVar(DeclVarNode* node) {
     return result;
 }
 
+std::string BashGenerator::generateShortCircuit(BinOpNode* node) {
+    // calls of the right operand are hoisted into a branch, so they run only when the left operand
+    // doesn't decide the result, the same way (( && )) and (( || )) skip the right operand
+    std::string leftValue = generateGetValue(node->left);
+
+    std::string tempName;
+    if (node->left->type == NodeType::FuncCall && !isFuncReserved(static_cast<FuncCallNode*>(node->left)->name)) {
+        // the call has already been saved to a temp
+        tempName = leftValue.substr(1);
+    } else {
+        callTempCount++;
+        tempName = "__call" + std::to_string(callTempCount);
+        addTabs(pendingCalls);
+        pendingCalls += (functionScope ? "local " : "") + tempName + "=" + leftValue + "\n";
+    }
+    addTabs(pendingCalls);
+    pendingCalls += std::string("if ") + (node->binOpType == BinOpType::OperatorBoolOR ? "! " : "") +
+                    "(($" + tempName + ")); then\n";
+
+    tabCount++;
+    std::string rightValue = generateGetValue(node->right);
+    addTabs(pendingCalls);
+    pendingCalls += tempName + "=" + rightValue + "\n";
+    tabCount--;
+
+    addTabs(pendingCalls);
+    pendingCalls += "fi\n";
+
+    return "(($" + tempName + "))";
+}
+
 std::string BashGenerator::generateBinaryExprMath(BinOpNode* node) {
+    if ((node->binOpType == BinOpType::OperatorBoolAND || node->binOpType == BinOpType::OperatorBoolOR) &&
+        containsCall(node->right)) {
+        return generateShortCircuit(node);
+    }
+
     std::string result = "((";
 
     std::string leftResult = generateGetValue(node->left);
@@ -194,7 +315,7 @@ std::string BashGenerator::generateReservedFuncCall(FuncCallNode* node) {
     std::string result;
 
     if (node->name == "print") {
-        result = "echo " + generateGetValue(node->args[0]);
+        result = "echo " + generateHoistedValue(node->args[0]);
     }
 
     return result;
@@ -212,14 +333,19 @@ std::string BashGenerator::generateFuncCall(FuncCallNode* node) {
         result += generateGetValue(currentArg);
     }
 
-    result += " | tail -n1";
     return result;
 }
 
 std::string BashGenerator::generateReturnStmt(ReturnStmtNode* node) {
     std::string result;
     if (node->expression != nullptr) {
-        result = "echo " + generateGetValue(node->expression) + "; return";
+        std::string value = generateHoistedValue(node->expression);
+        if (value == std::string("$") + returnVariable) {
+            // returned call has already left its value in the return variable
+            result = "return";
+        } else {
+            result = std::string(returnVariable) + "=" + value + "; return";
+        }
     } else {
         result = "return";
     }
@@ -241,11 +367,14 @@ std::string BashGenerator::generateDeclFunc(DeclFuncNode* node) {
     }
 
     bool oldBlockScope = blockScope;
+    bool oldFunctionScope = functionScope;
     blockScope = true;
+    functionScope = true;
     for (const auto& currentStmt : node->body->stmtList) {
         result += generateStatement(currentStmt);
     }
     blockScope = oldBlockScope;
+    functionScope = oldFunctionScope;
 
     closeScope();
 
@@ -272,28 +401,44 @@ std::string BashGenerator::generateIfStmt(IfStmtNode* node) {
 
     std::string result = "if ";
 
-    std::string condStmt = generateGetValue(node->condition);
-    if (node->condition->type == NodeType::BinOp) {
-        condStmt = condStmt.substr(3, condStmt.size() - 5); // remove $(( and ))
-    }
-    result += "((" + condStmt + ")); then ";
+    result += "((" + generateCondition(node->condition) + ")); then ";
 
     result += generateBlockStmt(node->body);
 
-    if (!node->elseIfStmts.empty()) {
-        for (const auto& currentElifStmt : node->elseIfStmts) {
-            for (int i = 0; i < tabCount; i++) {
-                result += "    ";
-            }
-            result += "elif ";
-            condStmt = generateGetValue(node->condition);
-            if (node->condition->type == NodeType::BinOp) {
-                condStmt = condStmt.substr(3, condStmt.size() - 5);
-            }
-            result += "((" + condStmt + ")); then ";
-
-            result += generateBlockStmt(currentElifStmt->body);
+    for (unsigned long currentElifNum = 0; currentElifNum < node->elseIfStmts.size(); currentElifNum++) {
+        IfStmtNode* currentElifStmt = node->elseIfStmts[currentElifNum];
+
+        if (containsCall(currentElifStmt->condition)) {
+            // calls of elif condition must run only if previous conditions are false,
+            // so the rest of the chain becomes a nested if inside else branch
+            IfStmtNode restIfStmt;
+            restIfStmt.condition = currentElifStmt->condition;
+            restIfStmt.body = currentElifStmt->body;
+            restIfStmt.elseIfStmts.items = node->elseIfStmts.items + currentElifNum + 1;
+            restIfStmt.elseIfStmts.count = node->elseIfStmts.size() - currentElifNum - 1;
+            restIfStmt.elseBody = node->elseBody;
+
+            addTabs(result);
+            result += "else {\n";
+            tabCount++;
+            result += generateStatement(&restIfStmt);
+            tabCount--;
+            addTabs(result);
+            result += "}\n";
+            addTabs(result);
+            result += "fi";
+
+            closeScope();
+            blockScope = oldBlockScope;
+
+            return result;
         }
+
+        addTabs(result);
+        result += "elif ";
+        result += "((" + generateCondition(currentElifStmt->condition) + ")); then ";
+
+        result += generateBlockStmt(currentElifStmt->body);
     }
 
     if (node->elseBody != nullptr) {
@@ -331,40 +476,50 @@ std::string BashGenerator::generateBlockStmt(BlockStmtNode* node) {
 }
 
 std::string BashGenerator::generateForLoop(ForLoopNode* node) {
-    std::string result = "for ((";
-
     bool oldBlockScope = blockScope;
     blockScope = true;
 
     openScope();
-    if (node->init != nullptr) {
-        std::string initStmt;
-        if (node->init->type == NodeType::DeclVar) {
-            DeclVarNode* declVar = static_cast<DeclVarNode*>(node->init);
-            initStmt = generateDeclVar(declVar);
-        } else {
-            BinOpNode* binOpCondAssign = static_cast<BinOpNode*>(node->init);
-            initStmt = generateBinaryExprAssign(binOpCondAssign);
+
+    std::string result;
+    if (containsCall(node->condition) || containsCall(node->inc)) {
+        result = generateWhileLoop(node);
+    } else {
+        result = "for ((";
+
+        if (node->init != nullptr) {
+            std::string initStmt;
+            if (node->init->type == NodeType::DeclVar) {
+                DeclVarNode* declVar = static_cast<DeclVarNode*>(node->init);
+                initStmt = generateDeclVar(declVar);
+                if (functionScope) {
+                    addTabs(pendingCalls);
+                    pendingCalls += "local " + generateId(declVar->id) + "\n";
+                }
+            } else {
+                BinOpNode* binOpCondAssign = static_cast<BinOpNode*>(node->init);
+                initStmt = generateBinaryExprAssign(binOpCondAssign);
+            }
+            result += initStmt;
         }
-        result += initStmt;
-    }
-    result += "; ";
+        result += "; ";
 
-    if (node->condition != nullptr) {
-        std::string condStmt = generateGetValue(node->condition);
-        result += condStmt;
-    }
-    result += "; ";
+        if (node->condition != nullptr) {
+            std::string condStmt = generateGetValue(node->condition);
+            result += condStmt;
+        }
+        result += "; ";
 
-    if (node->inc != nullptr) {
-        BinOpNode* binOpIncAssign = static_cast<BinOpNode*>(node->inc);
-        std::string incStmt = generateBinaryExprAssign(binOpIncAssign);
-        result += incStmt;
-    }
+        if (node->inc != nullptr) {
+            BinOpNode* binOpIncAssign = static_cast<BinOpNode*>(node->inc);
+            std::string incStmt = generateBinaryExprAssign(binOpIncAssign);
+            result += incStmt;
+        }
 
-    result += ")) ";
+        result += ")) ";
 
-    result += generateBlockStmt(node->body);
+        result += generateBlockStmt(node->body);
+    }
 
     blockScope = oldBlockScope;
 
@@ -373,6 +528,47 @@ std::string BashGenerator::generateForLoop(ForLoopNode* node) {
     return result;
 }
 
+std::string BashGenerator::generateWhileLoop(ForLoopNode* node) {
+    // arithmetic for can not run commands on each iteration, so condition and increment
+    // with calls are evaluated as separate statements of while loop body
+    if (node->init != nullptr) {
+        pendingCalls += generateStatement(node->init);
+    }
+
+    std::string result = "while true; do\n";
+
+    tabCount++;
+
+    if (node->condition != nullptr) {
+        std::string oldPendingCalls;
+        oldPendingCalls.swap(pendingCalls);
+        unsigned long oldCallTempCount = callTempCount;
+        callTempCount = 0;
+
+        std::string condStmt = generateCondition(node->condition);
+        result += pendingCalls;
+        addTabs(result);
+        result += "if ! ((" + condStmt + ")); then break; fi\n";
+
+        pendingCalls.swap(oldPendingCalls);
+        callTempCount = oldCallTempCount;
+    }
+
+    for (const auto& currentStmt : node->body->stmtList) {
+        result += generateStatement(currentStmt);
+    }
+
+    if (node->inc != nullptr) {
+        result += generateStatement(node->inc);
+    }
+
+    tabCount--;
+
+    addTabs(result);
+    result += "done";
+    return result;
+}
+
 int BashGenerator::getOperatorPrecedence(BinOpNode* node) {
     static std::map<BinOpType::Type, int> opPrecedence = {
             std::pair<BinOpType::Type, int>(BinOpType::OperatorMul, 6),
@@ -51,16 +51,32 @@ private:
 
     std::string generateForLoop(ForLoopNode* node);
 
+    std::string generateWhileLoop(ForLoopNode* node);
+
     std::string generateBlockStmt(BlockStmtNode* node);
 
     std::string generateReturnStmt(ReturnStmtNode* node);
 
     std::string generateBinaryExprMath(BinOpNode* node);
 
+    std::string generateShortCircuit(BinOpNode* node);
+
     std::string generateBinaryExprAssign(BinOpNode* node);
 
     std::string generateGetValue(ASTNode* node);
 
+    std::string generateHoistedValue(ASTNode* node);
+
+    std::string generateCondition(ASTNode* node);
+
+    std::string hoistFuncCall(FuncCallNode* node);
+
+    FuncCallNode* findLastCall(ASTNode* node);
+
+    FuncCallNode* findLastCall(const ArenaArray<ASTNode*>& nodes);
+
+    bool containsCall(ASTNode* node);
+
     std::string generateStatement(ASTNode* node);
 
     void addTabs(std::string& result);
@@ -69,11 +85,22 @@ private:
 
     bool blockScope;
 
+    bool functionScope;
+
+    // commands computing call values of the statement being generated
+    std::string pendingCalls;
+
+    unsigned long callTempCount;
+
+    // its value is still in the return variable when the statement runs, so it needs no temp
+    FuncCallNode* lastHoistedCall;
+
     bool isFuncReserved(const std::string& funcName);
 public:
     std::string generate(ProgramTranslationNode* root);
 
-    BashGenerator(): topScope(new Scope(nullptr)), tabCount(0), blockScope(false) {};
+    BashGenerator() : topScope(new Scope(nullptr)), tabCount(0), blockScope(false), functionScope(false),
+                      callTempCount(0), lastHoistedCall(nullptr) {};
 
     ~BashGenerator() {
         delete topScope;
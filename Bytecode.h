@@ -0,0 +1,79 @@
+#ifndef REPL_BYTECODE_H
+#define REPL_BYTECODE_H
+
+#include <string>
+#include <vector>
+
+namespace OpCode {
+    enum Type : unsigned char {
+        PushNumber,
+        PushInt,
+        PushBool,
+        PushUndefined,
+        LoadLocal,
+        StoreLocal,
+        LoadGlobal,
+        StoreGlobal,
+        Pop,
+        Add,
+        Sub,
+        Mul,
+        Div,
+        Equal,
+        Less,
+        Greater,
+        Jump,
+        JumpIfFalse,
+        // keep the value and jump if it decides the result of && or ||, otherwise pop it
+        JumpIfFalseOrPop,
+        JumpIfTrueOrPop,
+        Call,
+        Return,
+        ReturnVoid,
+        ResultValue,
+        // operand is a ResultStatus
+        ResultStatus,
+        ResultVoid,
+        ResultUndefined,
+        ResultOpenBlock,
+        ResultCloseBlock,
+        Halt
+    };
+}
+
+struct Instruction {
+    OpCode::Type op;
+    int operand;
+};
+
+// start of a for loop, the backward Jump to it ends an iteration
+struct LoopInfo {
+    unsigned long start;
+    unsigned int line;
+};
+
+struct Chunk {
+    std::vector<Instruction> code;
+    std::vector<double> numbers;
+    std::vector<long long> ints;
+    std::vector<LoopInfo> loops;
+    unsigned long localsSize;
+
+    Chunk() {
+        localsSize = 0;
+    }
+};
+
+struct BytecodeFunction {
+    std::string name;
+    unsigned long argsSize;
+    unsigned int line;
+    Chunk chunk;
+
+    BytecodeFunction() {
+        argsSize = 0;
+        line = 0;
+    }
+};
+
+#endif //REPL_BYTECODE_H
@@ -0,0 +1,391 @@
+#include "BytecodeCompiler.h"
+#include "EvalResult.h"
+#include <algorithm>
+
+Chunk* BytecodeCompiler::compile(ASTNode* root) {
+    Chunk* chunk = new Chunk;
+
+    currentChunk = chunk;
+    collectResults = true;
+    resultDepth = 0;
+
+    compileStatement(root);
+    emit(OpCode::Halt);
+
+    currentChunk = nullptr;
+    collectResults = false;
+
+    return chunk;
+}
+
+const std::vector<BytecodeFunction*>& BytecodeCompiler::getFunctions() const {
+    return functions;
+}
+
+unsigned long BytecodeCompiler::getGlobalsSize() const {
+    return globalsSize;
+}
+
+void BytecodeCompiler::compileStatement(ASTNode* node) {
+    switch (node->type) {
+        case NodeType::BinOp: {
+            BinOpNode* binOp = static_cast<BinOpNode*>(node);
+            if (binOp->binOpType == BinOpType::OperatorAssign) {
+                compileAssign(binOp);
+            } else {
+                compileExpression(binOp);
+                emit(collectResults ? OpCode::ResultValue : OpCode::Pop);
+            }
+            break;
+        }
+        case NodeType::ConstNumber:
+        case NodeType::ConstBool:
+        case NodeType::Id:
+        case NodeType::FuncCall: {
+            compileExpression(node);
+            emit(collectResults ? OpCode::ResultValue : OpCode::Pop);
+            break;
+        }
+        case NodeType::DeclVar: {
+            compileDeclVar(static_cast<DeclVarNode*>(node));
+            if (collectResults) {
+                emit(OpCode::ResultStatus, ResultStatus::DeclareVariable);
+            }
+            break;
+        }
+        case NodeType::DeclFunc: {
+            compileDeclFunc(static_cast<DeclFuncNode*>(node));
+            if (collectResults) {
+                emit(OpCode::ResultStatus, ResultStatus::DeclareFunc);
+            }
+            break;
+        }
+        case NodeType::IfStmt: {
+            compileIfStmt(static_cast<IfStmtNode*>(node));
+            break;
+        }
+        case NodeType::ForLoop: {
+            compileForLoop(static_cast<ForLoopNode*>(node));
+            break;
+        }
+        case NodeType::ReturnStmt: {
+            compileReturnStmt(static_cast<ReturnStmtNode*>(node));
+            break;
+        }
+        case NodeType::BreakStmt: {
+            compileBreakStmt();
+            break;
+        }
+        default: {
+            throw std::runtime_error("Invalid statement");
+        }
+    }
+}
+
+void BytecodeCompiler::compileExpression(ASTNode* node) {
+    switch (node->type) {
+        case NodeType::ConstNumber: {
+            ConstNumberNode* number = static_cast<ConstNumberNode*>(node);
+            if (number->isInt) {
+                emit(OpCode::PushInt, addInt(number->intValue));
+            } else {
+                emit(OpCode::PushNumber, addNumber(number->value));
+            }
+            break;
+        }
+        case NodeType::ConstBool: {
+            emit(OpCode::PushBool, static_cast<ConstBoolNode*>(node)->value ? 1 : 0);
+            break;
+        }
+        case NodeType::Id: {
+            loadId(static_cast<IdentifierNode*>(node));
+            break;
+        }
+        case NodeType::FuncCall: {
+            compileFuncCall(static_cast<FuncCallNode*>(node));
+            break;
+        }
+        case NodeType::BinOp: {
+            BinOpNode* binOp = static_cast<BinOpNode*>(node);
+
+            if (binOp->binOpType == BinOpType::OperatorBoolAND || binOp->binOpType == BinOpType::OperatorBoolOR) {
+                // left operand decides whether the right one is evaluated at all
+                compileExpression(binOp->left);
+                unsigned long shortCircuitJump = emit(binOp->binOpType == BinOpType::OperatorBoolAND ?
+                                                      OpCode::JumpIfFalseOrPop : OpCode::JumpIfTrueOrPop);
+                compileExpression(binOp->right);
+                patchJump(shortCircuitJump);
+                break;
+            }
+
+            compileExpression(binOp->left);
+            compileExpression(binOp->right);
+
+            switch (binOp->binOpType) {
+                case BinOpType::OperatorPlus:
+                    emit(OpCode::Add);
+                    break;
+                case BinOpType::OperatorMinus:
+                    emit(OpCode::Sub);
+                    break;
+                case BinOpType::OperatorMul:
+                    emit(OpCode::Mul);
+                    break;
+                case BinOpType::OperatorDiv:
+                    emit(OpCode::Div);
+                    break;
+                case BinOpType::OperatorEqual:
+                    emit(OpCode::Equal);
+                    break;
+                case BinOpType::OperatorLess:
+                    emit(OpCode::Less);
+                    break;
+                case BinOpType::OperatorGreater:
+                    emit(OpCode::Greater);
+                    break;
+                default: {
+                    throw std::runtime_error("Invalid expression");
+                }
+            }
+            break;
+        }
+        default: {
+            throw std::runtime_error("Invalid expression");
+        }
+    }
+}
+
+void BytecodeCompiler::compileAssign(BinOpNode* node) {
+    IdentifierNode* id = static_cast<IdentifierNode*>(node->left);
+
+    if (node->right->type == NodeType::BinOp &&
+        static_cast<BinOpNode*>(node->right)->binOpType == BinOpType::OperatorAssign) {
+        // chained assignment has no value, so Evaluator leaves lhs untouched
+        if (collectResults) {
+            emit(OpCode::ResultUndefined);
+        }
+        return;
+    }
+
+    compileExpression(node->right);
+    storeId(id);
+
+    if (collectResults) {
+        emit(OpCode::ResultStatus, ResultStatus::AssignValue);
+    }
+}
+
+void BytecodeCompiler::compileDeclVar(DeclVarNode* node) {
+    // rhs is evaluated before the variable is declared
+    if (node->expr != nullptr) {
+        compileExpression(node->expr);
+    } else {
+        emit(OpCode::PushUndefined);
+    }
+
+    declareId(node->id);
+    storeId(node->id);
+}
+
+void BytecodeCompiler::compileDeclFunc(DeclFuncNode* node) {
+    BytecodeFunction* func = new BytecodeFunction;
+    func->name = node->name;
+    func->argsSize = node->argsSize;
+    func->line = node->line;
+
+    functionIndexes[node->name] = functions.size();
+    functions.emplace_back(func);
+
+    Chunk* oldChunk = currentChunk;
+    bool oldCollectResults = collectResults;
+    std::vector<LoopContext> oldLoops;
+    oldLoops.swap(loops);
+
+    // slots were assigned by SemanticAnalyzer, args occupy the first ones
+    currentChunk = &func->chunk;
+    currentChunk->localsSize = node->frameSize;
+    collectResults = false;
+
+    for (const auto& currentStmt : node->body->stmtList) {
+        compileStatement(currentStmt);
+    }
+    emit(OpCode::ReturnVoid);
+
+    currentChunk = oldChunk;
+    collectResults = oldCollectResults;
+    loops.swap(oldLoops);
+}
+
+void BytecodeCompiler::compileFuncCall(FuncCallNode* node) {
+    if (node->name == "print") {
+        // built-in print returns its argument
+        compileExpression(node->args[0]);
+        return;
+    }
+
+    for (const auto& currentArg : node->args) {
+        compileExpression(currentArg);
+    }
+
+    emit(OpCode::Call, static_cast<int>(functionIndexes.at(node->name)));
+}
+
+void BytecodeCompiler::compileReturnStmt(ReturnStmtNode* node) {
+    if (node->expression != nullptr) {
+        compileExpression(node->expression);
+        emit(OpCode::Return);
+    } else {
+        emit(OpCode::ReturnVoid);
+    }
+}
+
+void BytecodeCompiler::compileBreakStmt() {
+    LoopContext& loop = loops.back();
+
+    if (collectResults) {
+        // close every result block opened since the loop body started, including the body itself
+        for (unsigned long currentDepth = resultDepth; currentDepth >= loop.resultDepth; currentDepth--) {
+            emit(OpCode::ResultCloseBlock);
+        }
+    }
+
+    loop.breakJumps.emplace_back(emit(OpCode::Jump));
+}
+
+void BytecodeCompiler::compileBlockStmt(BlockStmtNode* node) {
+    if (collectResults) {
+        emit(OpCode::ResultOpenBlock);
+        resultDepth++;
+    }
+
+    for (const auto& currentStmt : node->stmtList) {
+        compileStatement(currentStmt);
+    }
+
+    if (collectResults) {
+        emit(OpCode::ResultCloseBlock);
+        resultDepth--;
+    }
+}
+
+void BytecodeCompiler::compileIfStmt(IfStmtNode* node) {
+    std::vector<unsigned long> endJumps;
+
+    compileExpression(node->condition);
+    unsigned long nextBranchJump = emit(OpCode::JumpIfFalse);
+    compileBlockStmt(node->body);
+    endJumps.emplace_back(emit(OpCode::Jump));
+
+    for (const auto& currentElseIfStmt : node->elseIfStmts) {
+        patchJump(nextBranchJump);
+
+        compileExpression(currentElseIfStmt->condition);
+        nextBranchJump = emit(OpCode::JumpIfFalse);
+        compileBlockStmt(currentElseIfStmt->body);
+        endJumps.emplace_back(emit(OpCode::Jump));
+    }
+
+    patchJump(nextBranchJump);
+    if (node->elseBody != nullptr) {
+        compileBlockStmt(node->elseBody);
+    } else if (collectResults) {
+        emit(OpCode::ResultVoid);
+    }
+
+    for (const auto& currentJump : endJumps) {
+        patchJump(currentJump);
+    }
+}
+
+void BytecodeCompiler::compileForLoop(ForLoopNode* node) {
+    if (collectResults) {
+        emit(OpCode::ResultOpenBlock);
+        resultDepth++;
+    }
+
+    bool oldCollectResults = collectResults;
+    collectResults = false;
+    if (node->init != nullptr) {
+        compileStatement(node->init);
+    }
+    collectResults = oldCollectResults;
+
+    unsigned long loopStart = currentChunk->code.size();
+    currentChunk->loops.emplace_back(LoopInfo{loopStart, node->line});
+
+    long exitJump = -1;
+    if (node->condition != nullptr) {
+        compileExpression(node->condition);
+        exitJump = static_cast<long>(emit(OpCode::JumpIfFalse));
+    }
+
+    loops.emplace_back(LoopContext());
+    loops.back().resultDepth = resultDepth + 1;
+
+    compileBlockStmt(node->body);
+
+    collectResults = false;
+    if (node->inc != nullptr) {
+        compileStatement(node->inc);
+    }
+    collectResults = oldCollectResults;
+
+    emit(OpCode::Jump, static_cast<int>(loopStart));
+
+    if (exitJump != -1) {
+        patchJump(static_cast<unsigned long>(exitJump));
+    }
+    for (const auto& currentJump : loops.back().breakJumps) {
+        patchJump(currentJump);
+    }
+    loops.pop_back();
+
+    if (collectResults) {
+        emit(OpCode::ResultCloseBlock);
+        resultDepth--;
+    }
+}
+
+void BytecodeCompiler::loadId(IdentifierNode* id) {
+    if (id->storage == IdStorage::Global) {
+        emit(OpCode::LoadGlobal, static_cast<int>(id->slot));
+    } else {
+        emit(OpCode::LoadLocal, static_cast<int>(id->slot));
+    }
+}
+
+void BytecodeCompiler::storeId(IdentifierNode* id) {
+    if (id->storage == IdStorage::Global) {
+        emit(OpCode::StoreGlobal, static_cast<int>(id->slot));
+    } else {
+        emit(OpCode::StoreLocal, static_cast<int>(id->slot));
+    }
+}
+
+void BytecodeCompiler::declareId(IdentifierNode* id) {
+    if (id->storage == IdStorage::Global) {
+        globalsSize = std::max(globalsSize, id->slot + 1);
+    } else {
+        currentChunk->localsSize = std::max(currentChunk->localsSize, id->slot + 1);
+    }
+}
+
+unsigned long BytecodeCompiler::emit(OpCode::Type op, int operand) {
+    currentChunk->code.emplace_back(Instruction{op, operand});
+    return currentChunk->code.size() - 1;
+}
+
+void BytecodeCompiler::patchJump(unsigned long jumpPos) {
+    currentChunk->code[jumpPos].operand = static_cast<int>(currentChunk->code.size());
+}
+
+int BytecodeCompiler::addNumber(double value) {
+    currentChunk->numbers.emplace_back(value);
+    return static_cast<int>(currentChunk->numbers.size() - 1);
+}
+
+int BytecodeCompiler::addInt(long long value) {
+    currentChunk->ints.emplace_back(value);
+    return static_cast<int>(currentChunk->ints.size() - 1);
+}
+
@@ -0,0 +1,88 @@
+#ifndef REPL_BYTECODECOMPILER_H
+#define REPL_BYTECODECOMPILER_H
+
+#include "ASTNode.h"
+#include "Bytecode.h"
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+class BytecodeCompiler {
+private:
+    struct LoopContext {
+        std::vector<unsigned long> breakJumps;
+        unsigned long resultDepth;
+    };
+
+    void compileStatement(ASTNode* node);
+
+    void compileExpression(ASTNode* node);
+
+    void compileAssign(BinOpNode* node);
+
+    void compileDeclVar(DeclVarNode* node);
+
+    void compileDeclFunc(DeclFuncNode* node);
+
+    void compileFuncCall(FuncCallNode* node);
+
+    void compileReturnStmt(ReturnStmtNode* node);
+
+    void compileBreakStmt();
+
+    void compileBlockStmt(BlockStmtNode* node);
+
+    void compileIfStmt(IfStmtNode* node);
+
+    void compileForLoop(ForLoopNode* node);
+
+    void loadId(IdentifierNode* id);
+
+    void storeId(IdentifierNode* id);
+
+    void declareId(IdentifierNode* id);
+
+    unsigned long emit(OpCode::Type op, int operand = 0);
+
+    void patchJump(unsigned long jumpPos);
+
+    int addNumber(double value);
+
+    int addInt(long long value);
+
+
+    Chunk* currentChunk;
+
+    bool collectResults;
+
+    unsigned long resultDepth;
+
+    std::vector<LoopContext> loops;
+
+    unsigned long globalsSize;
+
+    std::unordered_map<std::string, unsigned long> functionIndexes;
+
+    std::vector<BytecodeFunction*> functions;
+public:
+    BytecodeCompiler() : currentChunk(nullptr), collectResults(false), resultDepth(0), globalsSize(0) {};
+
+    ~BytecodeCompiler() {
+        for (const auto& currentFunc : functions) {
+            delete currentFunc;
+        }
+    }
+
+    // functions are owned, so a copy would delete them twice
+    BytecodeCompiler(const BytecodeCompiler&) = delete;
+
+    BytecodeCompiler& operator=(const BytecodeCompiler&) = delete;
+
+    Chunk* compile(ASTNode* root);
+
+    const std::vector<BytecodeFunction*>& getFunctions() const;
+
+    unsigned long getGlobalsSize() const;
+};
+
+#endif //REPL_BYTECODECOMPILER_H
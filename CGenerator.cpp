@@ -0,0 +1,565 @@
+#include "CGenerator.h"
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <cstdio>
+
+// numbers stay int64 while they are exact and fall back to double otherwise, as in IntArithmetic
+static const char* const runtime =
+        "#include <limits.h>\n"
+        "#include <math.h>\n"
+        "#include <stdbool.h>\n"
+        "#include <stdio.h>\n"
+        "\n"
+        "typedef struct {\n"
+        "    bool isInt;\n"
+        "    long long i;\n"
+        "    double d;\n"
+        "} Number;\n"
+        "\n"
+        "static inline Number num_int(long long i) {\n"
+        "    Number n = {true, i, 0};\n"
+        "    return n;\n"
+        "}\n"
+        "\n"
+        "static inline Number num_double(double d) {\n"
+        "    Number n = {false, 0, d};\n"
+        "    return n;\n"
+        "}\n"
+        "\n"
+        "static inline double num_get(Number n) {\n"
+        "    return n.isInt ? (double) n.i : n.d;\n"
+        "}\n"
+        "\n"
+        "static inline Number num_add(Number a, Number b) {\n"
+        "    if (a.isInt && b.isInt && (b.i >= 0 ? a.i <= LLONG_MAX - b.i : a.i >= LLONG_MIN - b.i)) {\n"
+        "        return num_int(a.i + b.i);\n"
+        "    }\n"
+        "    return num_double(num_get(a) + num_get(b));\n"
+        "}\n"
+        "\n"
+        "static inline Number num_sub(Number a, Number b) {\n"
+        "    if (a.isInt && b.isInt && (b.i >= 0 ? a.i >= LLONG_MIN + b.i : a.i <= LLONG_MAX + b.i)) {\n"
+        "        return num_int(a.i - b.i);\n"
+        "    }\n"
+        "    return num_double(num_get(a) - num_get(b));\n"
+        "}\n"
+        "\n"
+        "static inline bool num_mul_fits(long long a, long long b) {\n"
+        "    if (a == 0 || b == 0) {\n"
+        "        return true;\n"
+        "    }\n"
+        "    if (a > 0) {\n"
+        "        return b > 0 ? a <= LLONG_MAX / b : b >= LLONG_MIN / a;\n"
+        "    }\n"
+        "    return b > 0 ? a >= LLONG_MIN / b : a >= LLONG_MAX / b;\n"
+        "}\n"
+        "\n"
+        "static inline Number num_mul(Number a, Number b) {\n"
+        "    if (a.isInt && b.isInt && num_mul_fits(a.i, b.i)) {\n"
+        "        return num_int(a.i * b.i);\n"
+        "    }\n"
+        "    return num_double(num_get(a) * num_get(b));\n"
+        "}\n"
+        "\n"
+        "static inline Number num_div(Number a, Number b) {\n"
+        "    if (a.isInt && b.isInt && b.i != 0 && !(a.i == LLONG_MIN && b.i == -1) && a.i % b.i == 0) {\n"
+        "        return num_int(a.i / b.i);\n"
+        "    }\n"
+        "    return num_double(num_get(a) / num_get(b));\n"
+        "}\n"
+        "\n"
+        "static inline bool num_eq(Number a, Number b) {\n"
+        "    return a.isInt && b.isInt ? a.i == b.i : num_get(a) == num_get(b);\n"
+        "}\n"
+        "\n"
+        "static inline bool num_lt(Number a, Number b) {\n"
+        "    return a.isInt && b.isInt ? a.i < b.i : num_get(a) < num_get(b);\n"
+        "}\n"
+        "\n"
+        "static inline bool num_gt(Number a, Number b) {\n"
+        "    return a.isInt && b.isInt ? a.i > b.i : num_get(a) > num_get(b);\n"
+        "}\n"
+        "\n"
+        "static inline Number print_num(Number n) {\n"
+        "    if (n.isInt) {\n"
+        "        printf(\"%lld\\n\", n.i);\n"
+        "    } else {\n"
+        "        printf(\"%g\\n\", n.d);\n"
+        "    }\n"
+        "    return n;\n"
+        "}\n"
+        "\n"
+        "static inline bool print_bool(bool b) {\n"
+        "    puts(b ? \"true\" : \"false\");\n"
+        "    return b;\n"
+        "}\n"
+        "\n";
+
+std::string CGenerator::generate(ProgramTranslationNode* root) {
+    std::string funcs;
+    std::string mainBody;
+
+    tabCount = 1;
+    for (const auto& currentStatement : root->statements) {
+        if (currentStatement->type == NodeType::DeclFunc) {
+            funcs += generateDeclFunc(static_cast<DeclFuncNode*>(currentStatement)) + "\n";
+        } else {
+            mainBody += generateStatement(currentStatement);
+        }
+    }
+
+    std::string result = runtime;
+    if (!globals.empty()) {
+        result += globals + "\n";
+    }
+    result += funcs;
+    result += "int main(void) {\n" + temps + mainBody + "    return 0;\n}\n";
+
+    return result;
+}
+
+std::string CGenerator::generateStatement(ASTNode* node) {
+    std::string statement;
+
+    switch (node->type) {
+        case NodeType::BinOp: {
+            BinOpNode* binOp = static_cast<BinOpNode*>(node);
+            if (binOp->binOpType != BinOpType::OperatorAssign) {
+                statement = "(void) " + generateExpression(binOp) + ";";
+            } else if (!isChainedAssign(binOp)) {
+                statement = generateAssign(binOp) + ";";
+            }
+            // chained assignment has no value, so the interpreters leave lhs untouched
+            break;
+        }
+        case NodeType::ConstNumber:
+        case NodeType::ConstBool:
+        case NodeType::Id: {
+            statement = "(void) " + generateExpression(node) + ";";
+            break;
+        }
+        case NodeType::FuncCall: {
+            statement = generateExpression(node) + ";";
+            break;
+        }
+        case NodeType::DeclVar: {
+            statement = generateDeclVar(static_cast<DeclVarNode*>(node));
+            break;
+        }
+        case NodeType::IfStmt: {
+            statement = generateIfStmt(static_cast<IfStmtNode*>(node));
+            break;
+        }
+        case NodeType::ForLoop: {
+            statement = generateForLoop(static_cast<ForLoopNode*>(node));
+            break;
+        }
+        case NodeType::ReturnStmt: {
+            statement = generateReturnStmt(static_cast<ReturnStmtNode*>(node));
+            break;
+        }
+        case NodeType::BreakStmt: {
+            statement = "break;";
+            break;
+        }
+        default: {
+            throw std::runtime_error("Invalid statement");
+        }
+    }
+
+    if (statement.empty()) {
+        return statement;
+    }
+
+    std::string result;
+    addTabs(result);
+    result += statement + "\n";
+    return result;
+}
+
+std::string CGenerator::generateDeclVar(DeclVarNode* node) {
+    ValueType::Type type = node->expr != nullptr ? getStaticType(node->expr) : node->id->valueType;
+
+    // rhs still sees the names of outer scopes
+    std::string value;
+    if (node->expr != nullptr) {
+        value = generateExpression(node->expr);
+    }
+    std::string name = declareId(node->id);
+
+    if (!blockScope) {
+        // top-level variables are visible to functions, so they live at file scope
+        globals += "static " + getCType(type) + " " + name + ";\n";
+        return value.empty() ? value : name + " = " + value + ";";
+    }
+
+    if (value.empty()) {
+        value = type == ValueType::Bool ? "false" : "num_int(0)";
+    }
+    return getCType(type) + " " + name + " = " + value + ";";
+}
+
+std::string CGenerator::generateDeclFunc(DeclFuncNode* node) {
+    // declared before its body, so recursive calls know the return type
+    functions[node->name] = node;
+
+    std::string oldTemps;
+    oldTemps.swap(temps);
+    unsigned long oldTempCount = tempCount;
+    tempCount = 0;
+    bool oldBlockScope = blockScope;
+    blockScope = true;
+    openScope();
+
+    std::string params;
+    for (const auto& currentArg : node->args) {
+        std::string name = "p_" + std::string(currentArg->name);
+        topScope->names[currentArg->name] = name;
+        params += (params.empty() ? "" : ", ") + getCType(currentArg->valueType) + " " + name;
+    }
+
+    std::string body;
+    for (const auto& currentStmt : node->body->stmtList) {
+        body += generateStatement(currentStmt);
+    }
+
+    std::string returnType = "void";
+    if (node->returnType != ValueType::Void) {
+        // the interpreters give void when the end of the body is reached, C needs a value of the return type
+        returnType = getCType(node->returnType);
+        addTabs(body);
+        body += std::string("return ") + (node->returnType == ValueType::Bool ? "false" : "num_int(0)") + ";\n";
+    }
+
+    std::string result = "static " + returnType + " f_" + std::string(node->name) + "(" +
+                         (params.empty() ? "void" : params) + ") {\n" + temps + body + "}\n";
+
+    closeScope();
+    blockScope = oldBlockScope;
+    temps.swap(oldTemps);
+    tempCount = oldTempCount;
+
+    return result;
+}
+
+std::string CGenerator::generateIfStmt(IfStmtNode* node) {
+    std::string result = "if (" + generateExpression(node->condition) + ") " + generateBlockStmt(node->body);
+
+    for (const auto& currentElseIfStmt : node->elseIfStmts) {
+        result += " else if (" + generateExpression(currentElseIfStmt->condition) + ") " +
+                  generateBlockStmt(currentElseIfStmt->body);
+    }
+
+    if (node->elseBody != nullptr) {
+        result += " else " + generateBlockStmt(node->elseBody);
+    }
+
+    return result;
+}
+
+std::string CGenerator::generateForLoop(ForLoopNode* node) {
+    bool oldBlockScope = blockScope;
+    blockScope = true;
+    openScope();
+
+    std::string init = ";";
+    if (node->init != nullptr && node->init->type == NodeType::DeclVar) {
+        init = generateDeclVar(static_cast<DeclVarNode*>(node->init));
+    } else if (node->init != nullptr) {
+        init = generateAssign(static_cast<BinOpNode*>(node->init)) + ";";
+    }
+
+    std::string condition;
+    if (node->condition != nullptr) {
+        condition = " " + generateExpression(node->condition);
+    }
+
+    std::string inc;
+    if (node->inc != nullptr) {
+        inc = " " + generateAssign(node->inc);
+    }
+
+    std::string result = "for (" + init + condition + ";" + inc + ") " + generateBlockStmt(node->body);
+
+    closeScope();
+    blockScope = oldBlockScope;
+
+    return result;
+}
+
+std::string CGenerator::generateBlockStmt(BlockStmtNode* node) {
+    bool oldBlockScope = blockScope;
+    blockScope = true;
+    openScope();
+
+    std::string result = "{\n";
+    tabCount++;
+    for (const auto& currentStmt : node->stmtList) {
+        result += generateStatement(currentStmt);
+    }
+    tabCount--;
+    addTabs(result);
+    result += "}";
+
+    closeScope();
+    blockScope = oldBlockScope;
+
+    return result;
+}
+
+std::string CGenerator::generateReturnStmt(ReturnStmtNode* node) {
+    if (node->expression == nullptr) {
+        return "return;";
+    }
+
+    return "return " + generateExpression(node->expression) + ";";
+}
+
+std::string CGenerator::generateAssign(BinOpNode* node) {
+    IdentifierNode* id = static_cast<IdentifierNode*>(node->left);
+
+    return lookTopId(id->name) + " = " + generateExpression(node->right);
+}
+
+std::string CGenerator::generateExpression(ASTNode* node) {
+    switch (node->type) {
+        case NodeType::ConstNumber: {
+            return generateConstNumber(static_cast<ConstNumberNode*>(node));
+        }
+        case NodeType::ConstBool: {
+            return static_cast<ConstBoolNode*>(node)->value ? "true" : "false";
+        }
+        case NodeType::Id: {
+            return lookTopId(static_cast<IdentifierNode*>(node)->name);
+        }
+        case NodeType::BinOp: {
+            return generateBinOp(static_cast<BinOpNode*>(node));
+        }
+        case NodeType::FuncCall: {
+            return generateFuncCall(static_cast<FuncCallNode*>(node));
+        }
+        default: {
+            throw std::runtime_error("Invalid expression");
+        }
+    }
+}
+
+std::string CGenerator::generateBinOp(BinOpNode* node) {
+    // && and || are sequence points in C too, so the right operand runs only when needed
+    if (node->binOpType == BinOpType::OperatorBoolAND) {
+        return "(" + generateExpression(node->left) + " && " + generateExpression(node->right) + ")";
+    } else if (node->binOpType == BinOpType::OperatorBoolOR) {
+        return "(" + generateExpression(node->left) + " || " + generateExpression(node->right) + ")";
+    }
+
+    std::vector<std::string> values;
+    std::string sequence = generateOperands({node->left, node->right}, values);
+
+    std::string result;
+    switch (node->binOpType) {
+        case BinOpType::OperatorPlus: {
+            result = "num_add(" + values[0] + ", " + values[1] + ")";
+            break;
+        }
+        case BinOpType::OperatorMinus: {
+            result = "num_sub(" + values[0] + ", " + values[1] + ")";
+            break;
+        }
+        case BinOpType::OperatorMul: {
+            result = "num_mul(" + values[0] + ", " + values[1] + ")";
+            break;
+        }
+        case BinOpType::OperatorDiv: {
+            result = "num_div(" + values[0] + ", " + values[1] + ")";
+            break;
+        }
+        case BinOpType::OperatorEqual: {
+            if (getStaticType(node->left) == ValueType::Bool) {
+                result = "(" + values[0] + " == " + values[1] + ")";
+            } else {
+                result = "num_eq(" + values[0] + ", " + values[1] + ")";
+            }
+            break;
+        }
+        case BinOpType::OperatorLess: {
+            result = "num_lt(" + values[0] + ", " + values[1] + ")";
+            break;
+        }
+        case BinOpType::OperatorGreater: {
+            result = "num_gt(" + values[0] + ", " + values[1] + ")";
+            break;
+        }
+        default: {
+            throw std::runtime_error("Invalid expression");
+        }
+    }
+
+    return sequence.empty() ? result : "(" + sequence + result + ")";
+}
+
+std::string CGenerator::generateFuncCall(FuncCallNode* node) {
+    if (node->name == "print") {
+        ASTNode* arg = node->args[0];
+        return (getStaticType(arg) == ValueType::Bool ? "print_bool(" : "print_num(") + generateExpression(arg) + ")";
+    }
+
+    std::vector<std::string> values;
+    std::string sequence = generateOperands(std::vector<ASTNode*>(node->args.begin(), node->args.end()), values);
+
+    std::string result = "f_" + std::string(node->name) + "(";
+    for (unsigned long currentArgNum = 0; currentArgNum != values.size(); currentArgNum++) {
+        result += (currentArgNum != 0 ? ", " : "") + values[currentArgNum];
+    }
+    result += ")";
+
+    return sequence.empty() ? result : "(" + sequence + result + ")";
+}
+
+std::string CGenerator::generateConstNumber(ConstNumberNode* node) {
+    if (node->isInt) {
+        // the literal of LLONG_MIN doesn't fit, only its negation would be an int literal
+        return node->intValue == LLONG_MIN ? "num_int(LLONG_MIN)" : "num_int(" + std::to_string(node->intValue) + "LL)";
+    }
+
+    if (std::isnan(node->value)) {
+        return "num_double(NAN)";
+    } else if (std::isinf(node->value)) {
+        return node->value > 0 ? "num_double(INFINITY)" : "num_double(-INFINITY)";
+    }
+
+    // enough digits to read back the same double
+    char buffer[32];
+    std::snprintf(buffer, sizeof(buffer), "%.17g", node->value);
+    return "num_double(" + std::string(buffer) + ")";
+}
+
+std::string CGenerator::generateOperands(const std::vector<ASTNode*>& operands, std::vector<std::string>& values) {
+    // C leaves the order of operands open, the interpreters go from left to right, so as soon as
+    // a call may change a variable or print, every operand is evaluated into a temp in order
+    bool isSequenced = operands.size() > 1 && std::any_of(operands.begin(), operands.end(), [this](ASTNode* node) {
+        return containsCall(node);
+    });
+
+    std::string sequence;
+    for (const auto& currentOperand : operands) {
+        std::string value = generateExpression(currentOperand);
+        if (isSequenced && currentOperand->type != NodeType::ConstNumber &&
+            currentOperand->type != NodeType::ConstBool) {
+            std::string temp = newTemp(getStaticType(currentOperand));
+            sequence += temp + " = " + value + ", ";
+            value = temp;
+        }
+        values.emplace_back(value);
+    }
+
+    return sequence;
+}
+
+std::string CGenerator::newTemp(ValueType::Type type) {
+    tempCount++;
+    std::string name = "t" + std::to_string(tempCount);
+    temps += "    " + getCType(type) + " " + name + ";\n";
+    return name;
+}
+
+std::string CGenerator::getCType(ValueType::Type type) {
+    return type == ValueType::Bool ? "bool" : "Number";
+}
+
+ValueType::Type CGenerator::getStaticType(ASTNode* node) {
+    switch (node->type) {
+        case NodeType::ConstNumber: {
+            return ValueType::Number;
+        }
+        case NodeType::ConstBool: {
+            return ValueType::Bool;
+        }
+        case NodeType::Id: {
+            return static_cast<IdentifierNode*>(node)->valueType;
+        }
+        case NodeType::FuncCall: {
+            FuncCallNode* funcCall = static_cast<FuncCallNode*>(node);
+            if (funcCall->name == "print") {
+                return getStaticType(funcCall->args[0]);
+            }
+            return functions.at(funcCall->name)->returnType;
+        }
+        case NodeType::BinOp: {
+            switch (static_cast<BinOpNode*>(node)->binOpType) {
+                case BinOpType::OperatorPlus:
+                case BinOpType::OperatorMinus:
+                case BinOpType::OperatorMul:
+                case BinOpType::OperatorDiv: {
+                    return ValueType::Number;
+                }
+                case BinOpType::OperatorAssign: {
+                    return ValueType::Undefined;
+                }
+                default: {
+                    return ValueType::Bool;
+                }
+            }
+        }
+        default: {
+            return ValueType::Undefined;
+        }
+    }
+}
+
+bool CGenerator::containsCall(ASTNode* node) {
+    if (node->type == NodeType::FuncCall) {
+        return true;
+    } else if (node->type == NodeType::BinOp) {
+        BinOpNode* binOp = static_cast<BinOpNode*>(node);
+        return containsCall(binOp->left) || containsCall(binOp->right);
+    }
+    return false;
+}
+
+bool CGenerator::isChainedAssign(BinOpNode* node) {
+    return node->right->type == NodeType::BinOp &&
+           static_cast<BinOpNode*>(node->right)->binOpType == BinOpType::OperatorAssign;
+}
+
+std::string CGenerator::declareId(IdentifierNode* id) {
+    // names get a prefix, so they never clash with C keywords or the runtime, and variables of
+    // blocks get a number, so a declaration can't hide the variable its initializer reads
+    std::string name;
+    if (blockScope) {
+        declCount++;
+        name = "l" + std::to_string(declCount) + "_" + std::string(id->name);
+    } else {
+        name = "g_" + std::string(id->name);
+    }
+    topScope->names[id->name] = name;
+
+    return name;
+}
+
+void CGenerator::openScope() {
+    topScope = new Scope(topScope);
+}
+
+void CGenerator::closeScope() {
+    Scope* oldScope = topScope;
+    topScope = topScope->outer;
+    delete oldScope;
+}
+
+std::string CGenerator::lookTopId(const std::string& id) {
+    for (Scope* scope = topScope; scope != nullptr; scope = scope->outer) {
+        auto name = scope->names.find(id);
+        if (name != scope->names.end()) {
+            return name->second;
+        }
+    }
+
+    return "";
+}
+
+void CGenerator::addTabs(std::string& result) {
+    for (int i = 0; i < tabCount; i++) {
+        result += "    ";
+    }
+}
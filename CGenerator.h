@@ -0,0 +1,94 @@
+#ifndef REPL_CGENERATOR_H
+#define REPL_CGENERATOR_H
+
+#include "ASTNode.h"
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// emits a C99 program for a checked AST, numbers keep the int64 / double semantics of the interpreters
+class CGenerator {
+private:
+    struct Scope {
+        Scope* outer;
+        std::unordered_map<std::string, std::string> names;
+
+        Scope(Scope* outerScope) {
+            outer = outerScope;
+        }
+    };
+
+    void openScope();
+
+    void closeScope();
+
+    std::string lookTopId(const std::string& id);
+
+    std::string declareId(IdentifierNode* id);
+
+    std::string generateStatement(ASTNode* node);
+
+    std::string generateDeclVar(DeclVarNode* node);
+
+    std::string generateDeclFunc(DeclFuncNode* node);
+
+    std::string generateIfStmt(IfStmtNode* node);
+
+    std::string generateForLoop(ForLoopNode* node);
+
+    std::string generateBlockStmt(BlockStmtNode* node);
+
+    std::string generateReturnStmt(ReturnStmtNode* node);
+
+    std::string generateAssign(BinOpNode* node);
+
+    std::string generateExpression(ASTNode* node);
+
+    std::string generateBinOp(BinOpNode* node);
+
+    std::string generateFuncCall(FuncCallNode* node);
+
+    std::string generateConstNumber(ConstNumberNode* node);
+
+    std::string generateOperands(const std::vector<ASTNode*>& operands, std::vector<std::string>& values);
+
+    std::string newTemp(ValueType::Type type);
+
+    std::string getCType(ValueType::Type type);
+
+    ValueType::Type getStaticType(ASTNode* node);
+
+    bool containsCall(ASTNode* node);
+
+    bool isChainedAssign(BinOpNode* node);
+
+    void addTabs(std::string& result);
+
+    Scope* topScope;
+
+    std::unordered_map<std::string, DeclFuncNode*> functions;
+
+    // file scope declarations of top-level variables
+    std::string globals;
+
+    // declarations of the temps used by the function being generated
+    std::string temps;
+
+    int tabCount;
+
+    bool blockScope;
+
+    unsigned long declCount;
+
+    unsigned long tempCount;
+public:
+    std::string generate(ProgramTranslationNode* root);
+
+    CGenerator() : topScope(new Scope(nullptr)), tabCount(0), blockScope(false), declCount(0), tempCount(0) {};
+
+    ~CGenerator() {
+        delete topScope;
+    }
+};
+
+#endif //REPL_CGENERATOR_H
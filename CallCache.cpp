@@ -0,0 +1,58 @@
+#include <cstring>
+#include "CallCache.h"
+
+unsigned long CallCache::KeyHash::operator()(const std::vector<long long>& key) const {
+    // FNV-1a over the words of the key
+    unsigned long hash = 14695981039346656037UL;
+    for (const auto& currentWord : key) {
+        hash ^= static_cast<unsigned long>(currentWord);
+        hash *= 1099511628211UL;
+    }
+    return hash;
+}
+
+void CallCache::makeKey(DeclFuncNode* func, const EvalResult* args, unsigned long argsSize) {
+    key.clear();
+    key.emplace_back(reinterpret_cast<long long>(func));
+
+    // ints and doubles get different tags, 2 and 2.0 may give different results
+    for (unsigned long currentArgNum = 0; currentArgNum != argsSize; currentArgNum++) {
+        const EvalResult& currentArg = args[currentArgNum];
+        if (currentArg.getResultType() == ValueType::Bool) {
+            key.emplace_back(0);
+            key.emplace_back(currentArg.getResultBool() ? 1 : 0);
+        } else if (currentArg.isResultInt()) {
+            key.emplace_back(1);
+            key.emplace_back(currentArg.getResultInt());
+        } else {
+            double value = currentArg.getResultDouble();
+            long long bits;
+            std::memcpy(&bits, &value, sizeof(bits));
+            key.emplace_back(2);
+            key.emplace_back(bits);
+        }
+    }
+}
+
+bool CallCache::find(DeclFuncNode* func, const EvalResult* args, unsigned long argsSize, EvalResult& result) {
+    makeKey(func, args, argsSize);
+
+    auto found = results.find(key);
+    if (found == results.end()) {
+        misses++;
+        return false;
+    }
+
+    hits++;
+    result = found->second;
+    return true;
+}
+
+void CallCache::insert(DeclFuncNode* func, const EvalResult* args, unsigned long argsSize, const EvalResult& result) {
+    if (results.size() >= maxEntries) {
+        results.clear();
+    }
+
+    makeKey(func, args, argsSize);
+    results.emplace(key, result);
+}
@@ -0,0 +1,49 @@
+#ifndef REPL_CALLCACHE_H
+#define REPL_CALLCACHE_H
+
+#include "ASTNode.h"
+#include "EvalResult.h"
+#include <unordered_map>
+#include <vector>
+
+// results of pure function calls keyed on the function and the argument values
+class CallCache {
+private:
+    struct KeyHash {
+        unsigned long operator()(const std::vector<long long>& key) const;
+    };
+
+    void makeKey(DeclFuncNode* func, const EvalResult* args, unsigned long argsSize);
+
+    std::unordered_map<std::vector<long long>, EvalResult, KeyHash> results;
+
+    // reused, so a lookup doesn't allocate
+    std::vector<long long> key;
+
+    unsigned long hits;
+
+    unsigned long misses;
+public:
+    CallCache() : hits(0), misses(0) {};
+
+    bool find(DeclFuncNode* func, const EvalResult* args, unsigned long argsSize, EvalResult& result);
+
+    // the table is emptied when it is full, so deep recursion with distinct arguments can't grow it without bound
+    void insert(DeclFuncNode* func, const EvalResult* args, unsigned long argsSize, const EvalResult& result);
+
+    unsigned long getHits() const {
+        return hits;
+    }
+
+    unsigned long getMisses() const {
+        return misses;
+    }
+
+    unsigned long size() const {
+        return results.size();
+    }
+
+    static const unsigned long maxEntries = 1 << 16;
+};
+
+#endif //REPL_CALLCACHE_H
@@ -0,0 +1,207 @@
+#include <stdexcept>
+#include <algorithm>
+#include <string>
+#include "CharScanner.h"
+
+#if defined(__x86_64__) && defined(__GNUC__)
+#include <immintrin.h>
+#define REPL_SIMD_SUPPORTED 1
+#else
+#define REPL_SIMD_SUPPORTED 0
+#endif
+
+namespace {
+    bool isWordChar(char currentChar) {
+        return (currentChar >= 'a' && currentChar <= 'z') || (currentChar >= 'A' && currentChar <= 'Z') ||
+               (currentChar >= '0' && currentChar <= '9') || currentChar == '_';
+    }
+
+    bool isNumberChar(char currentChar) {
+        return (currentChar >= '0' && currentChar <= '9') || currentChar == '.';
+    }
+
+    const char* scalarSpacesEnd(const char* currentChar, const char* end) {
+        while (currentChar != end && *currentChar == ' ') {
+            currentChar++;
+        }
+        return currentChar;
+    }
+
+    const char* scalarWordEnd(const char* currentChar, const char* end) {
+        while (currentChar != end && isWordChar(*currentChar)) {
+            currentChar++;
+        }
+        return currentChar;
+    }
+
+    const char* scalarNumberEnd(const char* currentChar, const char* end) {
+        while (currentChar != end && isNumberChar(*currentChar)) {
+            currentChar++;
+        }
+        return currentChar;
+    }
+
+#if REPL_SIMD_SUPPORTED
+    const long shortRunLength = 4;
+
+    // bytes are compared as signed, so chars above 127 are never in a range
+    __m128i inRange(__m128i chars, char first, char last) {
+        return _mm_and_si128(_mm_cmpgt_epi8(chars, _mm_set1_epi8(static_cast<char>(first - 1))),
+                             _mm_cmplt_epi8(chars, _mm_set1_epi8(static_cast<char>(last + 1))));
+    }
+
+    __m128i sse2WordMask(__m128i chars) {
+        // setting 0x20 turns upper case letters into lower case ones and no other char into a letter
+        __m128i lower = _mm_or_si128(chars, _mm_set1_epi8(0x20));
+        return _mm_or_si128(_mm_or_si128(inRange(lower, 'a', 'z'), inRange(chars, '0', '9')),
+                            _mm_cmpeq_epi8(chars, _mm_set1_epi8('_')));
+    }
+
+    __m128i sse2NumberMask(__m128i chars) {
+        return _mm_or_si128(inRange(chars, '0', '9'), _mm_cmpeq_epi8(chars, _mm_set1_epi8('.')));
+    }
+
+    __m128i sse2SpacesMask(__m128i chars) {
+        return _mm_cmpeq_epi8(chars, _mm_set1_epi8(' '));
+    }
+
+    // MaskFunction marks the bytes that continue the run
+    template<__m128i (* MaskFunction)(__m128i), const char* (* ScalarFunction)(const char*, const char*)>
+    const char* sse2RunEnd(const char* currentChar, const char* end) {
+        while (end - currentChar >= 16) {
+            __m128i chars = _mm_loadu_si128(reinterpret_cast<const __m128i*>(currentChar));
+            unsigned int mask = static_cast<unsigned int>(_mm_movemask_epi8(MaskFunction(chars)));
+            if (mask != 0xFFFF) {
+                return currentChar + __builtin_ctz(~mask);
+            }
+            currentChar += 16;
+        }
+        return ScalarFunction(currentChar, end);
+    }
+
+    __attribute__((target("avx2")))
+    __m256i inRange256(__m256i chars, char first, char last) {
+        return _mm256_and_si256(_mm256_cmpgt_epi8(chars, _mm256_set1_epi8(static_cast<char>(first - 1))),
+                                _mm256_cmpgt_epi8(_mm256_set1_epi8(static_cast<char>(last + 1)), chars));
+    }
+
+    __attribute__((target("avx2")))
+    __m256i avx2WordMask(__m256i chars) {
+        __m256i lower = _mm256_or_si256(chars, _mm256_set1_epi8(0x20));
+        return _mm256_or_si256(_mm256_or_si256(inRange256(lower, 'a', 'z'), inRange256(chars, '0', '9')),
+                               _mm256_cmpeq_epi8(chars, _mm256_set1_epi8('_')));
+    }
+
+    __attribute__((target("avx2")))
+    __m256i avx2NumberMask(__m256i chars) {
+        return _mm256_or_si256(inRange256(chars, '0', '9'), _mm256_cmpeq_epi8(chars, _mm256_set1_epi8('.')));
+    }
+
+    __attribute__((target("avx2")))
+    __m256i avx2SpacesMask(__m256i chars) {
+        return _mm256_cmpeq_epi8(chars, _mm256_set1_epi8(' '));
+    }
+
+    // the tail shorter than 32 bytes goes through the SSE2 kernel
+    template<__m256i (* MaskFunction)(__m256i), const char* (* TailFunction)(const char*, const char*)>
+    __attribute__((target("avx2")))
+    const char* avx2RunEnd(const char* currentChar, const char* end) {
+        while (end - currentChar >= 32) {
+            __m256i chars = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(currentChar));
+            unsigned int mask = static_cast<unsigned int>(_mm256_movemask_epi8(MaskFunction(chars)));
+            if (mask != 0xFFFFFFFF) {
+                return currentChar + __builtin_ctz(~mask);
+            }
+            currentChar += 32;
+        }
+        return TailFunction(currentChar, end);
+    }
+
+    // most tokens are a few chars long and end before a vector would be loaded
+    template<const char* (* ScalarFunction)(const char*, const char*),
+            const char* (* VectorFunction)(const char*, const char*)>
+    const char* shortRunFirst(const char* currentChar, const char* end) {
+        const char* prefixEnd = currentChar + std::min<long>(end - currentChar, shortRunLength);
+        const char* runEnd = ScalarFunction(currentChar, prefixEnd);
+        if (runEnd != prefixEnd) {
+            return runEnd;
+        }
+        return VectorFunction(runEnd, end);
+    }
+#endif
+}
+
+CharScanner::CharScanner() : CharScanner(getBestKind()) {}
+
+CharScanner::CharScanner(ScanKind::Type kind) : kind(kind) {
+    if (!isSupported(kind)) {
+        throw std::runtime_error(std::string(getKindName(kind)) + " scanning is not supported by this CPU");
+    }
+
+    switch (kind) {
+#if REPL_SIMD_SUPPORTED
+        case ScanKind::SSE2: {
+            spacesEnd = shortRunFirst<scalarSpacesEnd, sse2RunEnd<sse2SpacesMask, scalarSpacesEnd> >;
+            wordEnd = shortRunFirst<scalarWordEnd, sse2RunEnd<sse2WordMask, scalarWordEnd> >;
+            numberEnd = shortRunFirst<scalarNumberEnd, sse2RunEnd<sse2NumberMask, scalarNumberEnd> >;
+            break;
+        }
+        case ScanKind::AVX2: {
+            spacesEnd = shortRunFirst<scalarSpacesEnd,
+                    avx2RunEnd<avx2SpacesMask, sse2RunEnd<sse2SpacesMask, scalarSpacesEnd> > >;
+            wordEnd = shortRunFirst<scalarWordEnd, avx2RunEnd<avx2WordMask, sse2RunEnd<sse2WordMask, scalarWordEnd> > >;
+            numberEnd = shortRunFirst<scalarNumberEnd,
+                    avx2RunEnd<avx2NumberMask, sse2RunEnd<sse2NumberMask, scalarNumberEnd> > >;
+            break;
+        }
+#endif
+        default: {
+            spacesEnd = scalarSpacesEnd;
+            wordEnd = scalarWordEnd;
+            numberEnd = scalarNumberEnd;
+        }
+    }
+}
+
+bool CharScanner::isSupported(ScanKind::Type kind) {
+    switch (kind) {
+        case ScanKind::Scalar: {
+            return true;
+        }
+#if REPL_SIMD_SUPPORTED
+        case ScanKind::SSE2: {
+            // part of x86-64
+            return true;
+        }
+        case ScanKind::AVX2: {
+            return __builtin_cpu_supports("avx2");
+        }
+#endif
+        default: {
+            return false;
+        }
+    }
+}
+
+ScanKind::Type CharScanner::getBestKind() {
+    if (isSupported(ScanKind::AVX2)) {
+        return ScanKind::AVX2;
+    } else if (isSupported(ScanKind::SSE2)) {
+        return ScanKind::SSE2;
+    }
+    return ScanKind::Scalar;
+}
+
+const char* CharScanner::getKindName(ScanKind::Type kind) {
+    switch (kind) {
+        case ScanKind::SSE2: {
+            return "sse2";
+        }
+        case ScanKind::AVX2: {
+            return "avx2";
+        }
+        default: {
+            return "scalar";
+        }
+    }
+}
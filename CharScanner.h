@@ -0,0 +1,55 @@
+#ifndef REPL_CHARSCANNER_H
+#define REPL_CHARSCANNER_H
+
+namespace ScanKind {
+    enum Type {
+        Scalar,
+        SSE2,
+        AVX2
+    };
+}
+
+// finds the end of a run of spaces, word chars (letters, digits, '_') or number chars (digits, '.'),
+// vector kernels load 16 or 32 bytes at a time and never read at or past end
+class CharScanner {
+private:
+    typedef const char* (* ScanFunction)(const char* currentChar, const char* end);
+
+    ScanKind::Type kind;
+
+    ScanFunction spacesEnd;
+
+    ScanFunction wordEnd;
+
+    ScanFunction numberEnd;
+public:
+    // the widest kind the CPU supports
+    CharScanner();
+
+    // kind must be supported
+    explicit CharScanner(ScanKind::Type kind);
+
+    static bool isSupported(ScanKind::Type kind);
+
+    static ScanKind::Type getBestKind();
+
+    static const char* getKindName(ScanKind::Type kind);
+
+    ScanKind::Type getKind() const {
+        return kind;
+    }
+
+    const char* skipSpaces(const char* currentChar, const char* end) const {
+        return spacesEnd(currentChar, end);
+    }
+
+    const char* skipWord(const char* currentChar, const char* end) const {
+        return wordEnd(currentChar, end);
+    }
+
+    const char* skipNumber(const char* currentChar, const char* end) const {
+        return numberEnd(currentChar, end);
+    }
+};
+
+#endif //REPL_CHARSCANNER_H
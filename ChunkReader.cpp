@@ -0,0 +1,69 @@
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "ChunkReader.h"
+
+ChunkReader::ChunkReader(std::istream& stream, unsigned long chunkSize) : stream(&stream), fd(-1),
+                                                                          chunkSize(chunkSize == 0 ? 1 : chunkSize),
+                                                                          buffer(1, '\0'), size(0), position(0),
+                                                                          offset(0), finished(false), sizeHint(0) {
+    std::streampos start = stream.tellg();
+    if (start != std::streampos(-1) && stream.seekg(0, std::ios::end)) {
+        sizeHint = static_cast<unsigned long>(stream.tellg() - start);
+        stream.seekg(start);
+    }
+    stream.clear();
+}
+
+ChunkReader::ChunkReader(int fd, unsigned long chunkSize) : stream(nullptr), fd(fd),
+                                                            chunkSize(chunkSize == 0 ? 1 : chunkSize),
+                                                            buffer(1, '\0'), size(0), position(0),
+                                                            offset(0), finished(false), sizeHint(0) {
+    struct stat fileStat;
+    off_t start = ::lseek(fd, 0, SEEK_CUR);
+    if (start >= 0 && ::fstat(fd, &fileStat) == 0 && S_ISREG(fileStat.st_mode) && fileStat.st_size > start) {
+        sizeHint = static_cast<unsigned long>(fileStat.st_size - start);
+    }
+}
+
+unsigned long ChunkReader::readChunk(char* data) {
+    if (stream != nullptr) {
+        stream->read(data, static_cast<std::streamsize>(chunkSize));
+        return static_cast<unsigned long>(stream->gcount());
+    }
+
+    ssize_t readCount = ::read(fd, data, chunkSize);
+    if (readCount < 0) {
+        throw std::runtime_error(std::string("Can't read input: ") + std::strerror(errno));
+    }
+    return static_cast<unsigned long>(readCount);
+}
+
+void ChunkReader::refill() {
+    if (finished) {
+        return;
+    }
+
+    unsigned long keptSize = size - position;
+    std::memmove(buffer.data(), buffer.data() + position, keptSize);
+    offset += position;
+    position = 0;
+
+    // "\n", EOF and '\0' fit in the chunk part as well
+    if (buffer.size() < keptSize + chunkSize + 3) {
+        buffer.resize(keptSize + chunkSize + 3);
+    }
+
+    unsigned long readCount = readChunk(buffer.data() + keptSize);
+    size = keptSize + readCount;
+    if (readCount == 0) {
+        buffer[size++] = '\n';
+        buffer[size++] = static_cast<char>(EOF);
+        finished = true;
+    }
+    buffer[size] = '\0';
+}
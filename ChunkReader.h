@@ -0,0 +1,86 @@
+#ifndef REPL_CHUNKREADER_H
+#define REPL_CHUNKREADER_H
+
+#include <istream>
+#include <vector>
+
+// reads an input stream or file descriptor into a buffer of about one chunk, after the last chunk it
+// appends "\n" and EOF, so the buffer ends the same way as the strings given to Lexer::tokenize
+class ChunkReader {
+private:
+    std::istream* stream;
+
+    int fd;
+
+    unsigned long chunkSize;
+
+    // holds one char more than size, it is kept '\0' for the lexer lookahead
+    std::vector<char> buffer;
+
+    unsigned long size;
+
+    // first char the lexer has not consumed yet
+    unsigned long position;
+
+    // chars consumed before the start of the buffer
+    unsigned long offset;
+
+    bool finished;
+
+    // bytes left in a regular file when reading starts, 0 for pipes and terminals
+    unsigned long sizeHint;
+
+    unsigned long readChunk(char* data);
+public:
+    static const unsigned long defaultChunkSize = 64 * 1024;
+
+    explicit ChunkReader(std::istream& stream, unsigned long chunkSize = defaultChunkSize);
+
+    explicit ChunkReader(int fd, unsigned long chunkSize = defaultChunkSize);
+
+    // moves the chars from the position on to the start of the buffer and reads the next chunk after them
+    void refill();
+
+    const char* getData() const {
+        return buffer.data();
+    }
+
+    unsigned long getSize() const {
+        return size;
+    }
+
+    unsigned long getPosition() const {
+        return position;
+    }
+
+    void setPosition(unsigned long newPosition) {
+        position = newPosition;
+    }
+
+    // data points into the buffer, so it is overwritten by the next refill
+    bool isInBuffer(const char* data) const {
+        return data >= buffer.data() && data < buffer.data() + size;
+    }
+
+    // the buffer holds the end of the input
+    bool isFinished() const {
+        return finished;
+    }
+
+    // lets the token storage be reserved once instead of growing by doubling
+    // chars consumed since reading started
+    unsigned long getConsumedSize() const {
+        return offset + position;
+    }
+
+    unsigned long getSizeHint() const {
+        return sizeHint;
+    }
+
+    // capacity of the buffer, it grows only for tokens longer than a chunk
+    unsigned long getCapacity() const {
+        return buffer.size();
+    }
+};
+
+#endif //REPL_CHUNKREADER_H
@@ -0,0 +1,875 @@
+#include "ClosureEngine.h"
+#include <algorithm>
+
+namespace {
+    typedef std::function<NumberValue()> NumberClosure;
+
+    double addDouble(double lhs, double rhs) {
+        return lhs + rhs;
+    }
+
+    double subDouble(double lhs, double rhs) {
+        return lhs - rhs;
+    }
+
+    double mulDouble(double lhs, double rhs) {
+        return lhs * rhs;
+    }
+
+    double divDouble(double lhs, double rhs) {
+        return lhs / rhs;
+    }
+
+    NumberValue newInt(long long value) {
+        return NumberValue{true, value, 0};
+    }
+
+    NumberValue newDouble(double value) {
+        return NumberValue{false, 0, value};
+    }
+
+    // only one member of the union in Identifier holds the number
+    NumberValue loadNumber(const Identifier& value) {
+        return value.isInt ? newInt(value.intValue) : newDouble(value.numValue);
+    }
+
+    template<bool (*intOp)(long long, long long, long long&), double (*doubleOp)(double, double)>
+    NumberClosure makeArithmetic(NumberClosure left, NumberClosure right) {
+        return [left, right]() -> NumberValue {
+            NumberValue lhs = left();
+            NumberValue rhs = right();
+            long long value;
+            if (lhs.isInt && rhs.isInt && intOp(lhs.intValue, rhs.intValue, value)) {
+                return newInt(value);
+            }
+            return newDouble(doubleOp(lhs.get(), rhs.get()));
+        };
+    }
+
+    // i + 1 and alike don't need a closure for the constant
+    template<bool (*intOp)(long long, long long, long long&), double (*doubleOp)(double, double)>
+    NumberClosure makeArithmetic(NumberClosure left, long long rhs) {
+        return [left, rhs]() -> NumberValue {
+            NumberValue lhs = left();
+            long long value;
+            if (lhs.isInt && intOp(lhs.intValue, rhs, value)) {
+                return newInt(value);
+            }
+            return newDouble(doubleOp(lhs.get(), static_cast<double>(rhs)));
+        };
+    }
+
+    // compares int64 values as they are and the rest as double
+    struct Less {
+        template<typename T>
+        bool operator()(T lhs, T rhs) const {
+            return lhs < rhs;
+        }
+    };
+
+    struct Greater {
+        template<typename T>
+        bool operator()(T lhs, T rhs) const {
+            return lhs > rhs;
+        }
+    };
+
+    template<typename Compare>
+    std::function<bool()> makeComparison(NumberClosure left, NumberClosure right) {
+        return [left, right]() -> bool {
+            NumberValue lhs = left();
+            NumberValue rhs = right();
+            if (lhs.isInt && rhs.isInt) {
+                return Compare()(lhs.intValue, rhs.intValue);
+            }
+            return Compare()(lhs.get(), rhs.get());
+        };
+    }
+
+    template<typename Compare>
+    std::function<bool()> makeComparison(NumberClosure left, long long rhs) {
+        return [left, rhs]() -> bool {
+            NumberValue lhs = left();
+            if (lhs.isInt) {
+                return Compare()(lhs.intValue, rhs);
+            }
+            return Compare()(lhs.numValue, static_cast<double>(rhs));
+        };
+    }
+
+    bool isIntConstant(ASTNode* node) {
+        return node->type == NodeType::ConstNumber && static_cast<ConstNumberNode*>(node)->isInt;
+    }
+
+    bool isPrint(ASTNode* node) {
+        return node->type == NodeType::FuncCall && static_cast<FuncCallNode*>(node)->name == "print";
+    }
+}
+
+EvalResult ClosureEngine::Evaluate(ASTNode* root) {
+    CollectResultSink resultSink;
+    Evaluate(root, resultSink);
+
+    return resultSink.getLastResult();
+}
+
+void ClosureEngine::Evaluate(ASTNode* root, ResultSink& resultSink) {
+    frameSize = 0;
+    collectResults = true;
+    StatementClosure statement = compileStatement(root);
+    collectResults = false;
+
+    // top-level locals of blocks and loops live in a frame at the bottom of the stack
+    globals.resize(globalsSize);
+    stack.assign(frameSize, Identifier());
+    base = 0;
+    // an error thrown by the previous statement may have left calls behind
+    callDepth = 0;
+    stackGuard.reset();
+    sink = &resultSink;
+
+    if (profiler != nullptr) {
+        profiler->startProgram();
+    }
+    statement();
+    if (profiler != nullptr) {
+        profiler->stopProgram();
+    }
+
+    sink = nullptr;
+}
+
+template<typename Slot>
+ClosureEngine::NumberClosure ClosureEngine::makeLoadNumber(Slot slot) {
+    return [slot]() -> NumberValue {
+        const Identifier& value = slot();
+        return loadNumber(value);
+    };
+}
+
+template<typename Slot>
+ClosureEngine::BoolClosure ClosureEngine::makeLoadBool(Slot slot) {
+    return [slot]() {
+        return slot().boolValue;
+    };
+}
+
+template<typename Slot>
+ClosureEngine::ValueClosure ClosureEngine::makeLoadValue(Slot slot) {
+    return [slot](Identifier& target) {
+        target = slot();
+    };
+}
+
+template<typename Slot>
+ClosureEngine::StatementClosure ClosureEngine::makeStoreNumber(Slot slot, NumberClosure number) {
+    return [slot, number]() {
+        NumberValue value = number();
+        Identifier& target = slot();
+        target.Type = ValueType::Number;
+        target.isInt = value.isInt;
+        if (value.isInt) {
+            target.intValue = value.intValue;
+        } else {
+            target.numValue = value.numValue;
+        }
+        return ExecFlow::Next;
+    };
+}
+
+template<typename Slot>
+ClosureEngine::StatementClosure ClosureEngine::makeStoreBool(Slot slot, BoolClosure value) {
+    return [slot, value]() {
+        bool result = value();
+        Identifier& target = slot();
+        target.Type = ValueType::Bool;
+        target.isInt = false;
+        target.boolValue = result;
+        return ExecFlow::Next;
+    };
+}
+
+template<typename Slot>
+ClosureEngine::StatementClosure ClosureEngine::makeStore(Slot slot, ValueClosure value) {
+    return [slot, value]() {
+        Identifier result;
+        value(result);
+        slot() = result;
+        return ExecFlow::Next;
+    };
+}
+
+ClosureEngine::StatementClosure ClosureEngine::compileStatement(ASTNode* node) {
+    switch (node->type) {
+        case NodeType::BinOp: {
+            BinOpNode* binOp = static_cast<BinOpNode*>(node);
+            if (binOp->binOpType == BinOpType::OperatorAssign) {
+                return compileAssign(binOp);
+            }
+            return compileExpressionStmt(binOp);
+        }
+        case NodeType::ConstNumber:
+        case NodeType::ConstBool:
+        case NodeType::Id:
+        case NodeType::FuncCall: {
+            return compileExpressionStmt(node);
+        }
+        case NodeType::DeclVar: {
+            return compileDeclVar(static_cast<DeclVarNode*>(node));
+        }
+        case NodeType::DeclFunc: {
+            return compileDeclFunc(static_cast<DeclFuncNode*>(node));
+        }
+        case NodeType::IfStmt: {
+            return compileIfStmt(static_cast<IfStmtNode*>(node));
+        }
+        case NodeType::ForLoop: {
+            return compileForLoop(static_cast<ForLoopNode*>(node));
+        }
+        case NodeType::ReturnStmt: {
+            return compileReturnStmt(static_cast<ReturnStmtNode*>(node));
+        }
+        case NodeType::BreakStmt: {
+            return []() {
+                return ExecFlow::Break;
+            };
+        }
+        default: {
+            throw std::runtime_error("Invalid statement");
+        }
+    }
+}
+
+ClosureEngine::StatementClosure ClosureEngine::compileExpressionStmt(ASTNode* node) {
+    ValueClosure value = compileValue(node);
+
+    if (collectResults) {
+        return [this, value]() {
+            Identifier result;
+            value(result);
+            sink->put(toEvalResult(result));
+            return ExecFlow::Next;
+        };
+    }
+
+    return [value]() {
+        Identifier result;
+        value(result);
+        return ExecFlow::Next;
+    };
+}
+
+ClosureEngine::StatementClosure ClosureEngine::compileAssign(BinOpNode* node) {
+    if (node->right->type == NodeType::BinOp &&
+        static_cast<BinOpNode*>(node->right)->binOpType == BinOpType::OperatorAssign) {
+        // chained assignment has no value, so Evaluator leaves lhs untouched
+        if (collectResults) {
+            return [this]() {
+                sink->put(EvalResult());
+                return ExecFlow::Next;
+            };
+        }
+        return []() {
+            return ExecFlow::Next;
+        };
+    }
+
+    StatementClosure store = compileStore(static_cast<IdentifierNode*>(node->left), node->right);
+    if (!collectResults) {
+        return store;
+    }
+
+    EvalResult result = newStatusResult(ResultStatus::AssignValue);
+    return [this, store, result]() {
+        store();
+        sink->put(result);
+        return ExecFlow::Next;
+    };
+}
+
+ClosureEngine::StatementClosure ClosureEngine::compileDeclVar(DeclVarNode* node) {
+    // rhs is compiled before the variable is declared
+    StatementClosure store = compileStore(node->id, node->expr);
+    declareId(node->id);
+    if (!collectResults) {
+        return store;
+    }
+
+    EvalResult result = newStatusResult(ResultStatus::DeclareVariable);
+    return [this, store, result]() {
+        store();
+        sink->put(result);
+        return ExecFlow::Next;
+    };
+}
+
+ClosureEngine::StatementClosure ClosureEngine::compileDeclFunc(DeclFuncNode* node) {
+    Function* func = new Function{node->name, 0, node->line, node->returnType, nullptr};
+    functions.emplace_back(func);
+    // registered before the body is compiled, so recursive calls find it
+    functionsByName[node->name] = func;
+
+    bool oldCollectResults = collectResults;
+    unsigned long oldFrameSize = frameSize;
+
+    // slots were assigned by SemanticAnalyzer, args occupy the first ones
+    collectResults = false;
+    frameSize = node->frameSize;
+    func->body = compileBlockStmt(node->body);
+    func->frameSize = std::max(frameSize, node->argsSize);
+
+    collectResults = oldCollectResults;
+    frameSize = oldFrameSize;
+
+    if (!collectResults) {
+        return []() {
+            return ExecFlow::Next;
+        };
+    }
+
+    EvalResult result = newStatusResult(ResultStatus::DeclareFunc);
+    return [this, result]() {
+        sink->put(result);
+        return ExecFlow::Next;
+    };
+}
+
+ClosureEngine::StatementClosure ClosureEngine::compileReturnStmt(ReturnStmtNode* node) {
+    if (node->expression == nullptr) {
+        return [this]() {
+            returnValue = Identifier();
+            returnValue.Type = ValueType::Void;
+            return ExecFlow::Return;
+        };
+    }
+
+    ValueClosure value = compileValue(node->expression);
+    return [this, value]() {
+        value(returnValue);
+        return ExecFlow::Return;
+    };
+}
+
+ClosureEngine::StatementClosure ClosureEngine::compileBlockStmt(BlockStmtNode* node) {
+    std::vector<StatementClosure> statements;
+    for (const auto& currentStmt : node->stmtList) {
+        statements.emplace_back(compileStatement(currentStmt));
+    }
+
+    if (collectResults) {
+        // break and return close every block they leave
+        return [this, statements]() {
+            sink->openBlock();
+            for (const auto& currentStmt : statements) {
+                ExecFlow::Type flow = currentStmt();
+                if (flow != ExecFlow::Next) {
+                    sink->closeBlock();
+                    return flow;
+                }
+            }
+            sink->closeBlock();
+            return ExecFlow::Next;
+        };
+    }
+
+    if (statements.size() == 1) {
+        return statements[0];
+    }
+
+    return [statements]() {
+        for (const auto& currentStmt : statements) {
+            ExecFlow::Type flow = currentStmt();
+            if (flow != ExecFlow::Next) {
+                return flow;
+            }
+        }
+        return ExecFlow::Next;
+    };
+}
+
+ClosureEngine::StatementClosure ClosureEngine::compileIfStmt(IfStmtNode* node) {
+    BoolClosure condition = compileBool(node->condition);
+    StatementClosure body = compileBlockStmt(node->body);
+
+    StatementClosure elseBody;
+    if (node->elseBody != nullptr) {
+        elseBody = compileBlockStmt(node->elseBody);
+    } else if (collectResults) {
+        EvalResult result;
+        result.setVoidResult();
+        elseBody = [this, result]() {
+            sink->put(result);
+            return ExecFlow::Next;
+        };
+    } else {
+        elseBody = []() {
+            return ExecFlow::Next;
+        };
+    }
+
+    if (node->elseIfStmts.empty()) {
+        return [condition, body, elseBody]() {
+            return condition() ? body() : elseBody();
+        };
+    }
+
+    std::vector<std::pair<BoolClosure, StatementClosure>> branches;
+    branches.emplace_back(condition, body);
+    for (const auto& currentElseIfStmt : node->elseIfStmts) {
+        branches.emplace_back(compileBool(currentElseIfStmt->condition), compileBlockStmt(currentElseIfStmt->body));
+    }
+
+    return [branches, elseBody]() {
+        for (const auto& currentBranch : branches) {
+            if (currentBranch.first()) {
+                return currentBranch.second();
+            }
+        }
+        return elseBody();
+    };
+}
+
+ClosureEngine::StatementClosure ClosureEngine::compileForLoop(ForLoopNode* node) {
+    bool collect = collectResults;
+
+    collectResults = false;
+    StatementClosure init = node->init != nullptr ? compileStatement(node->init) : nullptr;
+    BoolClosure condition = node->condition != nullptr ? compileBool(node->condition) : nullptr;
+    StatementClosure inc = node->inc != nullptr ? compileStatement(node->inc) : nullptr;
+    collectResults = collect;
+
+    StatementClosure body = compileBlockStmt(node->body);
+    unsigned int line = node->line;
+
+    return [this, collect, init, condition, body, inc, line]() {
+        if (collect) {
+            sink->openBlock();
+        }
+        if (init) {
+            init();
+        }
+
+        while (!condition || condition()) {
+            ExecFlow::Type flow = body();
+            if (flow == ExecFlow::Return) {
+                return flow;
+            }
+            if (flow == ExecFlow::Break) {
+                break;
+            }
+
+            if (profiler != nullptr) {
+                profiler->countLoopIteration(line);
+            }
+            if (inc) {
+                inc();
+            }
+        }
+
+        if (collect) {
+            sink->closeBlock();
+        }
+        return ExecFlow::Next;
+    };
+}
+
+ClosureEngine::NumberClosure ClosureEngine::compileNumber(ASTNode* node) {
+    switch (node->type) {
+        case NodeType::ConstNumber: {
+            ConstNumberNode* number = static_cast<ConstNumberNode*>(node);
+            NumberValue value = number->isInt ? newInt(number->intValue) : newDouble(number->value);
+            return [value]() {
+                return value;
+            };
+        }
+        case NodeType::Id: {
+            IdentifierNode* id = static_cast<IdentifierNode*>(node);
+            if (id->storage == IdStorage::Global) {
+                return makeLoadNumber(GlobalSlot{this, id->slot});
+            }
+            return makeLoadNumber(LocalSlot{this, id->slot});
+        }
+        case NodeType::FuncCall: {
+            FuncCallNode* funcCall = static_cast<FuncCallNode*>(node);
+            if (isPrint(funcCall)) {
+                return compileNumber(funcCall->args[0]);
+            }
+
+            std::function<void()> call = compileFuncCall(funcCall);
+            return [this, call]() {
+                call();
+                return loadNumber(returnValue);
+            };
+        }
+        case NodeType::BinOp: {
+            BinOpNode* binOp = static_cast<BinOpNode*>(node);
+            NumberClosure left = compileNumber(binOp->left);
+            bool isRightConstant = isIntConstant(binOp->right);
+            long long rhs = isRightConstant ? static_cast<ConstNumberNode*>(binOp->right)->intValue : 0;
+
+            switch (binOp->binOpType) {
+                case BinOpType::OperatorPlus: {
+                    if (isRightConstant) {
+                        return makeArithmetic<IntArithmetic::add, addDouble>(left, rhs);
+                    }
+                    return makeArithmetic<IntArithmetic::add, addDouble>(left, compileNumber(binOp->right));
+                }
+                case BinOpType::OperatorMinus: {
+                    if (isRightConstant) {
+                        return makeArithmetic<IntArithmetic::sub, subDouble>(left, rhs);
+                    }
+                    return makeArithmetic<IntArithmetic::sub, subDouble>(left, compileNumber(binOp->right));
+                }
+                case BinOpType::OperatorMul: {
+                    if (isRightConstant) {
+                        return makeArithmetic<IntArithmetic::mul, mulDouble>(left, rhs);
+                    }
+                    return makeArithmetic<IntArithmetic::mul, mulDouble>(left, compileNumber(binOp->right));
+                }
+                case BinOpType::OperatorDiv: {
+                    if (isRightConstant) {
+                        return makeArithmetic<IntArithmetic::div, divDouble>(left, rhs);
+                    }
+                    return makeArithmetic<IntArithmetic::div, divDouble>(left, compileNumber(binOp->right));
+                }
+                default: {
+                    throw std::runtime_error("Invalid expression");
+                }
+            }
+        }
+        default: {
+            throw std::runtime_error("Invalid expression");
+        }
+    }
+}
+
+ClosureEngine::BoolClosure ClosureEngine::compileBool(ASTNode* node) {
+    switch (node->type) {
+        case NodeType::ConstBool: {
+            bool value = static_cast<ConstBoolNode*>(node)->value;
+            return [value]() {
+                return value;
+            };
+        }
+        case NodeType::Id: {
+            IdentifierNode* id = static_cast<IdentifierNode*>(node);
+            if (id->storage == IdStorage::Global) {
+                return makeLoadBool(GlobalSlot{this, id->slot});
+            }
+            return makeLoadBool(LocalSlot{this, id->slot});
+        }
+        case NodeType::FuncCall: {
+            FuncCallNode* funcCall = static_cast<FuncCallNode*>(node);
+            if (isPrint(funcCall)) {
+                return compileBool(funcCall->args[0]);
+            }
+
+            std::function<void()> call = compileFuncCall(funcCall);
+            return [this, call]() {
+                call();
+                return returnValue.boolValue;
+            };
+        }
+        case NodeType::BinOp: {
+            BinOpNode* binOp = static_cast<BinOpNode*>(node);
+
+            switch (binOp->binOpType) {
+                case BinOpType::OperatorBoolAND: {
+                    BoolClosure left = compileBool(binOp->left);
+                    BoolClosure right = compileBool(binOp->right);
+                    return [left, right]() {
+                        return left() && right();
+                    };
+                }
+                case BinOpType::OperatorBoolOR: {
+                    BoolClosure left = compileBool(binOp->left);
+                    BoolClosure right = compileBool(binOp->right);
+                    return [left, right]() {
+                        return left() || right();
+                    };
+                }
+                case BinOpType::OperatorLess:
+                case BinOpType::OperatorGreater: {
+                    NumberClosure left = compileNumber(binOp->left);
+                    bool isLess = binOp->binOpType == BinOpType::OperatorLess;
+
+                    if (isIntConstant(binOp->right)) {
+                        long long rhs = static_cast<ConstNumberNode*>(binOp->right)->intValue;
+                        if (isLess) {
+                            return makeComparison<Less>(left, rhs);
+                        }
+                        return makeComparison<Greater>(left, rhs);
+                    }
+
+                    NumberClosure right = compileNumber(binOp->right);
+                    if (isLess) {
+                        return makeComparison<Less>(left, right);
+                    }
+                    return makeComparison<Greater>(left, right);
+                }
+                case BinOpType::OperatorEqual: {
+                    ValueType::Type type = getStaticType(binOp->left);
+                    if (type == ValueType::Undefined) {
+                        type = getStaticType(binOp->right);
+                    }
+
+                    if (type == ValueType::Number) {
+                        NumberClosure left = compileNumber(binOp->left);
+                        NumberClosure right = compileNumber(binOp->right);
+                        return [left, right]() {
+                            NumberValue lhs = left();
+                            NumberValue rhs = right();
+                            if (lhs.isInt && rhs.isInt) {
+                                return lhs.intValue == rhs.intValue;
+                            }
+                            return lhs.get() == rhs.get();
+                        };
+                    }
+                    if (type == ValueType::Bool) {
+                        BoolClosure left = compileBool(binOp->left);
+                        BoolClosure right = compileBool(binOp->right);
+                        return [left, right]() {
+                            return left() == right();
+                        };
+                    }
+
+                    // the type is known only once the values are
+                    ValueClosure left = compileValue(binOp->left);
+                    ValueClosure right = compileValue(binOp->right);
+                    return [left, right]() {
+                        Identifier lhs;
+                        Identifier rhs;
+                        left(lhs);
+                        right(rhs);
+                        if (lhs.Type == ValueType::Number && lhs.isInt && rhs.isInt) {
+                            return lhs.intValue == rhs.intValue;
+                        }
+                        if (lhs.Type == ValueType::Number) {
+                            return lhs.getNumber() == rhs.getNumber();
+                        }
+                        return lhs.boolValue == rhs.boolValue;
+                    };
+                }
+                default: {
+                    throw std::runtime_error("Invalid expression");
+                }
+            }
+        }
+        default: {
+            throw std::runtime_error("Invalid expression");
+        }
+    }
+}
+
+ClosureEngine::ValueClosure ClosureEngine::compileValue(ASTNode* node) {
+    if (node->type == NodeType::Id) {
+        IdentifierNode* id = static_cast<IdentifierNode*>(node);
+        if (id->storage == IdStorage::Global) {
+            return makeLoadValue(GlobalSlot{this, id->slot});
+        }
+        return makeLoadValue(LocalSlot{this, id->slot});
+    }
+
+    if (node->type == NodeType::FuncCall) {
+        FuncCallNode* funcCall = static_cast<FuncCallNode*>(node);
+        if (isPrint(funcCall)) {
+            return compileValue(funcCall->args[0]);
+        }
+
+        std::function<void()> call = compileFuncCall(funcCall);
+        return [this, call](Identifier& target) {
+            call();
+            target = returnValue;
+        };
+    }
+
+    switch (getStaticType(node)) {
+        case ValueType::Number: {
+            NumberClosure number = compileNumber(node);
+            return [number](Identifier& target) {
+                NumberValue value = number();
+                target.Type = ValueType::Number;
+                target.isInt = value.isInt;
+                if (value.isInt) {
+                    target.intValue = value.intValue;
+                } else {
+                    target.numValue = value.numValue;
+                }
+            };
+        }
+        case ValueType::Bool: {
+            BoolClosure value = compileBool(node);
+            return [value](Identifier& target) {
+                target.Type = ValueType::Bool;
+                target.isInt = false;
+                target.boolValue = value();
+            };
+        }
+        default: {
+            throw std::runtime_error("Invalid expression");
+        }
+    }
+}
+
+ClosureEngine::StatementClosure ClosureEngine::compileStore(IdentifierNode* id, ASTNode* expr) {
+    if (id->storage == IdStorage::Global) {
+        return compileStore(GlobalSlot{this, id->slot}, expr);
+    }
+    return compileStore(LocalSlot{this, id->slot}, expr);
+}
+
+template<typename Slot>
+ClosureEngine::StatementClosure ClosureEngine::compileStore(Slot slot, ASTNode* expr) {
+    if (expr == nullptr) {
+        return makeStore(slot, [](Identifier& target) {
+            target = Identifier();
+        });
+    }
+
+    switch (getStaticType(expr)) {
+        case ValueType::Number: {
+            return makeStoreNumber(slot, compileNumber(expr));
+        }
+        case ValueType::Bool: {
+            return makeStoreBool(slot, compileBool(expr));
+        }
+        default: {
+            return makeStore(slot, compileValue(expr));
+        }
+    }
+}
+
+std::function<void()> ClosureEngine::compileFuncCall(FuncCallNode* node) {
+    const Function* func = functionsByName.at(node->name);
+
+    std::vector<ValueClosure> args;
+    for (const auto& currentArg : node->args) {
+        args.emplace_back(compileValue(currentArg));
+    }
+
+    return [this, func, args]() {
+        callFunction(func, args);
+    };
+}
+
+void ClosureEngine::callFunction(const Function* func, const std::vector<ValueClosure>& args) {
+    if (callDepth == maxCallDepth) {
+        throw std::runtime_error("Maximum call depth of " + std::to_string(maxCallDepth) + " exceeded");
+    }
+    if (stackGuard.isLow()) {
+        throw std::runtime_error("Call stack exhausted at call depth " + std::to_string(callDepth));
+    }
+
+    unsigned long newBase = stack.size();
+    for (const auto& currentArg : args) {
+        Identifier value;
+        currentArg(value);
+        stack.emplace_back(value);
+    }
+    stack.resize(newBase + func->frameSize);
+
+    unsigned long oldBase = base;
+    base = newBase;
+    callDepth++;
+
+    if (profiler != nullptr) {
+        profiler->enterFunction(func->name, func->line);
+    }
+    ExecFlow::Type flow = func->body();
+    if (profiler != nullptr) {
+        profiler->exitFunction();
+    }
+
+    base = oldBase;
+    stack.resize(newBase);
+    callDepth--;
+
+    if (flow != ExecFlow::Return) {
+        returnValue = Identifier();
+        returnValue.Type = ValueType::Void;
+    }
+}
+
+ValueType::Type ClosureEngine::getStaticType(ASTNode* node) {
+    switch (node->type) {
+        case NodeType::ConstNumber: {
+            return ValueType::Number;
+        }
+        case NodeType::ConstBool: {
+            return ValueType::Bool;
+        }
+        case NodeType::Id: {
+            return static_cast<IdentifierNode*>(node)->valueType;
+        }
+        case NodeType::FuncCall: {
+            FuncCallNode* funcCall = static_cast<FuncCallNode*>(node);
+            if (isPrint(funcCall)) {
+                return getStaticType(funcCall->args[0]);
+            }
+
+            auto func = functionsByName.find(funcCall->name);
+            return func != functionsByName.end() ? func->second->returnType : ValueType::Undefined;
+        }
+        case NodeType::BinOp: {
+            switch (static_cast<BinOpNode*>(node)->binOpType) {
+                case BinOpType::OperatorPlus:
+                case BinOpType::OperatorMinus:
+                case BinOpType::OperatorMul:
+                case BinOpType::OperatorDiv: {
+                    return ValueType::Number;
+                }
+                case BinOpType::OperatorAssign: {
+                    return ValueType::Undefined;
+                }
+                default: {
+                    return ValueType::Bool;
+                }
+            }
+        }
+        default: {
+            return ValueType::Undefined;
+        }
+    }
+}
+
+void ClosureEngine::declareId(IdentifierNode* id) {
+    if (id->storage == IdStorage::Global) {
+        globalsSize = std::max(globalsSize, id->slot + 1);
+    } else {
+        frameSize = std::max(frameSize, id->slot + 1);
+    }
+}
+
+EvalResult ClosureEngine::toEvalResult(const Identifier& value) {
+    EvalResult result;
+
+    switch (value.Type) {
+        case ValueType::Number: {
+            if (value.isInt) {
+                result.setValueInt(value.intValue);
+            } else {
+                result.setValueDouble(value.numValue);
+            }
+            break;
+        }
+        case ValueType::Bool: {
+            result.setValueBool(value.boolValue);
+            break;
+        }
+        case ValueType::Void: {
+            result.setVoidResult();
+            break;
+        }
+        default: {
+        }
+    }
+
+    return result;
+}
+
+EvalResult ClosureEngine::newStatusResult(ResultStatus::Type status) {
+    EvalResult result;
+    result.setStatus(status);
+
+    return result;
+}
@@ -0,0 +1,194 @@
+#ifndef REPL_CLOSUREENGINE_H
+#define REPL_CLOSUREENGINE_H
+
+#include "ASTNode.h"
+#include "Identifier.h"
+#include "EvalResult.h"
+#include "ResultSink.h"
+#include "IntArithmetic.h"
+#include "Profiler.h"
+#include "StackGuard.h"
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace ExecFlow {
+    enum Type : unsigned char {
+        Next,
+        Break,
+        Return
+    };
+}
+
+// Number value of a closure, kept in intValue while it is an exact integer as in Identifier
+struct NumberValue {
+    bool isInt;
+    long long intValue;
+    double numValue;
+
+    double get() const {
+        return isInt ? static_cast<double>(intValue) : numValue;
+    }
+};
+
+// converts every statement once into a tree of closures specialized for the value types decided by
+// SemanticAnalyzer, so running a statement switches neither on node types nor on value types
+class ClosureEngine {
+private:
+    typedef std::function<NumberValue()> NumberClosure;
+
+    typedef std::function<bool()> BoolClosure;
+
+    // writes the value of an expression into a variable, an argument or the returned value
+    typedef std::function<void(Identifier&)> ValueClosure;
+
+    typedef std::function<ExecFlow::Type()> StatementClosure;
+
+    struct Function {
+        std::string name;
+        unsigned long frameSize;
+        unsigned int line;
+        ValueType::Type returnType;
+        StatementClosure body;
+    };
+
+    // variable accessors the closures are specialized for, the stack may move while a statement runs,
+    // so references are taken only after the value to store was computed
+    struct GlobalSlot {
+        ClosureEngine* engine;
+        unsigned long slot;
+
+        Identifier& operator()() const {
+            return engine->globals[slot];
+        }
+    };
+
+    struct LocalSlot {
+        ClosureEngine* engine;
+        unsigned long slot;
+
+        Identifier& operator()() const {
+            return engine->stack[engine->base + slot];
+        }
+    };
+
+    template<typename Slot>
+    static NumberClosure makeLoadNumber(Slot slot);
+
+    template<typename Slot>
+    static BoolClosure makeLoadBool(Slot slot);
+
+    template<typename Slot>
+    static ValueClosure makeLoadValue(Slot slot);
+
+    template<typename Slot>
+    static StatementClosure makeStoreNumber(Slot slot, NumberClosure number);
+
+    template<typename Slot>
+    static StatementClosure makeStoreBool(Slot slot, BoolClosure value);
+
+    template<typename Slot>
+    static StatementClosure makeStore(Slot slot, ValueClosure value);
+
+    StatementClosure compileStatement(ASTNode* node);
+
+    StatementClosure compileExpressionStmt(ASTNode* node);
+
+    StatementClosure compileAssign(BinOpNode* node);
+
+    StatementClosure compileDeclVar(DeclVarNode* node);
+
+    StatementClosure compileDeclFunc(DeclFuncNode* node);
+
+    StatementClosure compileReturnStmt(ReturnStmtNode* node);
+
+    StatementClosure compileBlockStmt(BlockStmtNode* node);
+
+    StatementClosure compileIfStmt(IfStmtNode* node);
+
+    StatementClosure compileForLoop(ForLoopNode* node);
+
+    NumberClosure compileNumber(ASTNode* node);
+
+    BoolClosure compileBool(ASTNode* node);
+
+    ValueClosure compileValue(ASTNode* node);
+
+    // expr is nullptr for variables declared without a value
+    StatementClosure compileStore(IdentifierNode* id, ASTNode* expr);
+
+    template<typename Slot>
+    StatementClosure compileStore(Slot slot, ASTNode* expr);
+
+    // leaves the returned value in returnValue
+    std::function<void()> compileFuncCall(FuncCallNode* node);
+
+    ValueType::Type getStaticType(ASTNode* node);
+
+    void declareId(IdentifierNode* id);
+
+    void callFunction(const Function* func, const std::vector<ValueClosure>& args);
+
+    static EvalResult toEvalResult(const Identifier& value);
+
+    static EvalResult newStatusResult(ResultStatus::Type status);
+
+    std::vector<Function*> functions;
+
+    // compiled calls keep pointing to a function declared again under the same name
+    std::unordered_map<std::string, Function*> functionsByName;
+
+    std::vector<Identifier> globals;
+
+    std::vector<Identifier> stack;
+
+    unsigned long base;
+
+    // closures of a call run on the native stack
+    unsigned long callDepth;
+
+    unsigned long maxCallDepth;
+
+    StackGuard stackGuard;
+
+    Identifier returnValue;
+
+    unsigned long globalsSize;
+
+    unsigned long frameSize;
+
+    bool collectResults;
+
+    ResultSink* sink;
+
+    Profiler* profiler;
+public:
+    ClosureEngine() : base(0), callDepth(0), maxCallDepth(unlimitedCallDepth), globalsSize(0), frameSize(0),
+                      collectResults(false), sink(nullptr), profiler(nullptr) {};
+
+    ~ClosureEngine() {
+        for (const auto& currentFunc : functions) {
+            delete currentFunc;
+        }
+    }
+
+    // returns the result of the statement, nested results are kept in compound results
+    EvalResult Evaluate(ASTNode* root);
+
+    void Evaluate(ASTNode* root, ResultSink& resultSink);
+
+    // not owned, nullptr detaches the profiler
+    void setProfiler(Profiler* newProfiler) {
+        profiler = newProfiler;
+    }
+
+    // deeper calls throw, so do calls the native stack has no room for
+    void setMaxCallDepth(unsigned long depth) {
+        maxCallDepth = depth;
+    }
+
+    static const unsigned long unlimitedCallDepth = ~0ul;
+};
+
+#endif //REPL_CLOSUREENGINE_H
@@ -1,45 +1,128 @@
 #include "EvalResult.h"
 
+static_assert(sizeof(EvalResult) <= 16, "EvalResult is copied on every evaluation step");
+
+EvalResult::EvalResult(const EvalResult& other) {
+    resultType = other.resultType;
+    resultIsInt = other.resultIsInt;
+    if (other.resultType == ValueType::Compound) {
+        resultBlock = new std::vector<EvalResult>(*other.resultBlock);
+    } else {
+        resultInt = other.resultInt;
+    }
+}
+
+EvalResult::EvalResult(EvalResult&& other) noexcept {
+    resultType = other.resultType;
+    resultIsInt = other.resultIsInt;
+    resultInt = other.resultInt;
+    // the block moves with the pointer
+    other.resultType = ValueType::Undefined;
+}
+
+EvalResult& EvalResult::operator=(const EvalResult& other) {
+    if (this != &other) {
+        EvalResult copy(other);
+        *this = std::move(copy);
+    }
+    return *this;
+}
+
+EvalResult& EvalResult::operator=(EvalResult&& other) noexcept {
+    if (this != &other) {
+        release();
+        resultType = other.resultType;
+        resultIsInt = other.resultIsInt;
+        resultInt = other.resultInt;
+        other.resultType = ValueType::Undefined;
+    }
+    return *this;
+}
+
+void EvalResult::release() {
+    if (resultType == ValueType::Compound) {
+        delete resultBlock;
+    }
+}
+
 ValueType::Type EvalResult::getResultType() const {
     return resultType;
 }
 
 double EvalResult::getResultDouble() const {
-    return resultDouble;
+    return resultIsInt ? static_cast<double>(resultInt) : resultDouble;
+}
+
+bool EvalResult::isResultInt() const {
+    return resultIsInt;
+}
+
+long long EvalResult::getResultInt() const {
+    return resultInt;
 }
 
 bool EvalResult::getResultBool() const {
     return resultBool;
 }
 
-std::string EvalResult::getResultString() const {
-    return resultString;
+ResultStatus::Type EvalResult::getResultStatus() const {
+    return resultStatus;
+}
+
+const char* EvalResult::getResultString() const {
+    switch (resultStatus) {
+        case ResultStatus::AssignValue:
+            return "Assign value";
+        case ResultStatus::DeclareVariable:
+            return "Declare Variable";
+        case ResultStatus::DeclareFunc:
+            return "Declare func";
+    }
+    return "";
 }
 
-std::vector<EvalResult> EvalResult::getResultBlock() const {
-    return resultBlock;
+const std::vector<EvalResult>& EvalResult::getResultBlock() const {
+    static const std::vector<EvalResult> emptyBlock;
+    return resultType == ValueType::Compound ? *resultBlock : emptyBlock;
 }
 
 void EvalResult::setValueDouble(double value) {
+    release();
     resultType = ValueType::Number;
+    resultIsInt = false;
     resultDouble = value;
 }
 
+void EvalResult::setValueInt(long long value) {
+    release();
+    resultType = ValueType::Number;
+    resultIsInt = true;
+    resultInt = value;
+}
+
 void EvalResult::setValueBool(bool value) {
+    release();
     resultType = ValueType::Bool;
+    resultIsInt = false;
     resultBool = value;
 }
 
-void EvalResult::setValueString(const std::string value) {
+void EvalResult::setStatus(ResultStatus::Type status) {
+    release();
     resultType = ValueType::String;
-    resultString = value;
+    resultIsInt = false;
+    resultStatus = status;
 }
 
-void EvalResult::setBlockResult(const std::vector<EvalResult> results) {
+void EvalResult::setBlockResult(std::vector<EvalResult> results) {
+    release();
     resultType = ValueType::Compound;
-    resultBlock = results;
+    resultIsInt = false;
+    resultBlock = new std::vector<EvalResult>(std::move(results));
 }
 
 void EvalResult::setVoidResult() {
+    release();
     resultType = ValueType::Void;
-}
\ No newline at end of file
+    resultIsInt = false;
+}
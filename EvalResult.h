@@ -2,44 +2,82 @@
 #define REPL_EVALRESULT_H
 
 #include "Identifier.h"
-#include <map>
 #include <vector>
 
+// results of statements that have no value
+namespace ResultStatus {
+    enum Type {
+        AssignValue,
+        DeclareVariable,
+        DeclareFunc
+    };
+}
+
+// 16 bytes, values and statuses are stored inline, so expression results never allocate,
+// only Compound results own a heap block with the results of the nested statements
 struct EvalResult {
 private:
-    bool resultBool;
-
-    double resultDouble;
-
-    std::string resultString;
+    union {
+        bool resultBool;
+        double resultDouble;
+        long long resultInt;
+        ResultStatus::Type resultStatus;
+        std::vector<EvalResult>* resultBlock;
+    };
 
     ValueType::Type resultType;
 
-    std::vector<EvalResult> resultBlock;
+    // Number result is stored in resultInt while it is an exact integer
+    bool resultIsInt;
+
+    void release();
 public:
     ValueType::Type getResultType() const;
 
     double getResultDouble() const;
 
+    bool isResultInt() const;
+
+    long long getResultInt() const;
+
     bool getResultBool() const;
 
-    std::string getResultString() const;
+    ResultStatus::Type getResultStatus() const;
+
+    // text REPL prints for the status
+    const char* getResultString() const;
 
-    std::vector<EvalResult> getResultBlock() const;
+    const std::vector<EvalResult>& getResultBlock() const;
 
     void setValueDouble(double value);
 
+    void setValueInt(long long value);
+
     void setValueBool(bool value);
 
-    void setValueString(const std::string value);
+    void setStatus(ResultStatus::Type status);
 
-    void setBlockResult(const std::vector<EvalResult> results);\
+    void setBlockResult(std::vector<EvalResult> results);
 
     void setVoidResult();
 
     EvalResult() {
         resultType = ValueType::Undefined;
+        resultIsInt = false;
+        resultInt = 0;
+    }
+
+    EvalResult(const EvalResult& other);
+
+    EvalResult(EvalResult&& other) noexcept;
+
+    EvalResult& operator=(const EvalResult& other);
+
+    EvalResult& operator=(EvalResult&& other) noexcept;
+
+    ~EvalResult() {
+        release();
     }
 };
 
-#endif //REPL_EVALRESULT_H
\ No newline at end of file
+#endif //REPL_EVALRESULT_H
@@ -1,16 +1,16 @@
 #include "Evaluator.h"
+#include <algorithm>
 
 EvalResult Evaluator::EvaluateMathExpr(ASTNode* subtree) {
     EvalResult result;
     if (subtree->type == NodeType::ConstNumber) {
         ConstNumberNode* node = static_cast<ConstNumberNode*>(subtree);
 
-        result.setValueDouble(EvaluateNumberConstant(node));
+        result = EvaluateNumberConstant(node);
     } else if (subtree->type == NodeType::Id) {
         IdentifierNode* id = static_cast<IdentifierNode*>(subtree);
 
-        Scope* curScope = lookTopIdScope(id->name);
-        result.setValueDouble(EvaluateIdDouble(curScope, id));
+        result = EvaluateIdNumber(id);
     } else if (subtree->type == NodeType::FuncCall) {
         FuncCallNode* node = static_cast<FuncCallNode*>(subtree);
 
@@ -22,6 +22,35 @@ EvalResult Evaluator::EvaluateMathExpr(ASTNode* subtree) {
         EvalResult leftValue = EvaluateMathExpr(node->left);
         EvalResult rightValue = EvaluateMathExpr(node->right);
 
+        if (leftValue.isResultInt() && rightValue.isResultInt()) {
+            long long lhs = leftValue.getResultInt();
+            long long rhs = rightValue.getResultInt();
+            long long value = 0;
+            bool isExact = false;
+
+            switch (node->binOpType) {
+                case BinOpType::OperatorPlus:
+                    isExact = IntArithmetic::add(lhs, rhs, value);
+                    break;
+                case BinOpType::OperatorMinus:
+                    isExact = IntArithmetic::sub(lhs, rhs, value);
+                    break;
+                case BinOpType::OperatorMul:
+                    isExact = IntArithmetic::mul(lhs, rhs, value);
+                    break;
+                case BinOpType::OperatorDiv:
+                    isExact = IntArithmetic::div(lhs, rhs, value);
+                    break;
+                default: {
+                }
+            }
+
+            if (isExact) {
+                result.setValueInt(value);
+                return result;
+            }
+        }
+
         switch (node->binOpType) {
             case BinOpType::OperatorPlus:
                 result.setValueDouble(leftValue.getResultDouble() + rightValue.getResultDouble());
@@ -53,8 +82,7 @@ EvalResult Evaluator::EvaluateBoolExpr(ASTNode* subtree) {
     } else if (subtree->type == NodeType::Id) {
         IdentifierNode* id = static_cast<IdentifierNode*>(subtree);
 
-        Scope* curScope = lookTopIdScope(id->name);
-        result.setValueBool(EvaluateIdBool(curScope, id));
+        result.setValueBool(EvaluateIdBool(id));
     } else if (subtree->type == NodeType::FuncCall) {
         FuncCallNode* node = static_cast<FuncCallNode*>(subtree);
 
@@ -69,15 +97,15 @@ EvalResult Evaluator::EvaluateBoolExpr(ASTNode* subtree) {
             return EvaluateComparison(binOp);
         }
 
-        EvalResult leftValue = EvaluateBoolExpr(binOp->left);
-        EvalResult rightValue = EvaluateBoolExpr(binOp->right);
+        // left operand is always evaluated first, right one only when it can change the result
+        bool leftValue = EvaluateBoolExpr(binOp->left).getResultBool();
 
         switch (binOp->binOpType) {
             case BinOpType::OperatorBoolAND:
-                result.setValueBool(leftValue.getResultBool() && rightValue.getResultBool());
+                result.setValueBool(leftValue && EvaluateBoolExpr(binOp->right).getResultBool());
                 break;
             case BinOpType::OperatorBoolOR:
-                result.setValueBool(leftValue.getResultBool() || rightValue.getResultBool());
+                result.setValueBool(leftValue || EvaluateBoolExpr(binOp->right).getResultBool());
                 break;
             default: {
             }
@@ -90,8 +118,6 @@ EvalResult Evaluator::EvaluateBoolExpr(ASTNode* subtree) {
 EvalResult Evaluator::EvaluateAssignValue(IdentifierNode* id, ASTNode* expr) {
     EvalResult result;
 
-    Scope* lhsIdScope = lookTopIdScope(id->name);
-
     BinOpNode* binOpExpr = dynamic_cast<BinOpNode*>(expr);
     IdentifierNode* idExpr = dynamic_cast<IdentifierNode*>(expr);
     ConstNumberNode* numberConst = dynamic_cast<ConstNumberNode*>(expr);
@@ -105,8 +131,8 @@ EvalResult Evaluator::EvaluateAssignValue(IdentifierNode* id, ASTNode* expr) {
             binOpExpr->binOpType == BinOpType::OperatorDiv) {
             EvalResult exprResult = EvaluateMathExpr(binOpExpr);
 
-            lhsIdScope->symbolTable.setIdValueDouble(id->name, exprResult.getResultDouble());
-            result.setValueString("Assign value");
+            setIdValueNumber(id, exprResult);
+            result.setStatus(ResultStatus::AssignValue);
         } else if (binOpExpr->binOpType == BinOpType::OperatorBoolAND ||
                    binOpExpr->binOpType == BinOpType::OperatorBoolOR ||
                    binOpExpr->binOpType == BinOpType::OperatorEqual ||
@@ -114,44 +140,42 @@ EvalResult Evaluator::EvaluateAssignValue(IdentifierNode* id, ASTNode* expr) {
                    binOpExpr->binOpType == BinOpType::OperatorGreater) {
             EvalResult exprResult = EvaluateBoolExpr(binOpExpr);
 
-            lhsIdScope->symbolTable.setIdValueBool(id->name, exprResult.getResultBool());
-            result.setValueString("Assign value");
+            setIdValueBool(id, exprResult.getResultBool());
+            result.setStatus(ResultStatus::AssignValue);
         }
     } else if (idExpr != nullptr) {
-        Scope* rhsIdScope = lookTopIdScope(idExpr->name);
-
-        ValueType::Type rhsIdType = rhsIdScope->symbolTable.getIdValueType(idExpr->name);
+        ValueType::Type rhsIdType = lookIdValue(idExpr).Type;
 
         if (rhsIdType == ValueType::Number) {
-            lhsIdScope->symbolTable.setIdValueDouble(id->name, EvaluateIdDouble(rhsIdScope, idExpr));
-            result.setValueString("Assign value");
+            setIdValueNumber(id, EvaluateIdNumber(idExpr));
+            result.setStatus(ResultStatus::AssignValue);
         } else if (rhsIdType == ValueType::Bool) {
-            lhsIdScope->symbolTable.setIdValueBool(id->name, EvaluateIdBool(rhsIdScope, idExpr));
-            result.setValueString("Assign value");
+            setIdValueBool(id, EvaluateIdBool(idExpr));
+            result.setStatus(ResultStatus::AssignValue);
         }
     } else if (funcCallExpr != nullptr) {
         const EvalResult& funcCallResult = EvaluateFuncCall(funcCallExpr);
 
         switch (funcCallResult.getResultType()) {
             case ValueType::Number: {
-                lhsIdScope->symbolTable.setIdValueDouble(id->name, funcCallResult.getResultDouble());
-                result.setValueString("Assign value");
+                setIdValueNumber(id, funcCallResult);
+                result.setStatus(ResultStatus::AssignValue);
                 break;
             }
             case ValueType::Bool: {
-                lhsIdScope->symbolTable.setIdValueBool(id->name, funcCallResult.getResultBool());
-                result.setValueString("Assign value");
+                setIdValueBool(id, funcCallResult.getResultBool());
+                result.setStatus(ResultStatus::AssignValue);
                 break;
             }
             default: {
             }
         }
     } else if (numberConst != nullptr) {
-        lhsIdScope->symbolTable.setIdValueDouble(id->name, EvaluateNumberConstant(numberConst));
-        result.setValueString("Assign value");
+        setIdValueNumber(id, EvaluateNumberConstant(numberConst));
+        result.setStatus(ResultStatus::AssignValue);
     } else if (boolConst != nullptr) {
-        lhsIdScope->symbolTable.setIdValueBool(id->name, EvaluateBoolConstant(boolConst));
-        result.setValueString("Assign value");
+        setIdValueBool(id, EvaluateBoolConstant(boolConst));
+        result.setStatus(ResultStatus::AssignValue);
     }
 
     return result;
@@ -160,8 +184,14 @@ EvalResult Evaluator::EvaluateAssignValue(IdentifierNode* id, ASTNode* expr) {
 EvalResult Evaluator::EvaluateReturnStmt(ReturnStmtNode* subtree) {
     EvalResult result;
 
-    if (subtree->expression != nullptr) {
-        result = Evaluate(subtree->expression);
+    if (isTailCall(subtree->expression)) {
+        // arguments see the frame of the caller, the call itself runs after the frame is left,
+        // they take the place of the caller's arguments on the argument stack
+        FuncCallNode* funcCall = static_cast<FuncCallNode*>(subtree->expression);
+        pushCallArgs(funcCall);
+        tailCallFunc = functions.getFunc(funcCall->name);
+    } else if (subtree->expression != nullptr) {
+        result = EvaluateNode(subtree->expression);
     } else {
         result.setVoidResult();
     }
@@ -170,96 +200,233 @@ EvalResult Evaluator::EvaluateReturnStmt(ReturnStmtNode* subtree) {
     return result;
 }
 
+bool Evaluator::isTailCall(ASTNode* expr) {
+    // top-level code has no frame to reuse, print has no body worth a frame
+    return expr != nullptr && expr->type == NodeType::FuncCall && callDepth != 0 &&
+           functions.getFunc(static_cast<FuncCallNode*>(expr)->name)->line != 0;
+}
+
+void Evaluator::pushCallArgs(FuncCallNode* funcCall) {
+    // calls made by the arguments push their own arguments above and pop them before returning
+    for (const auto& currentCallParam : funcCall->args) {
+        EvalResult currentParamValue = EvaluateNode(currentCallParam);
+        callArgs.emplace_back(std::move(currentParamValue));
+    }
+}
+
 EvalResult Evaluator::EvaluateFuncCall(FuncCallNode* funcCall) {
-    EvalResult result;
+    DeclFuncNode* func = functions.getFunc(funcCall->name);
+
+    unsigned long argsBase = callArgs.size();
+    pushCallArgs(funcCall);
 
-    const std::string& funcName = funcCall->name;
+    return callFunction(func, argsBase);
+}
 
-    DeclFuncNode* func = functions->symbolTable.getFunc(funcName);
+void Evaluator::runSegmentCall(void* arg) {
+    SegmentCall* call = static_cast<SegmentCall*>(arg);
+    call->result = call->evaluator->callFunction(call->func, call->argsBase);
+}
 
-    // evaluate call parameters
-    std::vector<EvalResult> callParamsValues;
-    for (const auto& currentCallParam : funcCall->args) {
-        const EvalResult& currentParamValue = Evaluate(currentCallParam);
-        callParamsValues.emplace_back(currentParamValue);
+EvalResult Evaluator::callFunction(DeclFuncNode* func, unsigned long argsBase) {
+    // frames of the tree walker are on the native stack, deeper calls go on in a new segment
+    if (stackGuard.isLow()) {
+        SegmentCall call{this, func, argsBase, EvalResult()};
+        stackGuard.runOnNewSegment(runSegmentCall, &call);
+        return call.result;
     }
 
-    openScope();
+    EvalResult result;
 
-    for (unsigned long currentIdNum = 0; currentIdNum != func->argsSize; currentIdNum++) {
-        IdentifierNode* id = func->args[currentIdNum];
-        const std::string& declParamName = id->name;
+    if (callDepth == maxCallDepth) {
+        throw std::runtime_error("Maximum call depth of " + std::to_string(maxCallDepth) + " exceeded");
+    }
 
-        const EvalResult& callParamValue = callParamsValues[currentIdNum];
+    // frames stay allocated after return, so calls at the same depth reuse them
+    if (callDepth == callStack.size()) {
+        callStack.emplace_back();
+    }
+    std::vector<Identifier>& frame = callStack[callDepth];
+    callDepth++;
 
-        // add param to function scope
-        topScope->symbolTable.addNewIdentifier(declParamName);
-        switch (callParamValue.getResultType()) {
-            case ValueType::Number: {
-                topScope->symbolTable.setIdValueDouble(declParamName, callParamValue.getResultDouble());
-                break;
-            }
-            case ValueType::Bool: {
-                topScope->symbolTable.setIdValueBool(declParamName, callParamValue.getResultBool());
-                break;
-            }
-            default: {
+    std::vector<Identifier>* oldFrame = currentFrame;
+
+    // statements of the function body are not reported, only the returned value is
+    ResultSink* oldSink = sink;
+    sink = nullptr;
+
+    // calls in tail position are run by this loop in the same frame, every pure one gets the final result
+    unsigned long memoizedBase = memoizedCalls.size();
+    while (true) {
+        const EvalResult* args = callArgs.data() + argsBase;
+
+        // profiled calls all run, so they are counted
+        bool isMemoized = isMemoEnabled && func->isPure && profiler == nullptr;
+        if (isMemoized && callCache.find(func, args, func->argsSize, result)) {
+            break;
+        }
+        if (isMemoized) {
+            memoizedCalls.emplace_back(MemoizedCall{func, memoizedArgs.size()});
+            memoizedArgs.insert(memoizedArgs.end(), args, args + func->argsSize);
+        }
+
+        // native code doesn't report to the profiler, so profiled calls are interpreted
+        if (profiler == nullptr && callNative(func, args, result)) {
+            break;
+        }
+
+        // function sees only its own frame and globals
+        frame.assign(func->frameSize, Identifier());
+
+        for (unsigned long currentIdNum = 0; currentIdNum != func->argsSize; currentIdNum++) {
+            Identifier& param = frame[func->args[currentIdNum]->slot];
+
+            const EvalResult& callParamValue = args[currentIdNum];
+
+            switch (callParamValue.getResultType()) {
+                case ValueType::Number: {
+                    param.Type = ValueType::Number;
+                    param.isInt = callParamValue.isResultInt();
+                    if (param.isInt) {
+                        param.intValue = callParamValue.getResultInt();
+                    } else {
+                        param.numValue = callParamValue.getResultDouble();
+                    }
+                    break;
+                }
+                case ValueType::Bool: {
+                    param.Type = ValueType::Bool;
+                    param.boolValue = callParamValue.getResultBool();
+                    break;
+                }
+                default: {
+                }
             }
         }
+        callArgs.resize(argsBase);
+
+        currentFrame = &frame;
+
+        // built-in functions have no source line and are not profiled, as in the VM
+        bool isProfiled = profiler != nullptr && func->line != 0;
+        if (isProfiled) {
+            profiler->enterFunction(func->name, func->line);
+        }
+
+        result = EvaluateBlockStmt(func->body);
+
+        if (isProfiled) {
+            profiler->exitFunction();
+        }
+
+        if (funcReturn) {
+            funcReturn = false;
+        } else {
+            // function returned without return statement, so we have void function
+            result.setVoidResult();
+        }
+
+        if (tailCallFunc == nullptr) {
+            break;
+        }
+        func = tailCallFunc;
+        tailCallFunc = nullptr;
     }
 
-    Scope* oldOuterScope = topScope->outer;
-    topScope->outer = globalScope;
+    callArgs.resize(argsBase);
+    currentFrame = oldFrame;
+    sink = oldSink;
+    if (callDepth == nativeBailDepth) {
+        nativeBailDepth = 0;
+    }
+    callDepth--;
 
-    result = EvaluateBlockStmt(func->body);
+    if (memoizedBase != memoizedCalls.size()) {
+        for (unsigned long currentCallNum = memoizedBase; currentCallNum != memoizedCalls.size(); currentCallNum++) {
+            const MemoizedCall& call = memoizedCalls[currentCallNum];
+            callCache.insert(call.func, memoizedArgs.data() + call.argsOffset, call.func->argsSize, result);
+        }
+        memoizedArgs.resize(memoizedCalls[memoizedBase].argsOffset);
+        memoizedCalls.resize(memoizedBase);
+    }
 
-    topScope->outer = oldOuterScope;
-    closeScope();
+    return result;
+}
 
-    if (result.getResultType() == ValueType::Compound) {
-        // function returned without return statement, so we have void function
-        result.setVoidResult();
+bool Evaluator::callNative(DeclFuncNode* func, const EvalResult* args, EvalResult& result) {
+    const NativeFunction* nativeFunc = isJitEnabled && nativeBailDepth == 0 ? jit.getFunction(func->name) : nullptr;
+    if (nativeFunc == nullptr) {
+        return false;
+    }
+
+    nativeArgs.clear();
+    for (unsigned long currentArgNum = 0; currentArgNum != func->argsSize; currentArgNum++) {
+        const EvalResult& currentArg = args[currentArgNum];
+        if (currentArg.getResultType() == ValueType::Bool) {
+            nativeArgs.emplace_back(currentArg.getResultBool() ? 1 : 0);
+        } else if (currentArg.getResultType() == ValueType::Number && currentArg.isResultInt()) {
+            nativeArgs.emplace_back(currentArg.getResultInt());
+        } else {
+            return false;
+        }
+    }
+
+    // this call takes the first native frame
+    long long maxNativeDepth = static_cast<long long>(std::min<unsigned long>(
+            maxCallDepth - callDepth + 1, JitCompiler::maxCallDepth));
+
+    long long value;
+    nativeCallsCount++;
+    if (!JitCompiler::call(nativeFunc, nativeArgs, maxNativeDepth, value)) {
+        nativeBailDepth = callDepth;
+        return false;
+    }
+
+    if (nativeFunc->returnType == ValueType::Bool) {
+        result.setValueBool(value != 0);
     } else {
-        funcReturn = false;
+        result.setValueInt(value);
     }
 
-    return result;
+    return true;
 }
 
 EvalResult Evaluator::EvaluateDeclFunc(DeclFuncNode* subtree) {
     EvalResult result;
-    functions->symbolTable.addNewFunc(subtree);
+    functions.addNewFunc(subtree);
+    // functions the JIT can't translate are interpreted
+    jit.compile(subtree);
 
-    result.setValueString("Declare func");
+    result.setStatus(ResultStatus::DeclareFunc);
     return result;
 }
 
 EvalResult Evaluator::EvaluateDeclVar(DeclVarNode* subtree) {
     EvalResult result;
 
-    std::string idName = subtree->id->name;
+    IdentifierNode* id = subtree->id;
 
     if (subtree->expr != nullptr) {
-        const EvalResult& exprResult = Evaluate(subtree->expr);
+        const EvalResult& exprResult = EvaluateNode(subtree->expr);
         switch (exprResult.getResultType()) {
             case ValueType::Number: {
-                topScope->symbolTable.addNewIdentifier(idName);
-                topScope->symbolTable.setIdValueDouble(idName, exprResult.getResultDouble());
+                declareId(id);
+                setIdValueNumber(id, exprResult);
                 break;
             }
             case ValueType::Bool: {
-                topScope->symbolTable.addNewIdentifier(idName);
-                topScope->symbolTable.setIdValueBool(idName, exprResult.getResultBool());
+                declareId(id);
+                setIdValueBool(id, exprResult.getResultBool());
                 break;
             }
             default: {
             }
         }
     } else {
-        topScope->symbolTable.addNewIdentifier(idName);
+        declareId(id);
     }
 
-    result.setValueString("Declare Variable");
+    result.setStatus(ResultStatus::DeclareVariable);
 
     return result;
 }
@@ -267,12 +434,14 @@ EvalResult Evaluator::EvaluateDeclVar(DeclVarNode* subtree) {
 EvalResult Evaluator::EvaluateEqual(BinOpNode* subtree) {
     EvalResult result;
 
-    EvalResult leftValue = Evaluate(subtree->left);
-    EvalResult rightValue = Evaluate(subtree->right);
+    EvalResult leftValue = EvaluateNode(subtree->left);
+    EvalResult rightValue = EvaluateNode(subtree->right);
 
     ValueType::Type operationValueType = leftValue.getResultType();
 
-    if (operationValueType == ValueType::Number) {
+    if (operationValueType == ValueType::Number && leftValue.isResultInt() && rightValue.isResultInt()) {
+        result.setValueBool(leftValue.getResultInt() == rightValue.getResultInt());
+    } else if (operationValueType == ValueType::Number) {
         result.setValueBool(leftValue.getResultDouble() == rightValue.getResultDouble());
     } else {
         result.setValueBool(leftValue.getResultBool() == rightValue.getResultBool());
@@ -284,10 +453,16 @@ EvalResult Evaluator::EvaluateEqual(BinOpNode* subtree) {
 EvalResult Evaluator::EvaluateComparison(BinOpNode* subtree) {
     EvalResult result;
 
-    EvalResult leftValue = Evaluate(subtree->left);
-    EvalResult rightValue = Evaluate(subtree->right);
+    EvalResult leftValue = EvaluateNode(subtree->left);
+    EvalResult rightValue = EvaluateNode(subtree->right);
 
-    if (subtree->binOpType == BinOpType::OperatorLess) {
+    if (leftValue.isResultInt() && rightValue.isResultInt()) {
+        if (subtree->binOpType == BinOpType::OperatorLess) {
+            result.setValueBool(leftValue.getResultInt() < rightValue.getResultInt());
+        } else {
+            result.setValueBool(leftValue.getResultInt() > rightValue.getResultInt());
+        }
+    } else if (subtree->binOpType == BinOpType::OperatorLess) {
         result.setValueBool(leftValue.getResultDouble() < rightValue.getResultDouble());
     } else {
         result.setValueBool(leftValue.getResultDouble() > rightValue.getResultDouble());
@@ -296,28 +471,41 @@ EvalResult Evaluator::EvaluateComparison(BinOpNode* subtree) {
     return result;
 }
 
+EvalResult Evaluator::EvaluateStatement(ASTNode* stmt) {
+    EvalResult result = EvaluateNode(stmt);
+
+    // compound statements report their results themselves
+    if (sink != nullptr && stmt->type != NodeType::IfStmt && stmt->type != NodeType::ForLoop &&
+        stmt->type != NodeType::BreakStmt && stmt->type != NodeType::ReturnStmt) {
+        sink->put(result);
+    }
+
+    return result;
+}
+
 EvalResult Evaluator::EvaluateBlockStmt(BlockStmtNode* subtree) {
     EvalResult result;
-    EvalResult returnStmt;
 
-    std::vector<EvalResult> stmtResults;
+    if (sink != nullptr) {
+        sink->openBlock();
+    }
+
     for (auto currentStatement : subtree->stmtList) {
-        const EvalResult& currentResult = Evaluate(currentStatement);
+        const EvalResult& currentResult = EvaluateStatement(currentStatement);
+        // return is only possible inside a function body, where nothing is reported
         if (funcReturn) {
             return currentResult;
         }
 
         if (breakForLoop) {
-            if (currentStatement->type != NodeType::BreakStmt) {
-                stmtResults.emplace_back(currentResult);
-            }
             break;
         }
+    }
 
-        stmtResults.emplace_back(currentResult);
+    if (sink != nullptr) {
+        sink->closeBlock();
     }
 
-    result.setBlockResult(stmtResults);
     return result;
 }
 
@@ -326,25 +514,25 @@ EvalResult Evaluator::EvaluateIfStmt(IfStmtNode* subtree) {
 
     const EvalResult& conditionResult = EvaluateBoolExpr(subtree->condition);
 
-    openScope();
-
     if (conditionResult.getResultBool()) {
-        result = EvaluateBlockStmt(subtree->body);
-    } else if (subtree->elseIfStmts.size() != 0) {
-        for (const auto& currentElseIfStmt : subtree->elseIfStmts) {
-            const EvalResult& elseIfCondResult = EvaluateBoolExpr(currentElseIfStmt->condition);
-            if (elseIfCondResult.getResultBool()) {
-                result = EvaluateBlockStmt(currentElseIfStmt->body);
-                break;
-            }
+        return EvaluateBlockStmt(subtree->body);
+    }
+
+    for (const auto& currentElseIfStmt : subtree->elseIfStmts) {
+        const EvalResult& elseIfCondResult = EvaluateBoolExpr(currentElseIfStmt->condition);
+        if (elseIfCondResult.getResultBool()) {
+            return EvaluateBlockStmt(currentElseIfStmt->body);
         }
-    } else if (subtree->elseBody) {
-        result = EvaluateBlockStmt(subtree->elseBody);
-    } else {
-        result.setVoidResult();
     }
 
-    closeScope();
+    if (subtree->elseBody) {
+        return EvaluateBlockStmt(subtree->elseBody);
+    }
+
+    result.setVoidResult();
+    if (sink != nullptr) {
+        sink->put(result);
+    }
 
     return result;
 }
@@ -352,39 +540,42 @@ EvalResult Evaluator::EvaluateIfStmt(IfStmtNode* subtree) {
 EvalResult Evaluator::EvaluateForLoopStmt(ForLoopNode* subtree) {
     EvalResult result;
 
-    openScope();
-
     if (subtree->init != nullptr) {
-        Evaluate(subtree->init);
+        EvaluateNode(subtree->init);
     }
 
-    std::vector<EvalResult> blockStmtResults;
+    if (sink != nullptr) {
+        sink->openBlock();
+    }
 
-    while (subtree->condition == nullptr || Evaluate(subtree->condition).getResultBool()) {
+    while (subtree->condition == nullptr || EvaluateNode(subtree->condition).getResultBool()) {
         const EvalResult& currentBlockResult = EvaluateBlockStmt(subtree->body);
         if (funcReturn) {
-            closeScope();
             return currentBlockResult;
         }
-        blockStmtResults.emplace_back(currentBlockResult);
 
         if (breakForLoop) {
             breakForLoop = false;
             break;
         }
 
+        if (profiler != nullptr) {
+            profiler->countLoopIteration(subtree->line);
+        }
+
         if (subtree->inc != nullptr) {
-            Evaluate(subtree->inc);
+            EvaluateNode(subtree->inc);
         }
     }
 
-    result.setBlockResult(blockStmtResults);
+    if (sink != nullptr) {
+        sink->closeBlock();
+    }
 
-    closeScope();
     return result;
 }
 
-EvalResult Evaluator::Evaluate(ASTNode* root) {
+EvalResult Evaluator::EvaluateNode(ASTNode* root) {
     EvalResult result;
 
     if (root->type == NodeType::BinOp) {
@@ -410,22 +601,21 @@ EvalResult Evaluator::Evaluate(ASTNode* root) {
         result = EvaluateDeclVar(node);
     } else if (root->type == NodeType::ConstNumber) {
         ConstNumberNode* node = static_cast<ConstNumberNode*>(root);
-        result.setValueDouble(EvaluateNumberConstant(node));
+        result = EvaluateNumberConstant(node);
     } else if (root->type == NodeType::ConstBool) {
         ConstBoolNode* node = static_cast<ConstBoolNode*>(root);
         result.setValueBool(EvaluateBoolConstant(node));
     } else if (root->type == NodeType::Id) {
         IdentifierNode* id = static_cast<IdentifierNode*>(root);
-        Scope* curScope = lookTopIdScope(id->name);
-        ValueType::Type idValueType = curScope->symbolTable.getIdValueType(id->name);
+        const Identifier& idValue = lookIdValue(id);
 
-        switch (idValueType) {
+        switch (idValue.Type) {
             case ValueType::Number: {
-                result.setValueDouble(EvaluateIdDouble(curScope, id));
+                result = EvaluateIdNumber(id);
                 break;
             }
             case ValueType::Bool: {
-                result.setValueBool(EvaluateIdBool(curScope, id));
+                result.setValueBool(idValue.boolValue);
                 break;
             }
             default: {
@@ -454,41 +644,96 @@ EvalResult Evaluator::Evaluate(ASTNode* root) {
     return result;
 }
 
-double Evaluator::EvaluateIdDouble(Scope* scope, IdentifierNode* id) {
-    return scope->symbolTable.getIdValueDouble(id->name);
+EvalResult Evaluator::Evaluate(ASTNode* root) {
+    CollectResultSink collectSink;
+    Evaluate(root, collectSink);
+
+    return collectSink.getLastResult();
 }
 
-bool Evaluator::EvaluateIdBool(Scope* scope, IdentifierNode* id) {
-    return scope->symbolTable.getIdValueBool(id->name);
+void Evaluator::Evaluate(ASTNode* root, ResultSink& resultSink) {
+    // an error thrown by the previous statement may have left calls behind
+    callDepth = 0;
+    stackGuard.reset();
+    callArgs.clear();
+    memoizedCalls.clear();
+    memoizedArgs.clear();
+    tailCallFunc = nullptr;
+    nativeBailDepth = 0;
+    currentFrame = &topLevelFrame;
+    sink = &resultSink;
+    if (profiler != nullptr) {
+        profiler->startProgram();
+    }
+    EvaluateStatement(root);
+    if (profiler != nullptr) {
+        profiler->stopProgram();
+    }
+    sink = nullptr;
 }
 
-double Evaluator::EvaluateNumberConstant(ConstNumberNode* num) {
-    return num->value;
+EvalResult Evaluator::EvaluateIdNumber(IdentifierNode* id) {
+    EvalResult result;
+    const Identifier& idValue = lookIdValue(id);
+
+    if (idValue.isInt) {
+        result.setValueInt(idValue.intValue);
+    } else {
+        result.setValueDouble(idValue.numValue);
+    }
+
+    return result;
+}
+
+bool Evaluator::EvaluateIdBool(IdentifierNode* id) {
+    return lookIdValue(id).boolValue;
+}
+
+EvalResult Evaluator::EvaluateNumberConstant(ConstNumberNode* num) {
+    EvalResult result;
+
+    if (num->isInt) {
+        result.setValueInt(num->intValue);
+    } else {
+        result.setValueDouble(num->value);
+    }
+
+    return result;
 }
 
 bool Evaluator::EvaluateBoolConstant(ConstBoolNode* num) {
     return num->value;
 }
 
-void Evaluator::openScope() {
-    topScope = new Scope(topScope);
+Identifier& Evaluator::lookIdValue(IdentifierNode* id) {
+    if (id->storage == IdStorage::Global) {
+        return globals[id->slot];
+    }
+    return (*currentFrame)[id->slot];
 }
 
-void Evaluator::closeScope() {
-    Scope* oldScope = topScope;
-    topScope = topScope->outer;
-    delete oldScope;
+void Evaluator::declareId(IdentifierNode* id) {
+    std::vector<Identifier>& storage = id->storage == IdStorage::Global ? globals : *currentFrame;
+    if (id->slot >= storage.size()) {
+        storage.resize(id->slot + 1);
+    }
+    storage[id->slot] = Identifier();
 }
 
-Evaluator::Scope* Evaluator::lookTopIdScope(const std::string& idName) {
-    Scope* currentScope = topScope;
-
-    while (currentScope != nullptr) {
-        if (currentScope->symbolTable.isIdExist(idName)) {
-            return currentScope;
-        }
-        currentScope = currentScope->outer;
+void Evaluator::setIdValueNumber(IdentifierNode* id, const EvalResult& value) {
+    Identifier& idValue = lookIdValue(id);
+    idValue.Type = ValueType::Number;
+    idValue.isInt = value.isResultInt();
+    if (idValue.isInt) {
+        idValue.intValue = value.getResultInt();
+    } else {
+        idValue.numValue = value.getResultDouble();
     }
+}
 
-    return nullptr;
-}
\ No newline at end of file
+void Evaluator::setIdValueBool(IdentifierNode* id, bool value) {
+    Identifier& idValue = lookIdValue(id);
+    idValue.Type = ValueType::Bool;
+    idValue.isInt = false;
+    idValue.boolValue = value;
+}
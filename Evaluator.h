@@ -4,19 +4,17 @@
 #include "ASTNode.h"
 #include "SymbolTable.h"
 #include "EvalResult.h"
+#include "ResultSink.h"
+#include "IntArithmetic.h"
+#include "Profiler.h"
+#include "JitCompiler.h"
+#include "CallCache.h"
+#include "StackGuard.h"
+#include <deque>
 #include <iostream>
 
 class Evaluator {
 private:
-    struct Scope {
-        Scope* outer;
-        SymbolTable symbolTable;
-
-        Scope(Scope* outerScope) {
-            outer = outerScope;
-        }
-    };
-
     EvalResult EvaluateMathExpr(ASTNode* subtree);
 
     EvalResult EvaluateBoolExpr(ASTNode* subtree);
@@ -27,6 +25,26 @@ private:
 
     EvalResult EvaluateFuncCall(FuncCallNode* funcCall);
 
+    // runs the call with the arguments from argsBase on and the calls in tail position it ends with
+    EvalResult callFunction(DeclFuncNode* func, unsigned long argsBase);
+
+    struct SegmentCall {
+        Evaluator* evaluator;
+        DeclFuncNode* func;
+        unsigned long argsBase;
+        EvalResult result;
+    };
+
+    // runs a SegmentCall on a new stack segment
+    static void runSegmentCall(void* arg);
+
+    bool isTailCall(ASTNode* expr);
+
+    void pushCallArgs(FuncCallNode* funcCall);
+
+    // returns false when the call has to be interpreted
+    bool callNative(DeclFuncNode* func, const EvalResult* args, EvalResult& result);
+
     EvalResult EvaluateDeclFunc(DeclFuncNode* subtree);
 
     EvalResult EvaluateDeclVar(DeclVarNode* subtree);
@@ -35,60 +53,150 @@ private:
 
     EvalResult EvaluateComparison(BinOpNode* subtree);
 
+    EvalResult EvaluateNode(ASTNode* root);
+
+    EvalResult EvaluateStatement(ASTNode* stmt);
+
     EvalResult EvaluateBlockStmt(BlockStmtNode* subtree);
 
     EvalResult EvaluateIfStmt(IfStmtNode* subtree);
 
     EvalResult EvaluateForLoopStmt(ForLoopNode* subtree);
 
-    double EvaluateIdDouble(Scope* scope, IdentifierNode* id);
+    EvalResult EvaluateIdNumber(IdentifierNode* id);
 
-    bool EvaluateIdBool(Scope* scope, IdentifierNode* id);
+    bool EvaluateIdBool(IdentifierNode* id);
 
-    double EvaluateNumberConstant(ConstNumberNode* num);
+    EvalResult EvaluateNumberConstant(ConstNumberNode* num);
 
     bool EvaluateBoolConstant(ConstBoolNode* num);
 
-    Scope* lookTopIdScope(const std::string& idName);
+    Identifier& lookIdValue(IdentifierNode* id);
+
+    void declareId(IdentifierNode* id);
+
+    void setIdValueNumber(IdentifierNode* id, const EvalResult& value);
+
+    void setIdValueBool(IdentifierNode* id, bool value);
+
+    SymbolTable functions;
+
+    Arena builtins;
+
+    std::vector<Identifier> globals;
+
+    std::vector<Identifier> topLevelFrame;
+
+    std::vector<Identifier>* currentFrame;
+
+    // frames of the active calls, a deque keeps them in place while it grows
+    std::deque<std::vector<Identifier>> callStack;
+
+    unsigned long callDepth;
+
+    unsigned long maxCallDepth;
+
+    StackGuard stackGuard;
 
-    Scope* globalScope;
+    // arguments of the calls being set up, kept allocated, so calls don't allocate
+    std::vector<EvalResult> callArgs;
 
-    Scope* topScope;
+    // set by return with a call in tail position, the call runs when the caller's frame is left
+    DeclFuncNode* tailCallFunc;
 
-    Scope* functions;
+    std::vector<long long> nativeArgs;
 
-    void openScope();
+    // depth of the call whose native code bailed out, 0 when none did, the calls it makes are interpreted
+    // because their native code would bail out the same way
+    unsigned long nativeBailDepth;
 
-    void closeScope();
+    unsigned long nativeCallsCount;
+
+    ResultSink* sink;
 
     bool breakForLoop;
 
     bool funcReturn;
+
+    Profiler* profiler;
+
+    JitCompiler jit;
+
+    bool isJitEnabled;
+
+    CallCache callCache;
+
+    struct MemoizedCall {
+        DeclFuncNode* func;
+        unsigned long argsOffset;
+    };
+
+    // calls waiting for the result of the tail call chain they belong to, their arguments are in memoizedArgs,
+    // every call adds its own above those of its callers and removes them before returning
+    std::vector<MemoizedCall> memoizedCalls;
+
+    std::vector<EvalResult> memoizedArgs;
+
+    bool isMemoEnabled;
 public:
-    Evaluator() : globalScope(new Scope(nullptr)), topScope(globalScope), functions(globalScope),
-                  breakForLoop(false), funcReturn(false) {
-        DeclFuncNode* funcPrint = new DeclFuncNode;
-        funcPrint->name = "print";
-        IdentifierNode* idArg = new IdentifierNode;
-        idArg->name = "val";
+    Evaluator() : currentFrame(&topLevelFrame), callDepth(0), maxCallDepth(unlimitedCallDepth),
+                  tailCallFunc(nullptr), nativeBailDepth(0), nativeCallsCount(0), sink(nullptr), breakForLoop(false),
+                  funcReturn(false), profiler(nullptr), isJitEnabled(true), isMemoEnabled(true) {
+        DeclFuncNode* funcPrint = builtins.create<DeclFuncNode>();
+        funcPrint->name = builtins.copyString("print");
+        IdentifierNode* idArg = builtins.create<IdentifierNode>();
+        idArg->name = builtins.copyString("val");
+        idArg->storage = IdStorage::Local;
         funcPrint->argsSize = 1;
-        funcPrint->args.emplace_back(idArg);
-        funcPrint->body = new BlockStmtNode;
-        ReturnStmtNode* returnStmt = new ReturnStmtNode;
-        IdentifierNode* idReturn = new IdentifierNode;
-        idReturn->name = "val";
+        funcPrint->frameSize = 1;
+        funcPrint->args = builtins.copyArray(std::vector<IdentifierNode*>{idArg});
+        funcPrint->body = builtins.create<BlockStmtNode>();
+        ReturnStmtNode* returnStmt = builtins.create<ReturnStmtNode>();
+        IdentifierNode* idReturn = builtins.create<IdentifierNode>();
+        idReturn->name = builtins.copyString("val");
+        idReturn->storage = IdStorage::Local;
         returnStmt->expression = idReturn;
-        funcPrint->body->stmtList.emplace_back(returnStmt);
+        funcPrint->body->stmtList = builtins.copyArray(std::vector<ASTNode*>{returnStmt});
 
-        functions->symbolTable.addNewFunc(funcPrint);
+        functions.addNewFunc(funcPrint);
     };
 
-    ~Evaluator() {
-        delete functions->symbolTable.getFunc("print");
-        delete globalScope;
+    // returns the result of the statement, nested results are kept in compound results
+    EvalResult Evaluate(ASTNode* root);
+
+    void Evaluate(ASTNode* root, ResultSink& resultSink);
+
+    // not owned, nullptr detaches the profiler
+    void setProfiler(Profiler* newProfiler) {
+        profiler = newProfiler;
     }
 
-    EvalResult Evaluate(ASTNode* root);
+    // numeric functions run as native code unless a profiler is attached
+    void setJitEnabled(bool isEnabled) {
+        isJitEnabled = isEnabled;
+    }
+
+    // results of pure functions are reused for repeated arguments unless a profiler is attached
+    void setMemoEnabled(bool isEnabled) {
+        isMemoEnabled = isEnabled;
+    }
+
+    const CallCache& getCallCache() const {
+        return callCache;
+    }
+
+    // calls that entered native code, including those that bailed out
+    unsigned long getNativeCallsCount() const {
+        return nativeCallsCount;
+    }
+
+    // deeper calls throw, calls in tail position don't count, native frames do
+    void setMaxCallDepth(unsigned long depth) {
+        maxCallDepth = depth;
+    }
+
+    // calls are bounded only by StackGuard::maxSegmentsSize
+    static const unsigned long unlimitedCallDepth = ~0ul;
 };
 
 #endif //REPL_EVALUATOR_H
\ No newline at end of file
@@ -27,13 +27,25 @@ struct IdentifierTypeStringNames {
     }
 };
 
+// 16 bytes, only the member of the union selected by Type and isInt holds the value
 struct Identifier {
     ValueType::Type Type;
-    double numValue;
-    bool boolValue;
+    // Number is stored in intValue while it is an exact integer, in numValue otherwise
+    bool isInt;
+    union {
+        long long intValue;
+        double numValue;
+        bool boolValue;
+    };
 
     Identifier() {
         Type = ValueType::Undefined;
+        isInt = false;
+        intValue = 0;
+    }
+
+    double getNumber() const {
+        return isInt ? static_cast<double>(intValue) : numValue;
     }
 };
 
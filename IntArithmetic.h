@@ -0,0 +1,43 @@
+#ifndef REPL_INTARITHMETIC_H
+#define REPL_INTARITHMETIC_H
+
+#include <climits>
+#include <cmath>
+
+// Number values are kept as int64 while they stay exact integers, every function here
+// returns false when the result doesn't fit and the caller has to fall back to double
+namespace IntArithmetic {
+    // larger doubles can't hold every integer
+    const double maxExactDouble = 9007199254740992.0;
+
+    inline bool fromDouble(double value, long long& result) {
+        if (std::floor(value) != value || std::fabs(value) > maxExactDouble) {
+            return false;
+        }
+        result = static_cast<long long>(value);
+        return true;
+    }
+
+    inline bool add(long long lhs, long long rhs, long long& result) {
+        return !__builtin_add_overflow(lhs, rhs, &result);
+    }
+
+    inline bool sub(long long lhs, long long rhs, long long& result) {
+        return !__builtin_sub_overflow(lhs, rhs, &result);
+    }
+
+    inline bool mul(long long lhs, long long rhs, long long& result) {
+        return !__builtin_mul_overflow(lhs, rhs, &result);
+    }
+
+    // only exact division stays integer, 7 / 2 is 3.5 as before
+    inline bool div(long long lhs, long long rhs, long long& result) {
+        if (rhs == 0 || (lhs == LLONG_MIN && rhs == -1) || lhs % rhs != 0) {
+            return false;
+        }
+        result = lhs / rhs;
+        return true;
+    }
+}
+
+#endif //REPL_INTARITHMETIC_H
@@ -0,0 +1,524 @@
+#include "JitCompiler.h"
+#include <algorithm>
+#include <cstring>
+
+#if defined(__x86_64__) && defined(__unix__)
+#include <sys/mman.h>
+#include <unistd.h>
+#define REPL_JIT_SUPPORTED 1
+#else
+#define REPL_JIT_SUPPORTED 0
+#endif
+
+// native frame: rbx holds args, r12 holds the JitContext, local slots follow the saved rbx and r12 below rbp,
+// expressions leave their value in rax and keep the left operand of binary operations on the stack
+
+JitCompiler::~JitCompiler() {
+    for (const auto& currentFunc : functions) {
+#if REPL_JIT_SUPPORTED
+        munmap(currentFunc.second->pages, currentFunc.second->pagesSize);
+#endif
+        delete currentFunc.second;
+    }
+}
+
+bool JitCompiler::compile(DeclFuncNode* func) {
+    // the old code of a redeclared function must not run, even when the new one can't be translated
+    release(func->name);
+
+    if (!REPL_JIT_SUPPORTED || (func->returnType != ValueType::Number && func->returnType != ValueType::Bool)) {
+        return false;
+    }
+    for (const auto& currentArg : func->args) {
+        if (currentArg->valueType != ValueType::Number && currentArg->valueType != ValueType::Bool) {
+            return false;
+        }
+    }
+
+    currentFunc = func;
+    code.clear();
+    labels.clear();
+    fixups.clear();
+    loopExits.clear();
+    callees.clear();
+    pushDepth = 0;
+    entryLabel = newLabel();
+    bailLabel = newLabel();
+    epilogueLabel = newLabel();
+
+    bindLabel(entryLabel);
+    // push rbp; mov rbp, rsp; push rbx; push r12
+    emit({0x55, 0x48, 0x89, 0xE5, 0x53, 0x41, 0x54});
+    // sub rsp, locals rounded up to 16 bytes
+    emit({0x48, 0x81, 0xEC});
+    emitInt32(static_cast<int>((func->frameSize * 8 + 15) / 16 * 16));
+    // mov rbx, rdi; mov r12, rsi
+    emit({0x48, 0x89, 0xFB, 0x49, 0x89, 0xF4});
+    // sub qword [r12], 1; js bail
+    emit({0x49, 0x83, 0x2C, 0x24, 0x01});
+    emitJump({0x0F, 0x88}, bailLabel);
+
+    for (unsigned long currentArgNum = 0; currentArgNum != func->argsSize; currentArgNum++) {
+        // mov rax, [rbx + 8 * num]; mov [rbp + slot], rax
+        emit({0x48, 0x8B, 0x83});
+        emitInt32(static_cast<int>(currentArgNum * 8));
+        emit({0x48, 0x89, 0x85});
+        emitInt32(getLocalOffset(func->args[currentArgNum]->slot));
+    }
+
+    bool isCompiled = compileBlockStmt(func->body);
+    currentFunc = nullptr;
+    if (!isCompiled) {
+        return false;
+    }
+
+    // falling off the end gives void, only the interpreter reports it
+    bindLabel(bailLabel);
+    // mov byte [r12 + 8], 1
+    emit({0x41, 0xC6, 0x44, 0x24, 0x08, 0x01});
+    bindLabel(epilogueLabel);
+    // add qword [r12], 1; lea rsp, [rbp - 16]; pop r12; pop rbx; pop rbp; ret
+    emit({0x49, 0x83, 0x04, 0x24, 0x01, 0x48, 0x8D, 0x65, 0xF0, 0x41, 0x5C, 0x5B, 0x5D, 0xC3});
+
+    for (const auto& currentFixup : fixups) {
+        int offset = static_cast<int>(labels[currentFixup.label] - static_cast<long>(currentFixup.pos + 4));
+        std::memcpy(&code[currentFixup.pos], &offset, sizeof(offset));
+    }
+
+    NativeFunction* nativeFunc = install(func->returnType);
+    if (nativeFunc == nullptr) {
+        return false;
+    }
+    nativeFunc->callees = callees;
+    functions[func->name] = nativeFunc;
+
+    return true;
+}
+
+void JitCompiler::release(const std::string& name) {
+    auto func = functions.find(name);
+    if (func == functions.end()) {
+        return;
+    }
+
+    NativeFunction* nativeFunc = func->second;
+    functions.erase(func);
+#if REPL_JIT_SUPPORTED
+    munmap(nativeFunc->pages, nativeFunc->pagesSize);
+#endif
+    delete nativeFunc;
+
+    // callers would jump into the freed pages, so they are interpreted until they are compiled again
+    std::vector<std::string> callers;
+    for (const auto& currentFunc : functions) {
+        const std::vector<std::string>& currentCallees = currentFunc.second->callees;
+        if (std::find(currentCallees.begin(), currentCallees.end(), name) != currentCallees.end()) {
+            callers.emplace_back(currentFunc.first);
+        }
+    }
+    for (const auto& currentCaller : callers) {
+        release(currentCaller);
+    }
+}
+
+const NativeFunction* JitCompiler::getFunction(const std::string& name) const {
+    auto func = functions.find(name);
+    return func != functions.end() ? func->second : nullptr;
+}
+
+bool JitCompiler::call(const NativeFunction* func, const std::vector<long long>& args, long long maxDepth,
+                       long long& result) {
+    JitContext context{maxDepth < maxCallDepth ? maxDepth : maxCallDepth, false};
+    result = func->code(args.data(), &context);
+
+    return !context.bailedOut;
+}
+
+bool JitCompiler::compileStatement(ASTNode* node) {
+    switch (node->type) {
+        case NodeType::BinOp: {
+            BinOpNode* binOp = static_cast<BinOpNode*>(node);
+            if (binOp->binOpType != BinOpType::OperatorAssign) {
+                return compileExpression(binOp);
+            }
+            if (binOp->right->type == NodeType::BinOp &&
+                static_cast<BinOpNode*>(binOp->right)->binOpType == BinOpType::OperatorAssign) {
+                return false;
+            }
+            return compileStore(static_cast<IdentifierNode*>(binOp->left), binOp->right);
+        }
+        case NodeType::ConstNumber:
+        case NodeType::ConstBool:
+        case NodeType::Id:
+        case NodeType::FuncCall: {
+            return compileExpression(node);
+        }
+        case NodeType::DeclVar: {
+            DeclVarNode* declVar = static_cast<DeclVarNode*>(node);
+            return declVar->expr != nullptr && compileStore(declVar->id, declVar->expr);
+        }
+        case NodeType::IfStmt: {
+            return compileIfStmt(static_cast<IfStmtNode*>(node));
+        }
+        case NodeType::ForLoop: {
+            return compileForLoop(static_cast<ForLoopNode*>(node));
+        }
+        case NodeType::ReturnStmt: {
+            ReturnStmtNode* returnStmt = static_cast<ReturnStmtNode*>(node);
+            if (returnStmt->expression == nullptr || !compileExpression(returnStmt->expression)) {
+                return false;
+            }
+            emitJump({0xE9}, epilogueLabel);
+            return true;
+        }
+        case NodeType::BreakStmt: {
+            if (loopExits.empty()) {
+                return false;
+            }
+            emitJump({0xE9}, loopExits.back());
+            return true;
+        }
+        default: {
+            return false;
+        }
+    }
+}
+
+bool JitCompiler::compileBlockStmt(BlockStmtNode* node) {
+    for (const auto& currentStmt : node->stmtList) {
+        if (!compileStatement(currentStmt)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool JitCompiler::compileIfStmt(IfStmtNode* node) {
+    unsigned long endLabel = newLabel();
+
+    std::vector<IfStmtNode*> branches{node};
+    branches.insert(branches.end(), node->elseIfStmts.begin(), node->elseIfStmts.end());
+    for (const auto& currentBranch : branches) {
+        if (!compileExpression(currentBranch->condition)) {
+            return false;
+        }
+        unsigned long nextLabel = newLabel();
+        // test rax, rax; jz next
+        emit({0x48, 0x85, 0xC0});
+        emitJump({0x0F, 0x84}, nextLabel);
+
+        if (!compileBlockStmt(currentBranch->body)) {
+            return false;
+        }
+        emitJump({0xE9}, endLabel);
+        bindLabel(nextLabel);
+    }
+
+    if (node->elseBody != nullptr && !compileBlockStmt(node->elseBody)) {
+        return false;
+    }
+    bindLabel(endLabel);
+
+    return true;
+}
+
+bool JitCompiler::compileForLoop(ForLoopNode* node) {
+    if (node->init != nullptr && !compileStatement(node->init)) {
+        return false;
+    }
+
+    unsigned long startLabel = newLabel();
+    unsigned long exitLabel = newLabel();
+    bindLabel(startLabel);
+
+    if (node->condition != nullptr) {
+        if (!compileExpression(node->condition)) {
+            return false;
+        }
+        // test rax, rax; jz exit
+        emit({0x48, 0x85, 0xC0});
+        emitJump({0x0F, 0x84}, exitLabel);
+    }
+
+    loopExits.emplace_back(exitLabel);
+    bool isCompiled = compileBlockStmt(node->body);
+    loopExits.pop_back();
+    if (!isCompiled || (node->inc != nullptr && !compileStatement(node->inc))) {
+        return false;
+    }
+
+    emitJump({0xE9}, startLabel);
+    bindLabel(exitLabel);
+
+    return true;
+}
+
+bool JitCompiler::compileExpression(ASTNode* node) {
+    switch (node->type) {
+        case NodeType::ConstNumber: {
+            ConstNumberNode* number = static_cast<ConstNumberNode*>(node);
+            if (!number->isInt) {
+                return false;
+            }
+            // mov rax, imm64
+            emit({0x48, 0xB8});
+            emitInt64(number->intValue);
+            return true;
+        }
+        case NodeType::ConstBool: {
+            emit({0x48, 0xB8});
+            emitInt64(static_cast<ConstBoolNode*>(node)->value ? 1 : 0);
+            return true;
+        }
+        case NodeType::Id: {
+            IdentifierNode* id = static_cast<IdentifierNode*>(node);
+            if (!isLocal(id)) {
+                return false;
+            }
+            // mov rax, [rbp + slot]
+            emit({0x48, 0x8B, 0x85});
+            emitInt32(getLocalOffset(id->slot));
+            return true;
+        }
+        case NodeType::FuncCall: {
+            return compileFuncCall(static_cast<FuncCallNode*>(node));
+        }
+        case NodeType::BinOp: {
+            return compileBinOp(static_cast<BinOpNode*>(node));
+        }
+        default: {
+            return false;
+        }
+    }
+}
+
+bool JitCompiler::compileBinOp(BinOpNode* node) {
+    if (node->binOpType == BinOpType::OperatorAssign) {
+        return false;
+    }
+
+    if (node->binOpType == BinOpType::OperatorBoolAND || node->binOpType == BinOpType::OperatorBoolOR) {
+        unsigned long endLabel = newLabel();
+        if (!compileExpression(node->left)) {
+            return false;
+        }
+        // test rax, rax; jz/jnz end
+        emit({0x48, 0x85, 0xC0});
+        emitJump({0x0F, static_cast<unsigned char>(node->binOpType == BinOpType::OperatorBoolAND ? 0x84 : 0x85)},
+                 endLabel);
+        if (!compileExpression(node->right)) {
+            return false;
+        }
+        bindLabel(endLabel);
+        return true;
+    }
+
+    if (!compileExpression(node->left)) {
+        return false;
+    }
+    emitPushRax();
+    if (!compileExpression(node->right)) {
+        return false;
+    }
+    // mov rcx, rax; pop rax
+    emit({0x48, 0x89, 0xC1});
+    emitPopRax();
+
+    switch (node->binOpType) {
+        case BinOpType::OperatorPlus: {
+            // add rax, rcx; jo bail
+            emit({0x48, 0x01, 0xC8});
+            emitJump({0x0F, 0x80}, bailLabel);
+            break;
+        }
+        case BinOpType::OperatorMinus: {
+            // sub rax, rcx; jo bail
+            emit({0x48, 0x29, 0xC8});
+            emitJump({0x0F, 0x80}, bailLabel);
+            break;
+        }
+        case BinOpType::OperatorMul: {
+            // imul rax, rcx; jo bail
+            emit({0x48, 0x0F, 0xAF, 0xC1});
+            emitJump({0x0F, 0x80}, bailLabel);
+            break;
+        }
+        case BinOpType::OperatorDiv: {
+            // only exact division stays int64, as in IntArithmetic::div
+            unsigned long divideLabel = newLabel();
+            unsigned long endLabel = newLabel();
+            // test rcx, rcx; jz bail
+            emit({0x48, 0x85, 0xC9});
+            emitJump({0x0F, 0x84}, bailLabel);
+            // cmp rcx, -1; jne divide; neg rax; jo bail; jmp end
+            emit({0x48, 0x83, 0xF9, 0xFF});
+            emitJump({0x0F, 0x85}, divideLabel);
+            emit({0x48, 0xF7, 0xD8});
+            emitJump({0x0F, 0x80}, bailLabel);
+            emitJump({0xE9}, endLabel);
+            bindLabel(divideLabel);
+            // cqo; idiv rcx; test rdx, rdx; jnz bail
+            emit({0x48, 0x99, 0x48, 0xF7, 0xF9, 0x48, 0x85, 0xD2});
+            emitJump({0x0F, 0x85}, bailLabel);
+            bindLabel(endLabel);
+            break;
+        }
+        case BinOpType::OperatorEqual:
+        case BinOpType::OperatorLess:
+        case BinOpType::OperatorGreater: {
+            // numbers are exact int64 and bools are 0 or 1, so one signed compare serves both
+            unsigned char condition = 0x94;
+            if (node->binOpType == BinOpType::OperatorLess) {
+                condition = 0x9C;
+            } else if (node->binOpType == BinOpType::OperatorGreater) {
+                condition = 0x9F;
+            }
+            // cmp rax, rcx; setcc al; movzx eax, al
+            emit({0x48, 0x39, 0xC8, 0x0F, condition, 0xC0, 0x0F, 0xB6, 0xC0});
+            break;
+        }
+        default: {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool JitCompiler::compileFuncCall(FuncCallNode* node) {
+    // print writes to the output, so calls of it stay interpreted
+    if (node->name == "print") {
+        return false;
+    }
+
+    bool isRecursive = node->name == currentFunc->name;
+    const NativeFunction* callee = isRecursive ? nullptr : getFunction(node->name);
+    if (!isRecursive && callee == nullptr) {
+        return false;
+    }
+
+    unsigned long argsSize = node->args.size();
+    unsigned long padding = (pushDepth + argsSize) % 2;
+    if (padding != 0) {
+        // sub rsp, 8
+        emit({0x48, 0x83, 0xEC, 0x08});
+        pushDepth++;
+    }
+
+    // pushed in reverse, so args[0] ends up at the lowest address
+    for (unsigned long currentArgNum = argsSize; currentArgNum-- > 0;) {
+        if (!compileExpression(node->args[currentArgNum])) {
+            return false;
+        }
+        emitPushRax();
+    }
+
+    // mov rdi, rsp; mov rsi, r12
+    emit({0x48, 0x89, 0xE7, 0x4C, 0x89, 0xE6});
+    if (isRecursive) {
+        emitJump({0xE8}, entryLabel);
+    } else {
+        // mov r11, imm64; call r11
+        emit({0x49, 0xBB});
+        emitInt64(reinterpret_cast<long long>(callee->code));
+        emit({0x41, 0xFF, 0xD3});
+        callees.emplace_back(node->name);
+    }
+
+    // add rsp, pushed args
+    emit({0x48, 0x81, 0xC4});
+    emitInt32(static_cast<int>((argsSize + padding) * 8));
+    pushDepth -= argsSize + padding;
+
+    // cmp byte [r12 + 8], 0; jne bail
+    emit({0x41, 0x80, 0x7C, 0x24, 0x08, 0x00});
+    emitJump({0x0F, 0x85}, bailLabel);
+
+    return true;
+}
+
+bool JitCompiler::compileStore(IdentifierNode* id, ASTNode* expr) {
+    if (!isLocal(id) || !compileExpression(expr)) {
+        return false;
+    }
+
+    // mov [rbp + slot], rax
+    emit({0x48, 0x89, 0x85});
+    emitInt32(getLocalOffset(id->slot));
+
+    return true;
+}
+
+bool JitCompiler::isLocal(IdentifierNode* id) const {
+    // globals may be changed by the call and are not always exact int64
+    return id->storage == IdStorage::Local && id->slot < currentFunc->frameSize;
+}
+
+int JitCompiler::getLocalOffset(unsigned long slot) const {
+    return -24 - static_cast<int>(slot * 8);
+}
+
+void JitCompiler::emit(std::initializer_list<unsigned char> bytes) {
+    code.insert(code.end(), bytes.begin(), bytes.end());
+}
+
+void JitCompiler::emitInt32(int value) {
+    unsigned char bytes[sizeof(value)];
+    std::memcpy(bytes, &value, sizeof(value));
+    code.insert(code.end(), bytes, bytes + sizeof(value));
+}
+
+void JitCompiler::emitInt64(long long value) {
+    unsigned char bytes[sizeof(value)];
+    std::memcpy(bytes, &value, sizeof(value));
+    code.insert(code.end(), bytes, bytes + sizeof(value));
+}
+
+void JitCompiler::emitPushRax() {
+    emit({0x50});
+    pushDepth++;
+}
+
+void JitCompiler::emitPopRax() {
+    emit({0x58});
+    pushDepth--;
+}
+
+void JitCompiler::emitJump(std::initializer_list<unsigned char> opcode, unsigned long label) {
+    emit(opcode);
+    fixups.emplace_back(Fixup{code.size(), label});
+    emitInt32(0);
+}
+
+unsigned long JitCompiler::newLabel() {
+    labels.emplace_back(-1);
+    return labels.size() - 1;
+}
+
+void JitCompiler::bindLabel(unsigned long label) {
+    labels[label] = static_cast<long>(code.size());
+}
+
+NativeFunction* JitCompiler::install(ValueType::Type returnType) {
+#if REPL_JIT_SUPPORTED
+    // pages are never writable and executable at the same time
+    unsigned long pageSize = static_cast<unsigned long>(sysconf(_SC_PAGESIZE));
+    unsigned long pagesSize = (code.size() + pageSize - 1) / pageSize * pageSize;
+    void* pages = mmap(nullptr, pagesSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (pages == MAP_FAILED) {
+        return nullptr;
+    }
+
+    std::memcpy(pages, code.data(), code.size());
+    if (mprotect(pages, pagesSize, PROT_READ | PROT_EXEC) != 0) {
+        munmap(pages, pagesSize);
+        return nullptr;
+    }
+
+    return new NativeFunction{reinterpret_cast<NativeCode>(pages), pages, pagesSize, returnType, {}};
+#else
+    (void) returnType;
+    return nullptr;
+#endif
+}
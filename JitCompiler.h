@@ -0,0 +1,123 @@
+#ifndef REPL_JITCOMPILER_H
+#define REPL_JITCOMPILER_H
+
+#include "ASTNode.h"
+#include <initializer_list>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// shared by the native code of all calls made from one interpreted call
+struct JitContext {
+    // native calls that may still be nested, deeper recursion bails out
+    long long depthBudget;
+    // set when a result is not an exact int64, the interpreter reruns the whole call then
+    bool bailedOut;
+};
+
+typedef long long (*NativeCode)(const long long* args, JitContext* context);
+
+struct NativeFunction {
+    NativeCode code;
+    void* pages;
+    unsigned long pagesSize;
+    ValueType::Type returnType;
+    // translated functions the code calls by address
+    std::vector<std::string> callees;
+};
+
+// translates functions that work only with local numbers and bools, if, for and calls of
+// translated functions into x86-64 code, such functions have no side effects, so a call can
+// always be repeated in the interpreter when its native code bails out
+class JitCompiler {
+private:
+    struct Fixup {
+        unsigned long pos;
+        unsigned long label;
+    };
+
+    bool compileStatement(ASTNode* node);
+
+    bool compileBlockStmt(BlockStmtNode* node);
+
+    bool compileIfStmt(IfStmtNode* node);
+
+    bool compileForLoop(ForLoopNode* node);
+
+    bool compileExpression(ASTNode* node);
+
+    bool compileBinOp(BinOpNode* node);
+
+    bool compileFuncCall(FuncCallNode* node);
+
+    bool compileStore(IdentifierNode* id, ASTNode* expr);
+
+    bool isLocal(IdentifierNode* id) const;
+
+    int getLocalOffset(unsigned long slot) const;
+
+    void emit(std::initializer_list<unsigned char> bytes);
+
+    void emitInt32(int value);
+
+    void emitInt64(long long value);
+
+    void emitPushRax();
+
+    void emitPopRax();
+
+    void emitJump(std::initializer_list<unsigned char> opcode, unsigned long label);
+
+    unsigned long newLabel();
+
+    void bindLabel(unsigned long label);
+
+    NativeFunction* install(ValueType::Type returnType);
+
+    // frees the code of the function and of every function that calls it by address
+    void release(const std::string& name);
+
+    std::unordered_map<std::string, NativeFunction*> functions;
+
+    DeclFuncNode* currentFunc;
+
+    std::vector<unsigned char> code;
+
+    std::vector<long> labels;
+
+    std::vector<Fixup> fixups;
+
+    std::vector<unsigned long> loopExits;
+
+    std::vector<std::string> callees;
+
+    // values pushed on the native stack, calls keep it aligned to 16 bytes
+    unsigned long pushDepth;
+
+    unsigned long entryLabel;
+
+    unsigned long bailLabel;
+
+    unsigned long epilogueLabel;
+public:
+    JitCompiler() : currentFunc(nullptr), pushDepth(0), entryLabel(0), bailLabel(0),
+                    epilogueLabel(0) {};
+
+    ~JitCompiler();
+
+    // returns false when the function can't be translated, its calls stay interpreted then
+    bool compile(DeclFuncNode* func);
+
+    // nullptr for functions that were not translated
+    const NativeFunction* getFunction(const std::string& name) const;
+
+    // args are int64 numbers and bools as 0 or 1, returns false when the interpreter has to run the call,
+    // which happens as well when the call nests more than maxDepth native frames
+    static bool call(const NativeFunction* func, const std::vector<long long>& args, long long maxDepth,
+                     long long& result);
+
+    // native frames one interpreted call may nest at most
+    static const long long maxCallDepth = 1024;
+};
+
+#endif //REPL_JITCOMPILER_H
@@ -1,194 +1,389 @@
+#include <algorithm>
 #include <iostream>
 #include "Lexer.h"
 
-const TokenContainer Lexer::tokenize(const std::string& src) {
-    currentChar = src.begin();
+namespace {
+    // states the lexer enters on the first char of a token
+    namespace CharClass {
+        enum : unsigned char {
+            Invalid,
+            NewLine,
+            Word,
+            Digit,
+            // single char tokens, their types are in CharTable::singleTypes
+            Single,
+            Equal,
+            Minus,
+            Ampersand,
+            Pipe,
+            Eof
+        };
+    }
 
-    TokenContainer tokens;
+    struct CharTable {
+        unsigned char classes[256];
+        unsigned char singleTypes[256];
+        // values of single char tokens point here, so they do not depend on the source buffer
+        char chars[256];
 
-    while (true) {
-        Token token;
+        CharTable() {
+            for (unsigned int currentChar = 0; currentChar != 256; currentChar++) {
+                classes[currentChar] = CharClass::Invalid;
+                singleTypes[currentChar] = TokenType::eof;
+                chars[currentChar] = static_cast<char>(currentChar);
+            }
+
+            for (unsigned char currentChar = 'a'; currentChar <= 'z'; currentChar++) {
+                classes[currentChar] = CharClass::Word;
+                classes[currentChar - 'a' + 'A'] = CharClass::Word;
+            }
+            classes['_'] = CharClass::Word;
+            for (unsigned char currentChar = '0'; currentChar <= '9'; currentChar++) {
+                classes[currentChar] = CharClass::Digit;
+            }
+
+            classes['\n'] = CharClass::NewLine;
+            classes['='] = CharClass::Equal;
+            classes['-'] = CharClass::Minus;
+            classes['&'] = CharClass::Ampersand;
+            classes['|'] = CharClass::Pipe;
+            classes[static_cast<unsigned char>(EOF)] = CharClass::Eof;
+
+            addSingle('+', TokenType::Add);
+            addSingle('*', TokenType::Mul);
+            addSingle('/', TokenType::Div);
+            addSingle('(', TokenType::ROUND_BRACKET_START);
+            addSingle(')', TokenType::ROUND_BRACKET_END);
+            addSingle('[', TokenType::SQUARE_BRACKET_START);
+            addSingle(']', TokenType::SQUARE_BRACKET_END);
+            addSingle('{', TokenType::CURLY_BRACKET_START);
+            addSingle('}', TokenType::CURLY_BRACKET_END);
+            addSingle(';', TokenType::SEMICOLON);
+            addSingle(',', TokenType::Comma);
+            addSingle('<', TokenType::LESS);
+            addSingle('>', TokenType::GREATER);
+        }
+
+        void addSingle(unsigned char currentChar, unsigned char type) {
+            classes[currentChar] = CharClass::Single;
+            singleTypes[currentChar] = type;
+        }
+    };
+
+    const CharTable& getCharTable() {
+        static const CharTable table;
+        return table;
+    }
+
+    // tokens lexed before the container is sized for the whole input, source bytes per token range from 2.4
+    // to 3.9 across the language samples, so no fixed ratio fits
+    const unsigned long densitySampleCount = 1024;
+
+    // tokens of an input of inputSize bytes whose first sampleSize bytes took densitySampleCount tokens,
+    // with an eighth to spare
+    unsigned long estimateTokensCount(unsigned long inputSize, unsigned long sampleSize) {
+        return static_cast<unsigned long>(static_cast<double>(inputSize) * densitySampleCount / sampleSize * 1.125) + 1;
+    }
 
-        while (*currentChar == ' ') {
-            currentChar++;
+    unsigned char classOf(const CharTable& table, const char* currentChar) {
+        return table.classes[static_cast<unsigned char>(*currentChar)];
+    }
+
+    // '-' after these tokens (or at the start) negates the operand that follows
+    bool isUnaryMinusContext(unsigned char lastType) {
+        switch (lastType) {
+            case TokenType::eof:
+            case TokenType::Assign:
+            case TokenType::Add:
+            case TokenType::Sub:
+            case TokenType::Mul:
+            case TokenType::Div:
+            case TokenType::Equal:
+            case TokenType::LESS:
+            case TokenType::GREATER:
+            case TokenType::ROUND_BRACKET_START:
+            case TokenType::Comma: {
+                return true;
+            }
+            default: {
+                return false;
+            }
         }
+    }
+
+    struct Keyword {
+        const char* word;
+        unsigned char type;
+    };
+
+    // a new keyword only needs a line here, the static_assert below reports a hash collision
+    constexpr Keyword keywords[] = {
+            {"var",    TokenType::DeclareId},
+            {"func",   TokenType::DeclareFunc},
+            {"bool",   TokenType::BoolType},
+            {"int",    TokenType::IntType},
+            {"void",   TokenType::FuncReturnVoid},
+            {"return", TokenType::Return},
+            {"break",  TokenType::Break},
+            {"false",  TokenType::Bool},
+            {"true",   TokenType::Bool},
+            {"if",     TokenType::IfStmt},
+            {"else",   TokenType::ElseStmt},
+            {"for",    TokenType::ForLoopStmt}
+    };
+
+    constexpr unsigned long keywordsCount = sizeof(keywords) / sizeof(keywords[0]);
+
+    constexpr unsigned long keywordSlotsCount = 32;
+
+    constexpr unsigned long getLength(const char* str) {
+        return *str == '\0' ? 0 : 1 + getLength(str + 1);
+    }
+
+    // keyed on length, first and last char, words of other lengths are rejected before hashing
+    constexpr unsigned long getKeywordHash(unsigned long length, char first, char last) {
+        return (length * 2 + static_cast<unsigned char>(first) + static_cast<unsigned char>(last)) %
+               keywordSlotsCount;
+    }
+
+    constexpr unsigned long getKeywordHash(const char* word) {
+        return getKeywordHash(getLength(word), word[0], word[getLength(word) - 1]);
+    }
+
+    // true when keyword keywordNum shares its slot with none of the keywords after it
+    constexpr bool hasUniqueSlot(unsigned long keywordNum, unsigned long otherNum) {
+        return otherNum == keywordsCount ||
+               (getKeywordHash(keywords[keywordNum].word) != getKeywordHash(keywords[otherNum].word) &&
+                hasUniqueSlot(keywordNum, otherNum + 1));
+    }
+
+    constexpr bool isPerfectHash(unsigned long keywordNum) {
+        return keywordNum == keywordsCount ||
+               (hasUniqueSlot(keywordNum, keywordNum + 1) && isPerfectHash(keywordNum + 1));
+    }
+
+    static_assert(isPerfectHash(0), "two keywords share a slot, change getKeywordHash or keywordSlotsCount");
+
+    constexpr unsigned long getMaxKeywordLength(unsigned long keywordNum) {
+        return keywordNum == keywordsCount ? 0 :
+               getLength(keywords[keywordNum].word) > getMaxKeywordLength(keywordNum + 1) ?
+               getLength(keywords[keywordNum].word) : getMaxKeywordLength(keywordNum + 1);
+    }
+
+    constexpr unsigned long maxKeywordLength = getMaxKeywordLength(0);
+
+    struct KeywordTable {
+        StringRef words[keywordSlotsCount];
+        unsigned char types[keywordSlotsCount];
+
+        KeywordTable() {
+            for (unsigned long currentSlot = 0; currentSlot != keywordSlotsCount; currentSlot++) {
+                types[currentSlot] = TokenType::Id;
+            }
+
+            for (const auto& currentKeyword : keywords) {
+                unsigned long slot = getKeywordHash(currentKeyword.word);
+                words[slot] = currentKeyword.word;
+                types[slot] = currentKeyword.type;
+            }
+        }
+    };
+
+    unsigned char getKeywordType(const StringRef& word) {
+        static const KeywordTable table;
+
+        if (word.length > maxKeywordLength) {
+            return TokenType::Id;
+        }
+
+        unsigned long slot = getKeywordHash(word.length, word.data[0], word.data[word.length - 1]);
+        if (table.words[slot] != word) {
+            return TokenType::Id;
+        }
+        return table.types[slot];
+    }
+}
+
+const char* Lexer::scanToken(const char* currentChar, const char* end, unsigned char lastType, Token& token) const {
+    const CharTable& table = getCharTable();
 
-        if (*currentChar == '\n') {
+    switch (classOf(table, currentChar)) {
+        case CharClass::NewLine: {
             token.Type = TokenType::NL;
             token.Value = "\n";
-        } else if (isalpha(*currentChar) || (*currentChar == '_')) {
-            token = tokenizeStringLiteral();
-        } else if (*currentChar >= '0' && *currentChar <= '9') {
-            token = tokenizeNumber();
-        } else if (*currentChar == '=') {
-            if (*(currentChar + 1) == '=') {
-                currentChar++;
-
+            return currentChar + 1;
+        }
+        case CharClass::Word: {
+            return tokenizeWord(currentChar, end, token);
+        }
+        case CharClass::Digit: {
+            return tokenizeNumber(currentChar, end, token);
+        }
+        case CharClass::Single: {
+            unsigned char singleChar = static_cast<unsigned char>(*currentChar);
+            token.Type = table.singleTypes[singleChar];
+            token.Value = StringRef(&table.chars[singleChar], 1);
+            return currentChar + 1;
+        }
+        case CharClass::Equal: {
+            if (currentChar[1] == '=') {
                 token.Type = TokenType::Equal;
                 token.Value = "==";
-            } else {
-                token.Type = TokenType::Assign;
-                token.Value = "=";
+                return currentChar + 2;
             }
-        } else if (*currentChar == '+') {
-            token.Type = TokenType::Add;
-            token.Value = "+";
-        } else if (*currentChar == '-') {
-            if (tokens.size() == 0) {
+            token.Type = TokenType::Assign;
+            token.Value = "=";
+            return currentChar + 1;
+        }
+        case CharClass::Minus: {
+            if (isUnaryMinusContext(lastType)) {
                 token.Type = TokenType::UnaryMinus;
                 token.Value = "u-";
             } else {
-                const Token& lastOp = tokens.getTokens()[tokens.size() - 1];
-
-                if (lastOp.Type == TokenType::Assign || lastOp.Type == TokenType::Add ||
-                    lastOp.Type == TokenType::Sub || lastOp.Type == TokenType::Mul ||
-                    lastOp.Type == TokenType::Div || lastOp.Type == TokenType::Equal ||
-                    lastOp.Type == TokenType::LESS || lastOp.Type == TokenType::GREATER ||
-                    lastOp.Type == TokenType::ROUND_BRACKET_START || lastOp.Type == TokenType::Comma) {
-                    token.Type = TokenType::UnaryMinus;
-                    token.Value = "u-";
-                } else {
-                    token.Type = TokenType::Sub;
-                    token.Value = "-";
-                }
+                token.Type = TokenType::Sub;
+                token.Value = "-";
             }
-        } else if (*currentChar == '*') {
-            token.Type = TokenType::Mul;
-            token.Value = "*";
-        } else if (*currentChar == '/') {
-            token.Type = TokenType::Div;
-            token.Value = "/";
-        } else if (*currentChar == '&' && *(currentChar + 1) == '&') {
-            token.Type = TokenType::BoolAND;
-            token.Value = "&&";
-
-            currentChar++;
-        } else if (*currentChar == '|' && *(currentChar + 1) == '|') {
-            token.Type = TokenType::BoolOR;
-            token.Value = "||";
-
-            currentChar++;
-        } else if (*currentChar == '(') {
-            token.Type = TokenType::ROUND_BRACKET_START;
-            token.Value = "(";
-        } else if (*currentChar == ')') {
-            token.Type = TokenType::ROUND_BRACKET_END;
-            token.Value = ")";
-        } else if (*currentChar == '[') {
-            token.Type = TokenType::SQUARE_BRACKET_START;
-            token.Value = "[";
-        } else if (*currentChar == ']') {
-            token.Type = TokenType::SQUARE_BRACKET_END;
-            token.Value = "]";
-        } else if (*currentChar == '{') {
-            token.Type = TokenType::CURLY_BRACKET_START;
-            token.Value = "{";
-        } else if (*currentChar == '}') {
-            token.Type = TokenType::CURLY_BRACKET_END;
-            token.Value = "}";
-        } else if (*currentChar == ';') {
-            token.Type = TokenType::SEMICOLON;
-            token.Value = ";";
-        } else if (*currentChar == ',') {
-            token.Type = TokenType::Comma;
-            token.Value = ",";
-        } else if (*currentChar == '<') {
-            token.Type = TokenType::LESS;
-            token.Value = "<";
-        } else if (*currentChar == '>') {
-            token.Type = TokenType::GREATER;
-            token.Value = ">";
-        } else if (*currentChar == EOF) {
-            tokens.addNewToken(Token{TokenType::eof, "EOF"});
-            break;
-        } else {
+            return currentChar + 1;
+        }
+        case CharClass::Ampersand:
+        case CharClass::Pipe: {
+            if (currentChar[1] != currentChar[0]) {
+                throw std::runtime_error(std::string("Invalid char ") + "'" + *currentChar + "'");
+            }
+            if (*currentChar == '&') {
+                token.Type = TokenType::BoolAND;
+                token.Value = "&&";
+            } else {
+                token.Type = TokenType::BoolOR;
+                token.Value = "||";
+            }
+            return currentChar + 2;
+        }
+        case CharClass::Eof: {
+            token.Type = TokenType::eof;
+            token.Value = "EOF";
+            return currentChar + 1;
+        }
+        default: {
             throw std::runtime_error(std::string("Invalid char ") + "'" + *currentChar + "'");
         }
+    }
+}
+
+TokenContainer Lexer::tokenize(const std::string& src) {
+    const char* currentChar = src.c_str();
+    const char* end = currentChar + src.size();
+
+    TokenContainer tokens;
+    // every token takes at least a char
+    tokens.reserve(std::min<unsigned long>(src.size() + 1, densitySampleCount));
+    unsigned char lastType = TokenType::eof;
+
+    while (true) {
+        if (*currentChar == ' ') {
+            currentChar = scanner.skipSpaces(currentChar + 1, end);
+            continue;
+        }
 
+        Token token;
+        currentChar = scanToken(currentChar, end, lastType, token);
+
+        token.line = line;
         tokens.addNewToken(token);
-        currentChar++;
-    }
+        if (token.Type == TokenType::eof) {
+            return tokens;
+        } else if (token.Type == TokenType::NL) {
+            line++;
+        }
+        lastType = token.Type;
 
-    return tokens;
+        if (tokens.size() == densitySampleCount) {
+            tokens.reserve(estimateTokensCount(src.size(), static_cast<unsigned long>(currentChar - src.c_str())));
+        }
+    }
 }
 
-const Token Lexer::tokenizeStringLiteral() {
-    Token token;
-
-    std::string strLiteral;
-    strLiteral += *currentChar;
-
-    while ((*(currentChar + 1) >= 'a' && *(currentChar + 1) <= 'z') ||
-           (*(currentChar + 1) >= 'A' && *(currentChar + 1) <= 'Z') ||
-           (*(currentChar + 1) >= '0' && *(currentChar + 1) <= '9') || (*(currentChar + 1) == '_')) {
-        currentChar++;
-        strLiteral += *currentChar;
-    }
-
-    if (strLiteral == "var") {
-        token.Type = TokenType::DeclareId;
-        token.Value = "var";
-    } else if (strLiteral == "func") {
-        token.Type = TokenType::DeclareFunc;
-        token.Value = "func";
-    } else if (strLiteral == "bool") {
-        token.Type = TokenType::BoolType;
-        token.Value = strLiteral;
-    } else if (strLiteral == "int") {
-        token.Type = TokenType::IntType;
-        token.Value = strLiteral;
-    } else if (strLiteral == "void") {
-        token.Type = TokenType::FuncReturnVoid;
-        token.Value = strLiteral;
-    } else if (strLiteral == "return") {
-        token.Type = TokenType::Return;
-        token.Value = strLiteral;
-    } else if (strLiteral == "break") {
-        token.Type = TokenType::Break;
-        token.Value = strLiteral;
-    } else if (strLiteral == "false" || strLiteral == "true") {
-        token.Type = TokenType::Bool;
-
-        if (strLiteral == "false") {
-            token.Value = "0";
-        } else {
-            token.Value = "1";
-        }
-    } else if (strLiteral == "if") {
-        token.Type = TokenType::IfStmt;
-        token.Value = strLiteral;
-    } else if (strLiteral == "else") {
-        token.Type = TokenType::ElseStmt;
-        token.Value = strLiteral;
-    } else if (strLiteral == "for") {
-        token.Type = TokenType::ForLoopStmt;
-        token.Value = strLiteral;
-    } else {
-        if (*(currentChar + 1) == '(') {
-            token.Type = TokenType::FuncCall;
-        } else {
-            token.Type = TokenType::Id;
-        }
-        token.Value = strLiteral;
-    }
-
-    return token;
+void Lexer::readToken(ChunkReader& reader, unsigned char lastType, Token& token) {
+    while (true) {
+        const char* begin = reader.getData();
+        const char* end = begin + reader.getSize();
+        const char* currentChar = begin + reader.getPosition();
+
+        // two chars are enough to tell every operator, longer words and numbers are rescanned below
+        if (end - currentChar < 2 && !reader.isFinished()) {
+            reader.refill();
+            continue;
+        }
+
+        if (*currentChar == ' ') {
+            reader.setPosition(static_cast<unsigned long>(scanner.skipSpaces(currentChar + 1, end) - begin));
+            continue;
+        }
+
+        const char* tokenEnd = scanToken(currentChar, end, lastType, token);
+        // the token may go on in the next chunk
+        if (tokenEnd >= end && !reader.isFinished()) {
+            reader.refill();
+            continue;
+        }
+        reader.setPosition(static_cast<unsigned long>(tokenEnd - begin));
+
+        token.line = line;
+        if (token.Type == TokenType::NL) {
+            line++;
+        }
+        return;
+    }
 }
 
+TokenContainer Lexer::tokenize(ChunkReader& reader) {
+    TokenContainer tokens;
+    // pipes give no size hint, their container grows as it fills
+    tokens.reserve(std::min<unsigned long>(reader.getSizeHint() + 1, densitySampleCount));
+    unsigned char lastType = TokenType::eof;
 
-const Token Lexer::tokenizeNumber() {
-    Token token;
+    while (true) {
+        Token token;
+        readToken(reader, lastType, token);
 
-    std::string token_val;
-    token_val += *currentChar;
+        // words and numbers are slices of the buffer, which is overwritten by the next refill
+        if (reader.isInBuffer(token.Value.data)) {
+            token.Value = tokens.copyLexeme(token.Value);
+        }
 
-    while ((*(currentChar + 1) >= '0' && *(currentChar + 1) <= '9') || *(currentChar + 1) == '.') {
-        currentChar++;
-        token_val += *currentChar;
+        tokens.addNewToken(token);
+        if (token.Type == TokenType::eof) {
+            return tokens;
+        }
+        lastType = token.Type;
+
+        if (tokens.size() == densitySampleCount && reader.getSizeHint() != 0) {
+            tokens.reserve(estimateTokensCount(reader.getSizeHint(), reader.getConsumedSize()));
+        }
     }
+}
+
+const char* Lexer::tokenizeWord(const char* start, const char* end, Token& token) const {
+    const char* currentChar = scanner.skipWord(start + 1, end);
+
+    StringRef word(start, static_cast<unsigned long>(currentChar - start));
+    token.Type = getKeywordType(word);
+    token.Value = word;
+
+    if (token.Type == TokenType::Bool) {
+        token.Value = *start == 't' ? "1" : "0";
+    } else if (token.Type == TokenType::Id && *currentChar == '(') {
+        token.Type = TokenType::FuncCall;
+    }
+
+    return currentChar;
+}
+
+const char* Lexer::tokenizeNumber(const char* start, const char* end, Token& token) const {
+    const char* currentChar = scanner.skipNumber(start + 1, end);
 
     token.Type = TokenType::Number;
-    token.Value = token_val;
+    token.Value = StringRef(start, static_cast<unsigned long>(currentChar - start));
 
-    return token;
-}
\ No newline at end of file
+    return currentChar;
+}
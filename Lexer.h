@@ -4,20 +4,40 @@
 #include "Token.h"
 #include "Identifier.h"
 #include "TokenContainer.h"
+#include "CharScanner.h"
+#include "ChunkReader.h"
 #include <vector>
 #include <string>
 #include <unordered_map>
 
 class Lexer {
 private:
-    std::string::const_iterator currentChar;
+    // scans the token starting at the non-space char currentChar, returns the char after it
+    const char* scanToken(const char* currentChar, const char* end, unsigned char lastType, Token& token) const;
 
-    const Token tokenizeStringLiteral();
+    // scans the identifier or keyword starting at start, returns the char after it
+    const char* tokenizeWord(const char* start, const char* end, Token& token) const;
 
-    const Token tokenizeNumber();
+    // scans the digits and dots starting at start, returns the char after them
+    const char* tokenizeNumber(const char* start, const char* end, Token& token) const;
 
+    CharScanner scanner;
+
+    unsigned int line;
 public:
-    const TokenContainer tokenize(const std::string& src);
+    Lexer() : line(1) {};
+
+    explicit Lexer(ScanKind::Type scanKind) : scanner(scanKind), line(1) {};
+
+    // tokens reference src, it must stay alive while they are used
+    TokenContainer tokenize(const std::string& src);
+
+    // reads the input chunk by chunk, so it is never held in memory as a whole, tokens own their values
+    TokenContainer tokenize(ChunkReader& reader);
+
+    // reads the token that follows one of type lastType (eof for the first token), its value may point into
+    // the reader buffer until the next call
+    void readToken(ChunkReader& reader, unsigned char lastType, Token& token);
 };
 
 #endif //BASHCOMPILER_LEXER_H
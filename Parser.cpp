@@ -1,151 +1,155 @@
 #include "Parser.h"
+#include <cerrno>
+#include <cstdlib>
 
-ASTNode* Parser::parseExpression() {
-    std::pair<std::queue<Token>, std::queue<ASTNode*>> expr = convertToReversePolish();
-
-    std::queue<Token>& exprTokens = expr.first;
-    std::queue<ASTNode*>& funcCallNodes = expr.second;
-
-    std::stack<ASTNode*> nodeStack;
-
-    Token currentToken;
-    while (!exprTokens.empty()) {
-        currentToken = exprTokens.front();
-        exprTokens.pop();
-
-        if (!isOperator(currentToken)) {
-            switch (currentToken.Type) {
-                case TokenType::Number: {
-                    nodeStack.push(createNumberNode(getNumTokenValue(currentToken)));
-                    break;
-                }
-                case TokenType::Bool: {
-                    nodeStack.push(createBoolNode(getBoolTokenValue(currentToken)));
-                    break;
-                }
-                case TokenType::Id: {
-                    nodeStack.push(createIdentifierNode(currentToken.Value));
-                    break;
-                }
-                case TokenType::FuncCall: {
-                    nodeStack.push(funcCallNodes.front());
-                    funcCallNodes.pop();
-                    break;
-                }
-                default: {
-                    errorExpected("Rvalue or Identifier", currentToken);
-                }
-            }
-        } else {
-            if (isBinaryOperator(currentToken)) { // binary operator
-                ASTNode* operationNode;
-
-                // since stack is LIFO need to get 2nd operand first to not break the order of operands
-                ASTNode* operand1;
-                ASTNode* operand2;
-
-                if (nodeStack.size() >= 2) {
-                    operand2 = nodeStack.top();
-                    nodeStack.pop();
-                    operand1 = nodeStack.top();
-                    nodeStack.pop();
-                } else {
-                    throw std::runtime_error("Invalid Syntax: Not enough operands for binary operation");
-                }
-
-                switch (currentToken.Type) {
-                    case TokenType::Add: {
-                        operationNode = createBinOpNode(BinOpType::OperatorPlus, operand1, operand2);
-                        nodeStack.push(operationNode);
-                        break;
-                    }
-                    case TokenType::Sub: {
-                        operationNode = createBinOpNode(BinOpType::OperatorMinus, operand1, operand2);
-                        nodeStack.push(operationNode);
-                        break;
-                    }
-                    case TokenType::Mul: {
-                        operationNode = createBinOpNode(BinOpType::OperatorMul, operand1, operand2);
-                        nodeStack.push(operationNode);
-                        break;
-                    }
-                    case TokenType::Div: {
-                        operationNode = createBinOpNode(BinOpType::OperatorDiv, operand1, operand2);
-                        nodeStack.push(operationNode);
-                        break;
-                    }
-                    case TokenType::BoolAND: {
-                        operationNode = createBinOpNode(BinOpType::OperatorBoolAND, operand1, operand2);
-                        nodeStack.push(operationNode);
-                        break;
-                    }
-                    case TokenType::BoolOR: {
-                        operationNode = createBinOpNode(BinOpType::OperatorBoolOR, operand1, operand2);
-                        nodeStack.push(operationNode);
-                        break;
-                    }
-                    case TokenType::Equal: {
-                        operationNode = createBinOpNode(BinOpType::OperatorEqual, operand1, operand2);
-                        nodeStack.push(operationNode);
-                        break;
-                    }
-                    case TokenType::LESS: {
-                        operationNode = createBinOpNode(BinOpType::OperatorLess, operand1, operand2);
-                        nodeStack.push(operationNode);
-                        break;
-                    }
-                    case TokenType::GREATER: {
-                        operationNode = createBinOpNode(BinOpType::OperatorGreater, operand1, operand2);
-                        nodeStack.push(operationNode);
-                        break;
-                    }
-                    case TokenType::Assign: {
-                        if (operand1->type == NodeType::Id) {
-                            operationNode = createBinOpNode(BinOpType::OperatorAssign, operand1, operand2);
-                            nodeStack.push(operationNode);
-                        } else {
-                            errorExpected("Identifier on the left side of assign operator");
-                        }
-                        break;
-                    }
-                    default: {
-                        errorExpected("Binary operator", currentToken);
-                    }
-                }
-            } else { // unary operator
-                ASTNode* operationNode;
-
-                ASTNode* operand;
-
-                if (nodeStack.size() >= 1) {
-                    operand = nodeStack.top();
-                    nodeStack.pop();
-                } else {
-                    throw std::runtime_error("Invalid Syntax: Not enough operands for unary operation");
-                }
-
-                switch (currentToken.Type) {
-                    case TokenType::UnaryMinus: {
-                        operationNode = createBinOpNode(BinOpType::OperatorMinus, createNumberNode(0), operand);
-                        nodeStack.push(operationNode);
-                        break;
-                    }
-                    default: {
-                        errorExpected("Unary operator", currentToken);
-                    }
-                }
+namespace {
+    struct BinaryOperator {
+        int precedence;
+        BinOpType::Type binOpType;
+    };
+
+    // binary operators indexed by token type, precedence 0 means the token is not a binary operator
+    struct BinaryOperatorTable {
+        BinaryOperator operators[TokenType::TypesCount];
+
+        BinaryOperatorTable() {
+            for (auto& currentOperator : operators) {
+                currentOperator = BinaryOperator{0, BinOpType::OperatorAssign};
             }
+            operators[TokenType::Assign] = BinaryOperator{1, BinOpType::OperatorAssign};
+            operators[TokenType::BoolOR] = BinaryOperator{2, BinOpType::OperatorBoolOR};
+            operators[TokenType::BoolAND] = BinaryOperator{3, BinOpType::OperatorBoolAND};
+            operators[TokenType::Equal] = BinaryOperator{4, BinOpType::OperatorEqual};
+            operators[TokenType::LESS] = BinaryOperator{5, BinOpType::OperatorLess};
+            operators[TokenType::GREATER] = BinaryOperator{5, BinOpType::OperatorGreater};
+            operators[TokenType::Add] = BinaryOperator{6, BinOpType::OperatorPlus};
+            operators[TokenType::Sub] = BinaryOperator{6, BinOpType::OperatorMinus};
+            operators[TokenType::Mul] = BinaryOperator{7, BinOpType::OperatorMul};
+            operators[TokenType::Div] = BinaryOperator{7, BinOpType::OperatorDiv};
+        }
+    };
+
+    const BinaryOperatorTable binaryOperators;
+
+    // binds tighter than any binary operator
+    const int unaryMinusPrecedence = 8;
+}
+
+ASTNode* Parser::parseExpression() {
+    ASTNode* expr = parseSubExpression(0);
+
+    const Token& nextToken = tokens->lookNextToken();
+    if (isExpressionEnd(nextToken)) {
+        return expr;
+    }
+
+    switch (nextToken.Type) {
+        case TokenType::ROUND_BRACKET_END: {
+            errorExpected("Left Round Bracket");
+            throw;
+        }
+        case TokenType::Number:
+        case TokenType::Bool:
+        case TokenType::Id:
+        case TokenType::FuncCall:
+        case TokenType::UnaryMinus:
+        case TokenType::ROUND_BRACKET_START: {
+            throw std::runtime_error("Invalid expression");
+        }
+        default: {
+            throw std::runtime_error("Unexpected token: " + nextToken.Value);
         }
     }
+}
+
+ASTNode* Parser::parseSubExpression(int minPrecedence) {
+    ASTNode* left = parseOperand();
+
+    while (true) {
+        const Token& opToken = tokens->lookNextToken();
+        const BinaryOperator& op = binaryOperators.operators[opToken.Type];
+        if (op.precedence == 0 || op.precedence < minPrecedence) {
+            break;
+        }
+        tokens->getNextToken();
+
+        if (isOperandMissing()) {
+            throw std::runtime_error("Invalid Syntax: Not enough operands for binary operation");
+        }
+
+        // assignment is right associative, everything else is left associative
+        int rightMinPrecedence = op.binOpType == BinOpType::OperatorAssign ? op.precedence : op.precedence + 1;
+        ASTNode* right = parseSubExpression(rightMinPrecedence);
+
+        if (op.binOpType == BinOpType::OperatorAssign && left->type != NodeType::Id) {
+            errorExpected("Identifier on the left side of assign operator");
+        }
 
-    if (nodeStack.empty()) {
-        errorExpected("Expression");
+        left = createBinOpNode(op.binOpType, left, right);
     }
-    if (nodeStack.size() > 1) {
-        throw std::runtime_error("Invalid expression");
+
+    return left;
+}
+
+ASTNode* Parser::parseOperand() {
+    const Token& currentToken = tokens->lookNextToken();
+
+    switch (currentToken.Type) {
+        case TokenType::Number: {
+            tokens->getNextToken();
+            return createNumberNode(currentToken);
+        }
+        case TokenType::Bool: {
+            tokens->getNextToken();
+            return createBoolNode(getBoolTokenValue(currentToken));
+        }
+        case TokenType::Id: {
+            tokens->getNextToken();
+            return createIdentifierNode(currentToken.Value);
+        }
+        case TokenType::FuncCall: {
+            return parseFuncCall();
+        }
+        case TokenType::UnaryMinus: {
+            tokens->getNextToken();
+            if (isOperandMissing()) {
+                throw std::runtime_error("Invalid Syntax: Not enough operands for unary operation");
+            }
+            ASTNode* operand = parseSubExpression(unaryMinusPrecedence);
+            return createBinOpNode(BinOpType::OperatorMinus, createNumberNode(0), operand);
+        }
+        case TokenType::ROUND_BRACKET_START: {
+            tokens->getNextToken();
+
+            ASTNode* expr = parseSubExpression(0);
+
+            if (tokens->lookNextToken().Type != TokenType::ROUND_BRACKET_END) {
+                errorExpected("Right Round Bracket");
+            }
+            tokens->getNextToken();
+
+            return expr;
+        }
+        default: {
+            if (isOperandMissing()) {
+                errorExpected("Expression");
+            }
+            throw std::runtime_error("Unexpected token: " + currentToken.Value);
+        }
     }
+}
 
-    return nodeStack.top();
+bool Parser::isOperandMissing() {
+    const Token& nextToken = tokens->lookNextToken();
+    return isExpressionEnd(nextToken) || nextToken.Type == TokenType::ROUND_BRACKET_END ||
+           binaryOperators.operators[nextToken.Type].precedence != 0;
+}
+
+bool Parser::isExpressionEnd(const Token& token) {
+    return token.Type == TokenType::NL || token.Type == TokenType::CURLY_BRACKET_START ||
+           token.Type == TokenType::CURLY_BRACKET_END || token.Type == TokenType::SEMICOLON ||
+           token.Type == TokenType::Comma || token.Type == TokenType::eof ||
+           (token.Type == TokenType::ROUND_BRACKET_END && parenthesesControl);
 }
 
 DeclVarNode* Parser::parseDeclVar() {
@@ -154,18 +158,18 @@ DeclVarNode* Parser::parseDeclVar() {
     IdentifierNode* id = parseIdentifier();
     ASTNode* expr = nullptr;
 
-    const Token& nextToken = tokens.getNextToken();
+    const Token& nextToken = tokens->getNextToken();
     if (nextToken.Type == TokenType::Assign) {
         expr = parseExpression();
     } else {
-        tokens.returnToken();
+        tokens->returnToken();
     }
 
     return createDeclVarNode(id, expr);
 }
 
 IdentifierNode* Parser::parseIdentifier() {
-    const Token& token = tokens.getNextToken();
+    const Token& token = tokens->getNextToken();
 
     if (token.Type != TokenType::Id) {
         errorExpected("identifier", token);
@@ -173,19 +177,20 @@ IdentifierNode* Parser::parseIdentifier() {
     return createIdentifierNode(token.Value);
 }
 
-std::string Parser::parseFuncName() {
-    const Token& token = tokens.getNextToken();
+StringRef Parser::parseFuncName() {
+    const Token& token = tokens->getNextToken();
 
     if (token.Type != TokenType::FuncCall) {
         errorExpected("Function name", token);
     }
-    return token.Value;
+    // the token may leave the window of a lazy container before the call or declaration is parsed
+    return arena.copyString(token.Value);
 }
 
 std::vector<ASTNode*> Parser::parseFuncCallParams() {
     std::vector<ASTNode*> args;
 
-    while (tokens.lookNextToken().Type != TokenType::ROUND_BRACKET_END) {
+    while (tokens->lookNextToken().Type != TokenType::ROUND_BRACKET_END) {
         ASTNode* arg = parseExpression();
         if (arg->type != NodeType::ConstNumber && arg->type != NodeType::ConstBool && arg->type != NodeType::Id &&
             arg->type != NodeType::BinOp && arg->type != NodeType::FuncCall) {
@@ -207,7 +212,7 @@ std::vector<ASTNode*> Parser::parseFuncCallParams() {
         }
 
         args.emplace_back(arg);
-        if (tokens.lookNextToken().Type != TokenType::ROUND_BRACKET_END) {
+        if (tokens->lookNextToken().Type != TokenType::ROUND_BRACKET_END) {
             expect(",");
         }
     }
@@ -216,7 +221,7 @@ std::vector<ASTNode*> Parser::parseFuncCallParams() {
 }
 
 FuncCallNode* Parser::parseFuncCall() {
-    const std::string name = parseFuncName();
+    StringRef name = parseFuncName();
     expect("(");
 
     bool oldParenthesesControl = parenthesesControl;
@@ -232,7 +237,7 @@ FuncCallNode* Parser::parseFuncCall() {
 }
 
 ValueType::Type Parser::parseDeclFuncReturnType() {
-    const Token& token = tokens.getNextToken();
+    const Token& token = tokens->getNextToken();
 
     if (token.Value == "int") {
         return ValueType::Number;
@@ -250,12 +255,12 @@ std::vector<IdentifierNode*> Parser::parseDeclFuncParams() {
     std::vector<IdentifierNode*> args;
 
     Token nextToken;
-    while ((nextToken = tokens.lookNextToken()).Type != TokenType::ROUND_BRACKET_END &&
+    while ((nextToken = tokens->lookNextToken()).Type != TokenType::ROUND_BRACKET_END &&
            nextToken.Type != TokenType::eof && nextToken.Type != TokenType::NL) {
         expect("var");
 
         ValueType::Type paramType;
-        const Token& paramTypeToken = tokens.getNextToken();
+        const Token& paramTypeToken = tokens->getNextToken();
         if (paramTypeToken.Type == TokenType::IntType) {
             paramType = ValueType::Number;
         } else if (paramTypeToken.Type == TokenType::BoolType) {
@@ -268,7 +273,7 @@ std::vector<IdentifierNode*> Parser::parseDeclFuncParams() {
         IdentifierNode* id = parseIdentifier();
         id->valueType = paramType;
         args.emplace_back(id);
-        if (tokens.lookNextToken().Type != TokenType::ROUND_BRACKET_END) {
+        if (tokens->lookNextToken().Type != TokenType::ROUND_BRACKET_END) {
             expect(",");
         }
     }
@@ -277,10 +282,11 @@ std::vector<IdentifierNode*> Parser::parseDeclFuncParams() {
 }
 
 DeclFuncNode* Parser::parseDeclFunc() {
+    unsigned int line = tokens->lookNextToken().line;
     expect("func");
 
     ValueType::Type returnType = parseDeclFuncReturnType();
-    const std::string& funcName = parseFuncName();
+    StringRef funcName = parseFuncName();
     if (funcName == "print") {
         throw std::runtime_error("Can not overwrite built-in 'print' function");
     }
@@ -292,14 +298,16 @@ DeclFuncNode* Parser::parseDeclFunc() {
 
     BlockStmtNode* body = parseBlockStmt();
 
-    return createDeclFuncNode(funcName, returnType, args, body);
+    DeclFuncNode* node = createDeclFuncNode(funcName, returnType, args, body);
+    node->line = line;
+    return node;
 }
 
 ReturnStmtNode* Parser::parseReturnStmt() {
     expect("return");
 
     ASTNode* expr = nullptr;
-    if (tokens.lookNextToken().Type != TokenType::NL && tokens.lookNextToken().Type != TokenType::CURLY_BRACKET_END) {
+    if (tokens->lookNextToken().Type != TokenType::NL && tokens->lookNextToken().Type != TokenType::CURLY_BRACKET_END) {
         expr = parseExpression();
     }
 
@@ -307,7 +315,7 @@ ReturnStmtNode* Parser::parseReturnStmt() {
 }
 
 BreakStmtNode* Parser::parseBreakStmt() {
-    tokens.getNextToken();
+    tokens->getNextToken();
     return createBreakStmtNode();
 }
 
@@ -317,7 +325,7 @@ BlockStmtNode* Parser::parseBlockStmt() {
 
     std::vector<ASTNode*> stmtList;
     Token nextToken;
-    while ((nextToken = tokens.lookNextToken()).Type != TokenType::CURLY_BRACKET_END &&
+    while ((nextToken = tokens->lookNextToken()).Type != TokenType::CURLY_BRACKET_END &&
            nextToken.Type != TokenType::eof) {
         stmtList.emplace_back(parseStatement());
     }
@@ -365,9 +373,9 @@ IfStmtNode* Parser::parseIfStmt() {
 
     while (true) {
         skipWhitespaces();
-        if (tokens.lookNextToken().Type == TokenType::ElseStmt) {
-            tokens.getNextToken();
-            if (tokens.lookNextToken().Type == TokenType::IfStmt) {
+        if (tokens->lookNextToken().Type == TokenType::ElseStmt) {
+            tokens->getNextToken();
+            if (tokens->lookNextToken().Type == TokenType::IfStmt) {
                 elseIfStmts.emplace_back(parseElseIfStmt());
             } else {
                 skipWhitespaces();
@@ -375,8 +383,8 @@ IfStmtNode* Parser::parseIfStmt() {
                 break;
             }
         } else {
-            if (tokens.lookNextToken().Type != TokenType::CURLY_BRACKET_END) {
-                tokens.returnToken(); // return ending if instruction newline that we skipped calling SkipWhitespaces()
+            if (tokens->lookNextToken().Type != TokenType::CURLY_BRACKET_END) {
+                tokens->returnToken(); // return ending if instruction newline that we skipped calling SkipWhitespaces()
             }
             break;
         }
@@ -388,19 +396,19 @@ IfStmtNode* Parser::parseIfStmt() {
 ASTNode* Parser::parseForLoopInit() {
     ASTNode* init;
 
-    const Token& currentToken = tokens.getNextToken();
+    const Token& currentToken = tokens->getNextToken();
     switch (currentToken.Type) {
         case TokenType::DeclareId: {
-            tokens.returnToken();
+            tokens->returnToken();
             init = parseDeclVar();
             break;
         }
         case TokenType::Id: {
-            const Token& nextOp = tokens.lookNextToken();
+            const Token& nextOp = tokens->lookNextToken();
             if (nextOp.Type != TokenType::Assign) {
                 throw std::runtime_error("Invalid for loop initialization expression");
             }
-            tokens.returnToken();
+            tokens->returnToken();
             init = parseExpression();
             break;
         }
@@ -414,6 +422,7 @@ ASTNode* Parser::parseForLoopInit() {
 }
 
 ForLoopNode* Parser::parseForLoop() {
+    unsigned int line = tokens->lookNextToken().line;
     expect("for");
     expect("(");
 
@@ -421,21 +430,21 @@ ForLoopNode* Parser::parseForLoop() {
     ASTNode* condition;
     BinOpNode* inc;
 
-    if (tokens.lookNextToken().Type != TokenType::SEMICOLON) {
+    if (tokens->lookNextToken().Type != TokenType::SEMICOLON) {
         init = parseForLoopInit();
     } else {
         init = nullptr;
     }
     expect(";");
 
-    if (tokens.lookNextToken().Type != TokenType::SEMICOLON) {
+    if (tokens->lookNextToken().Type != TokenType::SEMICOLON) {
         condition = parseExpression();
     } else {
         condition = nullptr;
     }
     expect(";");
 
-    if (tokens.lookNextToken().Type != TokenType::ROUND_BRACKET_END) {
+    if (tokens->lookNextToken().Type != TokenType::ROUND_BRACKET_END) {
         bool oldParenthesesControl = parenthesesControl;
         parenthesesControl = true;
 
@@ -456,13 +465,15 @@ ForLoopNode* Parser::parseForLoop() {
 
     BlockStmtNode* body = parseBlockStmt();
 
-    return createForLoopNode(init, condition, inc, body);
+    ForLoopNode* node = createForLoopNode(init, condition, inc, body);
+    node->line = line;
+    return node;
 }
 
 ASTNode* Parser::parseStatement() {
     ASTNode* parseResult;
 
-    const Token& currentToken = tokens.lookNextToken();
+    const Token& currentToken = tokens->lookNextToken();
     switch (currentToken.Type) {
         case TokenType::Id:
         case TokenType::FuncCall:
@@ -503,7 +514,7 @@ ASTNode* Parser::parseStatement() {
         }
     }
 
-    if (tokens.lookNextToken().Type != TokenType::CURLY_BRACKET_END) {
+    if (tokens->lookNextToken().Type != TokenType::CURLY_BRACKET_END) {
         expect("\n");
     }
     skipWhitespaces();
@@ -511,22 +522,28 @@ ASTNode* Parser::parseStatement() {
     return parseResult;
 }
 
-ProgramTranslationNode* Parser::parse(const TokenContainer& sourceData) {
-    tokens = sourceData;
+Arena& Parser::getArena() {
+    return arena;
+}
+
+ProgramTranslationNode* Parser::parse(TokenContainer& sourceData) {
+    tokens = &sourceData;
 
-    ProgramTranslationNode* ast = new ProgramTranslationNode();
+    ProgramTranslationNode* ast = arena.create<ProgramTranslationNode>();
 
+    std::vector<ASTNode*> statements;
     skipWhitespaces();
-    while (tokens.lookNextToken().Type != TokenType::eof) {
+    while (tokens->lookNextToken().Type != TokenType::eof) {
         ASTNode* currentStatement = parseStatement();
-        ast->statements.emplace_back(currentStatement);
+        statements.emplace_back(currentStatement);
     }
+    ast->statements = arena.copyArray(statements);
 
     return ast;
 }
 
 BinOpNode* Parser::createBinOpNode(BinOpType::Type type, ASTNode* left, ASTNode* right) {
-    BinOpNode* node = new BinOpNode;
+    BinOpNode* node = arena.create<BinOpNode>();
     node->binOpType = type;
     node->left = left;
     node->right = right;
@@ -535,55 +552,73 @@ BinOpNode* Parser::createBinOpNode(BinOpType::Type type, ASTNode* left, ASTNode*
 }
 
 ConstNumberNode* Parser::createNumberNode(double value) {
-    ConstNumberNode* node = new ConstNumberNode;
+    ConstNumberNode* node = arena.create<ConstNumberNode>();
     node->value = value;
+    node->isInt = IntArithmetic::fromDouble(value, node->intValue);
 
     return node;
 }
 
+ConstNumberNode* Parser::createNumberNode(const Token& numToken) {
+    // integer literals are parsed as int64, so they stay exact above 2^53
+    if (std::memchr(numToken.Value.data, '.', numToken.Value.length) == nullptr) {
+        std::string digits(numToken.Value);
+        errno = 0;
+        long long value = std::strtoll(digits.c_str(), nullptr, 10);
+        if (errno == 0) {
+            ConstNumberNode* node = createNumberNode(static_cast<double>(value));
+            node->isInt = true;
+            node->intValue = value;
+            return node;
+        }
+    }
+
+    return createNumberNode(getNumTokenValue(numToken));
+}
+
 ConstBoolNode* Parser::createBoolNode(bool value) {
-    ConstBoolNode* node = new ConstBoolNode;
+    ConstBoolNode* node = arena.create<ConstBoolNode>();
     node->value = value;
 
     return node;
 }
 
 ReturnStmtNode* Parser::createReturnStmtNode(ASTNode* expr) {
-    ReturnStmtNode* node = new ReturnStmtNode;
+    ReturnStmtNode* node = arena.create<ReturnStmtNode>();
     node->expression = expr;
 
     return node;
 }
 
 BreakStmtNode* Parser::createBreakStmtNode() {
-    BreakStmtNode* node = new BreakStmtNode;
+    BreakStmtNode* node = arena.create<BreakStmtNode>();
     return node;
 }
 
-IdentifierNode* Parser::createIdentifierNode(const std::string& name) {
-    IdentifierNode* node = new IdentifierNode;
-    node->name = name;
+IdentifierNode* Parser::createIdentifierNode(const StringRef& name) {
+    IdentifierNode* node = arena.create<IdentifierNode>();
+    node->name = arena.copyString(name);
 
     return node;
 }
 
-FuncCallNode* Parser::createFuncCallNode(const std::string& name, const std::vector<ASTNode*>& args) {
-    FuncCallNode* node = new FuncCallNode;
+FuncCallNode* Parser::createFuncCallNode(const StringRef& name, const std::vector<ASTNode*>& args) {
+    FuncCallNode* node = arena.create<FuncCallNode>();
     node->name = name;
-    node->args = args;
+    node->args = arena.copyArray(args);
     node->argsSize = args.size();
 
     return node;
 }
 
-DeclFuncNode* Parser::createDeclFuncNode(const std::string& name,
+DeclFuncNode* Parser::createDeclFuncNode(const StringRef& name,
                                          ValueType::Type returnType,
                                          const std::vector<IdentifierNode*>& args,
                                          BlockStmtNode* body) {
-    DeclFuncNode* node = new DeclFuncNode;
+    DeclFuncNode* node = arena.create<DeclFuncNode>();
     node->name = name;
     node->returnType = returnType;
-    node->args = args;
+    node->args = arena.copyArray(args);
     node->argsSize = args.size();
     node->body = body;
 
@@ -591,7 +626,7 @@ DeclFuncNode* Parser::createDeclFuncNode(const std::string& name,
 }
 
 DeclVarNode* Parser::createDeclVarNode(IdentifierNode* id, ASTNode* expr) {
-    DeclVarNode* node = new DeclVarNode;
+    DeclVarNode* node = arena.create<DeclVarNode>();
     node->id = id;
     node->expr = expr;
 
@@ -599,8 +634,8 @@ DeclVarNode* Parser::createDeclVarNode(IdentifierNode* id, ASTNode* expr) {
 }
 
 BlockStmtNode* Parser::createBlockStmtNode(const std::vector<ASTNode*>& statements) {
-    BlockStmtNode* node = new BlockStmtNode;
-    node->stmtList = statements;
+    BlockStmtNode* node = arena.create<BlockStmtNode>();
+    node->stmtList = arena.copyArray(statements);
 
     return node;
 }
@@ -608,17 +643,17 @@ BlockStmtNode* Parser::createBlockStmtNode(const std::vector<ASTNode*>& statemen
 IfStmtNode*
 Parser::createIfStmtNode(ASTNode* condition, BlockStmtNode* stmtList, std::vector<IfStmtNode*> elseIfStmts,
                          BlockStmtNode* elseStmtList) {
-    IfStmtNode* node = new IfStmtNode;
+    IfStmtNode* node = arena.create<IfStmtNode>();
     node->condition = condition;
     node->body = stmtList;
-    node->elseIfStmts = elseIfStmts;
+    node->elseIfStmts = arena.copyArray(elseIfStmts);
     node->elseBody = elseStmtList;
 
     return node;
 }
 
 ForLoopNode* Parser::createForLoopNode(ASTNode* init, ASTNode* cond, BinOpNode* inc, BlockStmtNode* stmtList) {
-    ForLoopNode* node = new ForLoopNode;
+    ForLoopNode* node = arena.create<ForLoopNode>();
     node->init = init;
     node->condition = cond;
     node->inc = inc;
@@ -628,112 +663,16 @@ ForLoopNode* Parser::createForLoopNode(ASTNode* init, ASTNode* cond, BinOpNode*
 }
 
 double Parser::getNumTokenValue(const Token& numToken) {
-    return std::stod(numToken.Value);
+    // token value is not null-terminated, short numbers fit into the small string buffer
+    return std::stod(std::string(numToken.Value));
 }
 
 bool Parser::getBoolTokenValue(const Token& boolToken) {
-    return static_cast<bool>(std::stoi(boolToken.Value));
-}
-
-std::pair<std::queue<Token>, std::queue<ASTNode*>> Parser::convertToReversePolish() {
-    // TODO: написать тесты на данный алгоритм
-    static std::unordered_map<std::string, int> opPrecedence = {
-            std::pair<std::string, int>("=", 1),
-            std::pair<std::string, int>("||", 2),
-            std::pair<std::string, int>("&&", 3),
-            std::pair<std::string, int>("==", 4),
-            std::pair<std::string, int>("<", 5),
-            std::pair<std::string, int>(">", 5),
-            std::pair<std::string, int>("+", 6),
-            std::pair<std::string, int>("-", 6),
-            std::pair<std::string, int>("*", 7),
-            std::pair<std::string, int>("/", 7),
-            std::pair<std::string, int>("u-", 8),
-    };
-
-    std::stack<Token> opStack;
-    std::queue<Token> expr;
-    std::queue<ASTNode*> funcCallNodes;
-
-    Token token;
-    while ((token = tokens.getNextToken()).Type != TokenType::NL && token.Type != TokenType::CURLY_BRACKET_START &&
-           token.Type != TokenType::CURLY_BRACKET_END && token.Type != TokenType::SEMICOLON &&
-           token.Type != TokenType::Comma && token.Type != TokenType::eof) {
-        if (token.Type == TokenType::Number || token.Type == TokenType::Bool || token.Type == TokenType::Id ||
-            token.Type == TokenType::FuncCall) {
-            expr.push(token);
-            if (token.Type == TokenType::FuncCall) {
-                tokens.returnToken();
-                funcCallNodes.push(parseFuncCall());
-            }
-        } else if (isOperator(token)) {
-            const Token& curOp = token;
-
-            while (!opStack.empty() && isOperator(opStack.top())) {
-                const Token& topOp = opStack.top();
-                if ((opPrecedence[curOp.Value] == opPrecedence[topOp.Value] && isOpLeftAssociative(topOp)) ||
-                    (opPrecedence[curOp.Value] < opPrecedence[topOp.Value])) {
-                    expr.push(opStack.top());
-                    opStack.pop();
-                    continue;
-                }
-                break;
-            }
-            opStack.push(token);
-        } else if (token.Type == TokenType::ROUND_BRACKET_START) {
-            opStack.push(token);
-        } else if (token.Type == TokenType::ROUND_BRACKET_END) {
-            Token topToken;
-            while (!opStack.empty() && ((topToken = opStack.top()).Type != TokenType::ROUND_BRACKET_START)) {
-                opStack.pop();
-                expr.push(topToken);
-            }
-
-            if (topToken.Type == TokenType::ROUND_BRACKET_START) {
-                opStack.pop(); // remove left bracket
-            } else {
-                if (parenthesesControl) {
-                    break;
-                } else {
-                    errorExpected("Left Round Bracket");
-                }
-            }
-        } else {
-            throw std::runtime_error("Unexpected token: " + token.Value);
-        }
-    }
-    tokens.returnToken();
-
-    while (!opStack.empty()) {
-        const Token& topToken = opStack.top();
-        opStack.pop();
-
-        if (topToken.Type == TokenType::ROUND_BRACKET_START) {
-            errorExpected("Right Round Bracket");
-        }
-        expr.push(topToken);
-    }
-
-    return std::make_pair(expr, funcCallNodes);
-}
-
-bool Parser::isOperator(const Token& token) {
-    return token.Type == TokenType::Add || token.Type == TokenType::Sub || token.Type == TokenType::Mul ||
-           token.Type == TokenType::Div || token.Type == TokenType::BoolOR || token.Type == TokenType::BoolAND ||
-           token.Type == TokenType::Equal || token.Type == TokenType::UnaryMinus || token.Type == TokenType::Assign ||
-           token.Type == TokenType::LESS || token.Type == TokenType::GREATER;
-}
-
-bool Parser::isBinaryOperator(const Token& token) {
-    return token.Type != TokenType::UnaryMinus;
-}
-
-bool Parser::isOpLeftAssociative(const Token& token) {
-    return token.Type != TokenType::Assign && token.Type != TokenType::UnaryMinus;
+    return boolToken.Value == "1";
 }
 
 void Parser::expect(const std::string& expected) {
-    const Token& currentToken = tokens.getNextToken();
+    const Token& currentToken = tokens->getNextToken();
 
     if (currentToken.Value != expected) {
         errorExpected(expected, currentToken);
@@ -765,7 +704,7 @@ void Parser::errorExpected(const std::string& expected) {
 }
 
 void Parser::skipWhitespaces() {
-    while (tokens.lookNextToken().Type == TokenType::NL) {
-        tokens.getNextToken();
+    while (tokens->lookNextToken().Type == TokenType::NL) {
+        tokens->getNextToken();
     }
 }
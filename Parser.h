@@ -6,13 +6,13 @@
 #include "TokenContainer.h"
 #include "ASTNode.h"
 #include "Lexer.h"
+#include "Arena.h"
+#include "IntArithmetic.h"
 #include <iostream>
 #include <utility>
 #include <string>
 #include <vector>
 #include <unordered_map>
-#include <queue>
-#include <stack>
 
 class Parser {
 private:
@@ -20,17 +20,20 @@ private:
 
     ConstNumberNode* createNumberNode(double value);
 
+    ConstNumberNode* createNumberNode(const Token& numToken);
+
     ConstBoolNode* createBoolNode(bool value);
 
-    IdentifierNode* createIdentifierNode(const std::string& name);
+    IdentifierNode* createIdentifierNode(const StringRef& name);
 
     ReturnStmtNode* createReturnStmtNode(ASTNode* expr);
 
     BreakStmtNode* createBreakStmtNode();
 
-    FuncCallNode* createFuncCallNode(const std::string& name, const std::vector<ASTNode*>& args);
+    // both keep name as is, parseFuncName has already copied it into the arena
+    FuncCallNode* createFuncCallNode(const StringRef& name, const std::vector<ASTNode*>& args);
 
-    DeclFuncNode* createDeclFuncNode(const std::string& name,
+    DeclFuncNode* createDeclFuncNode(const StringRef& name,
                                      ValueType::Type returnType, const std::vector<IdentifierNode*>& args,
                                      BlockStmtNode* body);
 
@@ -53,7 +56,8 @@ private:
 
     IdentifierNode* parseIdentifier();
 
-    std::string parseFuncName();
+    // returns the name copied into the arena
+    StringRef parseFuncName();
 
     ValueType::Type parseDeclFuncReturnType();
 
@@ -79,13 +83,13 @@ private:
 
     ForLoopNode* parseForLoop();
 
-    std::pair<std::queue<Token>, std::queue<ASTNode*>> convertToReversePolish();
+    ASTNode* parseSubExpression(int minPrecedence);
 
-    bool isOperator(const Token& token);
+    ASTNode* parseOperand();
 
-    bool isOpLeftAssociative(const Token& token);
+    bool isExpressionEnd(const Token& token);
 
-    bool isBinaryOperator(const Token& token);
+    bool isOperandMissing();
 
     void expect(const std::string& expected);
 
@@ -93,19 +97,26 @@ private:
 
     void errorExpected(const std::string& expected, const Token& foundTok);
 
-    TokenContainer tokens;
+    // not owned, parse() consumes the container passed to it
+    TokenContainer* tokens;
 
     ASTNode* parseStatement();
 
     bool parenthesesControl;
 
     void skipWhitespaces();
+
+    Arena arena;
 public:
     Parser() {
+        tokens = nullptr;
         parenthesesControl = false;
     }
 
-    ProgramTranslationNode* parse(const TokenContainer& sourceData);
+    ProgramTranslationNode* parse(TokenContainer& sourceData);
+
+    // owns every node parsed so far, release() frees all of them at once
+    Arena& getArena();
 };
 
 #endif //BASHCOMPILER_PARSER_H
\ No newline at end of file
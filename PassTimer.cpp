@@ -0,0 +1,100 @@
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include "PassTimer.h"
+
+namespace {
+    bool countAllocations = false;
+    unsigned long allocationsCount = 0;
+    unsigned long allocatedBytes = 0;
+
+    void* allocate(std::size_t size) {
+        if (countAllocations) {
+            allocationsCount++;
+            allocatedBytes += size;
+        }
+
+        void* ptr = std::malloc(size != 0 ? size : 1);
+        if (ptr == nullptr) {
+            throw std::bad_alloc();
+        }
+        return ptr;
+    }
+}
+
+// replaced for the whole program, so allocations of every library are counted as well
+void* operator new(std::size_t size) {
+    return allocate(size);
+}
+
+void* operator new[](std::size_t size) {
+    return allocate(size);
+}
+
+void operator delete(void* ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept {
+    std::free(ptr);
+}
+
+PassTimer::PassTimer(bool enabled) : enabled(enabled), passStartAllocationsCount(0), passStartAllocatedBytes(0) {
+    if (enabled) {
+        countAllocations = true;
+    }
+}
+
+PassTimer::~PassTimer() {
+    if (enabled) {
+        countAllocations = false;
+    }
+}
+
+void PassTimer::startPass(const std::string& name) {
+    if (!enabled) {
+        return;
+    }
+
+    currentPassName = name;
+    passStartAllocationsCount = allocationsCount;
+    passStartAllocatedBytes = allocatedBytes;
+    passStart = Clock::now();
+}
+
+void PassTimer::stopPass() {
+    if (!enabled) {
+        return;
+    }
+
+    double seconds = std::chrono::duration<double>(Clock::now() - passStart).count();
+    passes.emplace_back(Pass{currentPassName, seconds, allocationsCount - passStartAllocationsCount,
+                             allocatedBytes - passStartAllocatedBytes});
+}
+
+void PassTimer::report(std::ostream& stream) {
+    if (!enabled || passes.empty()) {
+        return;
+    }
+
+    Pass total{"total", 0, 0, 0};
+    char line[128];
+
+    std::snprintf(line, sizeof(line), "%-12s %12s %12s %14s\n", "pass", "time, ms", "allocations", "bytes");
+    stream << line;
+    for (const auto& currentPass : passes) {
+        std::snprintf(line, sizeof(line), "%-12s %12.3f %12lu %14lu\n", currentPass.name.c_str(),
+                      currentPass.seconds * 1000, currentPass.allocationsCount, currentPass.allocatedBytes);
+        stream << line;
+
+        total.seconds += currentPass.seconds;
+        total.allocationsCount += currentPass.allocationsCount;
+        total.allocatedBytes += currentPass.allocatedBytes;
+    }
+    std::snprintf(line, sizeof(line), "%-12s %12.3f %12lu %14lu\n", total.name.c_str(), total.seconds * 1000,
+                  total.allocationsCount, total.allocatedBytes);
+    stream << line;
+    stream.flush();
+
+    passes.clear();
+}
@@ -0,0 +1,50 @@
+#ifndef REPL_PASSTIMER_H
+#define REPL_PASSTIMER_H
+
+#include <chrono>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// measures wall time, allocations count and allocated bytes of every pipeline pass,
+// a disabled timer only checks a flag, allocations are counted only while some timer is enabled
+class PassTimer {
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    struct Pass {
+        std::string name;
+        double seconds;
+        unsigned long allocationsCount;
+        unsigned long allocatedBytes;
+    };
+
+    std::vector<Pass> passes;
+
+    bool enabled;
+
+    std::string currentPassName;
+
+    Clock::time_point passStart;
+
+    unsigned long passStartAllocationsCount;
+
+    unsigned long passStartAllocatedBytes;
+public:
+    explicit PassTimer(bool enabled);
+
+    ~PassTimer();
+
+    bool isEnabled() const {
+        return enabled;
+    }
+
+    void startPass(const std::string& name);
+
+    void stopPass();
+
+    // prints passes finished since the last report and forgets them
+    void report(std::ostream& stream);
+};
+
+#endif //REPL_PASSTIMER_H
@@ -0,0 +1,134 @@
+#include <algorithm>
+#include <cstdio>
+#include "Profiler.h"
+
+void Profiler::startProgram() {
+    // an error thrown by the previous program left its frames behind
+    for (const auto& currentFrame : frames) {
+        currentFrame.func->activeCount--;
+    }
+    frames.clear();
+    foldedStack.clear();
+
+    enterFunction("<toplevel>", 0);
+}
+
+void Profiler::stopProgram() {
+    while (!frames.empty()) {
+        exitFunction();
+    }
+}
+
+void Profiler::enterFunction(const std::string& name, unsigned int line) {
+    auto found = functions.find(name);
+    if (found == functions.end()) {
+        found = functions.emplace(name, ActiveFunction{FunctionStats{name, line, 0, 0, 0}, 0}).first;
+    }
+    ActiveFunction* func = &found->second;
+    func->stats.calls++;
+    func->activeCount++;
+
+    frames.emplace_back(Frame{func, Clock::time_point(), 0, foldedStack.size()});
+    if (frames.size() != 1) {
+        foldedStack.push_back(';');
+    }
+    foldedStack += name;
+
+    // the clock is read last, so the bookkeeping above is not charged to the function
+    frames.back().start = Clock::now();
+}
+
+void Profiler::exitFunction() {
+    Frame& frame = frames.back();
+    double seconds = std::chrono::duration<double>(Clock::now() - frame.start).count();
+
+    ActiveFunction* func = frame.func;
+    func->activeCount--;
+    if (func->activeCount == 0) {
+        func->stats.inclusiveSeconds += seconds;
+    }
+    double exclusiveSeconds = seconds - frame.calleesSeconds;
+    func->stats.exclusiveSeconds += exclusiveSeconds;
+    foldedStacksSeconds[foldedStack] += exclusiveSeconds;
+
+    foldedStack.resize(frame.foldedStackLength);
+    frames.pop_back();
+    if (!frames.empty()) {
+        frames.back().calleesSeconds += seconds;
+    }
+}
+
+void Profiler::countLoopIteration(unsigned int line) {
+    auto found = loops.find(line);
+    if (found == loops.end()) {
+        std::string function = frames.empty() ? "<toplevel>" : frames.back().func->stats.name;
+        found = loops.emplace(line, LoopStats{line, function, 0}).first;
+    }
+    found->second.iterations++;
+}
+
+std::vector<Profiler::FunctionStats> Profiler::getFunctionStats() const {
+    std::vector<FunctionStats> stats;
+    for (const auto& currentFunc : functions) {
+        stats.emplace_back(currentFunc.second.stats);
+    }
+
+    std::sort(stats.begin(), stats.end(), [](const FunctionStats& lhs, const FunctionStats& rhs) {
+        return lhs.exclusiveSeconds > rhs.exclusiveSeconds;
+    });
+    return stats;
+}
+
+std::vector<Profiler::LoopStats> Profiler::getLoopStats() const {
+    std::vector<LoopStats> stats;
+    for (const auto& currentLoop : loops) {
+        stats.emplace_back(currentLoop.second);
+    }
+
+    std::sort(stats.begin(), stats.end(), [](const LoopStats& lhs, const LoopStats& rhs) {
+        return lhs.iterations > rhs.iterations || (lhs.iterations == rhs.iterations && lhs.line < rhs.line);
+    });
+    return stats;
+}
+
+void Profiler::report(std::ostream& stream) const {
+    char line[256];
+
+    std::snprintf(line, sizeof(line), "%-24s %6s %12s %12s %12s\n", "function", "line", "calls", "incl, ms",
+                  "excl, ms");
+    stream << line;
+    for (const auto& currentFunc : getFunctionStats()) {
+        std::snprintf(line, sizeof(line), "%-24s %6u %12lu %12.3f %12.3f\n", currentFunc.name.c_str(),
+                      currentFunc.line, currentFunc.calls, currentFunc.inclusiveSeconds * 1000,
+                      currentFunc.exclusiveSeconds * 1000);
+        stream << line;
+    }
+
+    std::vector<LoopStats> loopStats = getLoopStats();
+    if (!loopStats.empty()) {
+        std::snprintf(line, sizeof(line), "\n%-24s %6s %12s\n", "loop in", "line", "iterations");
+        stream << line;
+        for (const auto& currentLoop : loopStats) {
+            std::snprintf(line, sizeof(line), "%-24s %6u %12lu\n", currentLoop.function.c_str(), currentLoop.line,
+                          currentLoop.iterations);
+            stream << line;
+        }
+    }
+    stream.flush();
+}
+
+void Profiler::writeFoldedStacks(std::ostream& stream) const {
+    for (const auto& currentStack : foldedStacksSeconds) {
+        unsigned long nanoseconds = static_cast<unsigned long>(currentStack.second * 1e9 + 0.5);
+        stream << currentStack.first << ' ' << nanoseconds << '\n';
+    }
+    stream.flush();
+}
+
+void Profiler::reset() {
+    stopProgram();
+    foldedStack.clear();
+    functions.clear();
+    loops.clear();
+    foldedStacksSeconds.clear();
+}
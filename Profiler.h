@@ -0,0 +1,84 @@
+#ifndef REPL_PROFILER_H
+#define REPL_PROFILER_H
+
+#include <chrono>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// counts calls and time of user functions and iterations of for loops,
+// engines report to it only while it is attached, so a detached profiler costs one null check
+class Profiler {
+public:
+    struct FunctionStats {
+        std::string name;
+        // line of the declaration, 0 for top-level code
+        unsigned int line;
+        unsigned long calls;
+        // recursive calls are included into the outermost one only
+        double inclusiveSeconds;
+        // without the time of called functions
+        double exclusiveSeconds;
+    };
+
+    struct LoopStats {
+        unsigned int line;
+        // function the loop was first seen in
+        std::string function;
+        // iterations that reached the increment, the one left by break is not counted
+        unsigned long iterations;
+    };
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    struct ActiveFunction {
+        FunctionStats stats;
+        unsigned long activeCount;
+    };
+
+    struct Frame {
+        ActiveFunction* func;
+        Clock::time_point start;
+        double calleesSeconds;
+        // length of foldedStack before the frame was entered
+        unsigned long foldedStackLength;
+    };
+
+    std::unordered_map<std::string, ActiveFunction> functions;
+
+    std::unordered_map<unsigned int, LoopStats> loops;
+
+    std::vector<Frame> frames;
+
+    // names of the frames joined with ';', the format of flame graph tools
+    std::string foldedStack;
+
+    std::unordered_map<std::string, double> foldedStacksSeconds;
+public:
+    // every Evaluate call of an engine runs as the top-level frame, frames left by an error are dropped
+    void startProgram();
+
+    void stopProgram();
+
+    void enterFunction(const std::string& name, unsigned int line);
+
+    void exitFunction();
+
+    void countLoopIteration(unsigned int line);
+
+    // sorted by exclusive time, the slowest first
+    std::vector<FunctionStats> getFunctionStats() const;
+
+    // sorted by iterations, the busiest first
+    std::vector<LoopStats> getLoopStats() const;
+
+    void report(std::ostream& stream) const;
+
+    // one "frame;frame;frame nanoseconds" line per distinct stack, input of flamegraph.pl
+    void writeFoldedStacks(std::ostream& stream) const;
+
+    void reset();
+};
+
+#endif //REPL_PROFILER_H
@@ -0,0 +1,60 @@
+#include "ResultSink.h"
+
+void StreamResultSink::put(const EvalResult& result) {
+    ValueType::Type resultType = result.getResultType();
+
+    if (resultType == ValueType::Number && result.isResultInt()) {
+        stream << result.getResultInt() << '\n';
+    } else if (resultType == ValueType::Number) {
+        stream << result.getResultDouble() << '\n';
+    } else if (resultType == ValueType::Bool) {
+        stream << (result.getResultBool() ? "true" : "false") << '\n';
+    } else if (resultType == ValueType::String) {
+        stream << result.getResultString() << '\n';
+    } else if (resultType == ValueType::Compound) {
+        for (const auto& currentResult : result.getResultBlock()) {
+            put(currentResult);
+        }
+    }
+
+    if (depth == 0) {
+        stream.flush();
+    }
+}
+
+void StreamResultSink::openBlock() {
+    depth++;
+}
+
+void StreamResultSink::closeBlock() {
+    depth--;
+    if (depth == 0) {
+        stream.flush();
+    }
+}
+
+void CollectResultSink::put(const EvalResult& result) {
+    blocks.back().emplace_back(result);
+}
+
+void CollectResultSink::openBlock() {
+    blocks.emplace_back();
+}
+
+void CollectResultSink::closeBlock() {
+    EvalResult result;
+    result.setBlockResult(std::move(blocks.back()));
+    blocks.pop_back();
+    blocks.back().emplace_back(std::move(result));
+}
+
+const std::vector<EvalResult>& CollectResultSink::getResults() const {
+    return blocks.front();
+}
+
+EvalResult CollectResultSink::getLastResult() const {
+    if (blocks.front().empty()) {
+        return EvalResult();
+    }
+    return blocks.front().back();
+}
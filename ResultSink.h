@@ -0,0 +1,64 @@
+#ifndef REPL_RESULTSINK_H
+#define REPL_RESULTSINK_H
+
+#include "EvalResult.h"
+#include <ostream>
+#include <vector>
+
+// receives results of statements as soon as they are evaluated,
+// every compound statement (block, for loop) is wrapped into openBlock/closeBlock
+class ResultSink {
+public:
+    virtual ~ResultSink() {};
+
+    virtual void put(const EvalResult& result) = 0;
+
+    virtual void openBlock() = 0;
+
+    virtual void closeBlock() = 0;
+};
+
+// prints values the same way REPL always did, without keeping them
+class StreamResultSink : public ResultSink {
+private:
+    std::ostream& stream;
+
+    unsigned long depth;
+public:
+    explicit StreamResultSink(std::ostream& stream) : stream(stream), depth(0) {};
+
+    void put(const EvalResult& result) override;
+
+    void openBlock() override;
+
+    void closeBlock() override;
+};
+
+class DiscardResultSink : public ResultSink {
+public:
+    void put(const EvalResult&) override {};
+
+    void openBlock() override {};
+
+    void closeBlock() override {};
+};
+
+// rebuilds nested compound results, memory grows with the number of results
+class CollectResultSink : public ResultSink {
+private:
+    std::vector<std::vector<EvalResult>> blocks;
+public:
+    CollectResultSink() : blocks(1) {};
+
+    void put(const EvalResult& result) override;
+
+    void openBlock() override;
+
+    void closeBlock() override;
+
+    const std::vector<EvalResult>& getResults() const;
+
+    EvalResult getLastResult() const;
+};
+
+#endif //REPL_RESULTSINK_H
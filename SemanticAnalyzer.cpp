@@ -23,6 +23,28 @@ SemanticAnalyzer::Scope* SemanticAnalyzer::lookTopIdScope(const std::string& idN
     return nullptr;
 }
 
+void SemanticAnalyzer::declareId(IdentifierNode* node) {
+    // globals get an index in the globals array, everything else a slot in the current frame
+    unsigned long slot;
+    if (topScope == globalScope) {
+        slot = globalsSize++;
+    } else {
+        slot = frameSize++;
+    }
+
+    topScope->symbolTable.setIdSlot(node->name, slot);
+    resolveId(node, topScope);
+}
+
+void SemanticAnalyzer::resolveId(IdentifierNode* node, Scope* idScope) {
+    // reading a global is impure too, the global may change between two calls with the same arguments
+    if (functionBodyCheck && idScope == globalScope) {
+        isCurrentFuncPure = false;
+    }
+    node->storage = idScope == globalScope ? IdStorage::Global : IdStorage::Local;
+    node->slot = idScope->symbolTable.getIdSlot(node->name);
+}
+
 SemanticAnalysisResult SemanticAnalyzer::newError(SemanticAnalysisResult::Error err) {
     return SemanticAnalysisResult(err);
 }
@@ -121,7 +143,10 @@ SemanticAnalysisResult SemanticAnalyzer::checkVarDecl(DeclVarNode* node) {
         }
     } else {
         topScope->symbolTable.addNewIdentifier(idName);
+        topScope->untypedDecls[idName] = node->id;
     }
+    node->id->valueType = topScope->symbolTable.getIdValueType(idName);
+    declareId(node->id);
 
     return SemanticAnalysisResult();
 }
@@ -136,12 +161,18 @@ SemanticAnalysisResult SemanticAnalyzer::checkFuncDecl(DeclFuncNode* node) {
 
     SemanticAnalysisResult checkResult;
 
+    // declare function before checking its body to allow recursive calls
+    functions->symbolTable.addNewFunc(node);
+
     // since function can see variables in its own scope and also in global scope,
     // so make outer scope is global scope,
     openScope();
     Scope* oldOuterScope = topScope->outer;
     topScope->outer = globalScope;
 
+    unsigned long oldFrameSize = frameSize;
+    frameSize = 0;
+
     for (const auto& currentId : node->args) {
         if (currentId->valueType == ValueType::Number) {
             double value = 0;
@@ -150,11 +181,14 @@ SemanticAnalysisResult SemanticAnalyzer::checkFuncDecl(DeclFuncNode* node) {
             bool value = 0;
             topScope->symbolTable.addNewIdentifier(currentId->name, value);
         }
+        declareId(currentId);
     }
 
     bool oldFunctionBodyCheck = functionBodyCheck;
     functionBodyCheck = true;
     functionReturnType = node->returnType;
+    currentFunc = node;
+    isCurrentFuncPure = true;
 
     for (ASTNode* currentStatement : node->body->stmtList) {
 //         TODO: сделать проверку, что не void функция всегда возвращает значение
@@ -172,11 +206,15 @@ SemanticAnalysisResult SemanticAnalyzer::checkFuncDecl(DeclFuncNode* node) {
     }
 
     functionBodyCheck = oldFunctionBodyCheck;
+    node->isPure = isCurrentFuncPure && !checkResult.isError();
+    currentFunc = nullptr;
+    node->frameSize = frameSize;
+    frameSize = oldFrameSize;
     topScope->outer = oldOuterScope;
     closeScope();
 
-    if (!checkResult.isError()) {
-        functions->symbolTable.addNewFunc(node);
+    if (checkResult.isError()) {
+        functions->symbolTable.removeFunc(node->name);
     }
 
     return checkResult;
@@ -252,10 +290,18 @@ SemanticAnalysisResult SemanticAnalyzer::checkFuncCall(FuncCallNode* node) {
                         "Use of undeclared function '" + funcName + "'");
     }
     if (isFuncReserved(funcName)) {
+        // print is the only reserved function and it has output
+        if (functionBodyCheck) {
+            isCurrentFuncPure = false;
+        }
         return checkReservedFuncCall(node);
     }
 
     DeclFuncNode* func = functions->symbolTable.getFunc(funcName);
+    // recursive calls keep the function pure, its own flag is not set yet
+    if (functionBodyCheck && func != currentFunc && !func->isPure) {
+        isCurrentFuncPure = false;
+    }
     if (func->argsSize != node->argsSize) {
         return newError(SemanticAnalysisResult::NO_MATCHING_FUNC);
     }
@@ -323,8 +369,11 @@ SemanticAnalysisResult SemanticAnalyzer::checkId(IdentifierNode* node) {
     if (idScope == nullptr) {
         return newError(SemanticAnalysisResult::UNDECLARED_VAR, "Use of undeclared variable '" + idName + "'");
     }
+    resolveId(node, idScope);
 
     ValueType::Type idValueType = idScope->symbolTable.getIdValueType(idName);
+    // variables never change their type, so engines can specialize every use of the identifier
+    node->valueType = idValueType;
     if (idValueType != ValueType::Number && idValueType != ValueType::Bool) {
         if (idValueType == ValueType::Undefined) {
             return newError(SemanticAnalysisResult::UNINITIALIZED_VAR,
@@ -349,6 +398,7 @@ SemanticAnalysisResult SemanticAnalyzer::checkAssignExpr(BinOpNode* node) {
     if (idScope == nullptr) {
         return newError(SemanticAnalysisResult::UNDECLARED_VAR, "Use of undeclared variable '" + idName + "'");
     }
+    resolveId(id, idScope);
 
     bool oldOperationCheck = operationCheck;
     operationCheck = true;
@@ -397,6 +447,12 @@ SemanticAnalysisResult SemanticAnalyzer::checkAssignExpr(BinOpNode* node) {
         } else {
             idScope->symbolTable.setIdValueBool(idName, false);
         }
+
+        auto decl = idScope->untypedDecls.find(idName);
+        if (decl != idScope->untypedDecls.end()) {
+            decl->second->valueType = idScope->symbolTable.getIdValueType(idName);
+            idScope->untypedDecls.erase(decl);
+        }
     } else {
         if (exprValueType != idValueType) {
             return newError(SemanticAnalysisResult::INVALID_VALUE_TYPE, "Invalid RHS expression value type");
@@ -843,6 +899,9 @@ SemanticAnalysisResult SemanticAnalyzer::checkStatement(ASTNode* node) {
 
 SemanticAnalysisResult SemanticAnalyzer::checkProgram(ProgramTranslationNode* root) {
     for (const auto& currentStatement : root->statements) {
+        // locals of a top-level statement live only while the statement is evaluated
+        frameSize = 0;
+
         const SemanticAnalysisResult& checkResult = checkStatement(currentStatement);
         if (checkResult.isError()) {
             return checkResult;
@@ -10,6 +10,8 @@ private:
     struct Scope {
         Scope* outer;
         SymbolTable symbolTable;
+        // declarations without a value, they get the type of the first value assigned
+        std::unordered_map<std::string, IdentifierNode*> untypedDecls;
 
         Scope(Scope* outerScope) {
             outer = outerScope;
@@ -52,6 +54,10 @@ private:
 
     Scope* lookTopIdScope(const std::string& idName);
 
+    void declareId(IdentifierNode* node);
+
+    void resolveId(IdentifierNode* node, Scope* idScope);
+
     Scope* globalScope;
 
     Scope* topScope;
@@ -71,13 +77,25 @@ private:
     bool isFuncReserved(const std::string& funcName);
 
     ValueType::Type functionReturnType;
+
+    // function whose body is being checked
+    DeclFuncNode* currentFunc;
+
+    bool isCurrentFuncPure;
+
+    unsigned long frameSize;
+
+    unsigned long globalsSize;
+
+    Arena builtins;
 public:
     SemanticAnalyzer(int checkMode) : globalScope(new Scope(nullptr)), topScope(globalScope), functions(globalScope),
-                                      forLoopCheck(false), functionBodyCheck(false) {
+                                      forLoopCheck(false), functionBodyCheck(false), currentFunc(nullptr), isCurrentFuncPure(false),
+                                      frameSize(0), globalsSize(0) {
         operationCheck = checkMode == 0;
 
-        DeclFuncNode* printFunc = new DeclFuncNode;
-        printFunc->name = "print";
+        DeclFuncNode* printFunc = builtins.create<DeclFuncNode>();
+        printFunc->name = builtins.copyString("print");
         printFunc->returnType = ValueType::Void;
         printFunc->argsSize = 1;
         printFunc->body = nullptr;
@@ -86,7 +104,6 @@ public:
     };
 
     ~SemanticAnalyzer() {
-        delete functions->symbolTable.getFunc("print");
         delete globalScope;
     }
 
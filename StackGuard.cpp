@@ -0,0 +1,107 @@
+#include "StackGuard.h"
+#include <stdexcept>
+
+#if defined(__unix__)
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <ucontext.h>
+#define REPL_STACK_SEGMENTS_SUPPORTED 1
+#else
+#define REPL_STACK_SEGMENTS_SUPPORTED 0
+#endif
+
+namespace {
+    // used when the limit can't be read or there is none, the usual default of Linux
+    const unsigned long defaultStackSize = 8 * 1024 * 1024;
+}
+
+StackGuard::~StackGuard() {
+    for (const auto& currentSegment : freeSegments) {
+#if REPL_STACK_SEGMENTS_SUPPORTED
+        munmap(currentSegment, segmentSize);
+#else
+        (void) currentSegment;
+#endif
+    }
+}
+
+void StackGuard::reset() {
+    unsigned long stackSize = defaultStackSize;
+#if REPL_STACK_SEGMENTS_SUPPORTED
+    rlimit stackLimit;
+    if (getrlimit(RLIMIT_STACK, &stackLimit) == 0 && stackLimit.rlim_cur != RLIM_INFINITY) {
+        stackSize = static_cast<unsigned long>(stackLimit.rlim_cur);
+    }
+#endif
+
+    // the caller has used some of the stack already, a quarter is kept for it and for what runs between two checks
+    char marker;
+    std::uintptr_t top = reinterpret_cast<std::uintptr_t>(&marker);
+    limit = top - (stackSize - stackSize / 4);
+}
+
+void StackGuard::runSegmentCall(unsigned int high, unsigned int low) {
+    SegmentCall* call = reinterpret_cast<SegmentCall*>(
+            static_cast<std::uintptr_t>((static_cast<unsigned long long>(high) << 32) | low));
+
+    // exceptions can't leave the segment, the caller rethrows them on its own stack
+    try {
+        call->function(call->arg);
+    } catch (...) {
+        call->exception = std::current_exception();
+    }
+}
+
+void StackGuard::runOnNewSegment(void (* function)(void*), void* arg) {
+#if REPL_STACK_SEGMENTS_SUPPORTED
+    if ((segmentsCount + 1) * segmentSize > maxSegmentsSize) {
+        throw std::runtime_error("Call stack exceeded " + std::to_string(maxSegmentsSize / 1024 / 1024) + " MB");
+    }
+
+    void* segment;
+    if (!freeSegments.empty()) {
+        segment = freeSegments.back();
+        freeSegments.pop_back();
+    } else {
+        // pages are backed only once the recursion reaches them
+        segment = mmap(nullptr, segmentSize, PROT_READ | PROT_WRITE,
+                       MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE | MAP_STACK, -1, 0);
+        if (segment == MAP_FAILED) {
+            throw std::runtime_error("Can't allocate the call stack");
+        }
+    }
+
+    SegmentCall call{function, arg, nullptr};
+    unsigned long long callAddress = reinterpret_cast<std::uintptr_t>(&call);
+
+    ucontext_t callerContext;
+    ucontext_t segmentContext;
+    getcontext(&segmentContext);
+    segmentContext.uc_stack.ss_sp = segment;
+    segmentContext.uc_stack.ss_size = segmentSize;
+    segmentContext.uc_link = &callerContext;
+    makecontext(&segmentContext, reinterpret_cast<void (*)()>(runSegmentCall), 2,
+                static_cast<unsigned int>(callAddress >> 32), static_cast<unsigned int>(callAddress));
+
+    std::uintptr_t oldLimit = limit;
+    limit = reinterpret_cast<std::uintptr_t>(segment) + segmentReserveSize;
+    segmentsCount++;
+    swapcontext(&callerContext, &segmentContext);
+    segmentsCount--;
+    limit = oldLimit;
+    // calls going back and forth over the end of a segment reuse one, the memory of the others is returned
+    if (freeSegments.empty()) {
+        freeSegments.emplace_back(segment);
+    } else {
+        munmap(segment, segmentSize);
+    }
+
+    if (call.exception != nullptr) {
+        std::rethrow_exception(call.exception);
+    }
+#else
+    (void) function;
+    (void) arg;
+    throw std::runtime_error("Call stack exhausted");
+#endif
+}
@@ -0,0 +1,58 @@
+#ifndef REPL_STACKGUARD_H
+#define REPL_STACKGUARD_H
+
+#include <cstdint>
+#include <exception>
+#include <vector>
+
+// tells when deep recursion is about to run out of native stack, measured from the stack pointer against the
+// stack size limit of the process, and lets it go on in stack segments allocated on demand,
+// stacks are assumed to grow down
+class StackGuard {
+private:
+    struct SegmentCall {
+        void (* function)(void*);
+        void* arg;
+        std::exception_ptr exception;
+    };
+
+    static void runSegmentCall(unsigned int high, unsigned int low);
+
+    // below this address the current stack is low
+    std::uintptr_t limit;
+
+    // a segment of the calls that returned, kept for the next ones
+    std::vector<void*> freeSegments;
+
+    unsigned long segmentsCount;
+public:
+    StackGuard() : limit(0), segmentsCount(0) {};
+
+    StackGuard(const StackGuard&) = delete;
+
+    StackGuard& operator=(const StackGuard&) = delete;
+
+    ~StackGuard();
+
+    // takes the stack pointer of the caller as the top of the native stack
+    void reset();
+
+    bool isLow() const {
+        char marker;
+        return reinterpret_cast<std::uintptr_t>(&marker) < limit;
+    }
+
+    // runs function(arg) on a new segment and returns when it returns, an exception it throws is rethrown here,
+    // throws std::runtime_error when the segments would take more than maxSegmentsSize
+    void runOnNewSegment(void (* function)(void*), void* arg);
+
+    static const unsigned long segmentSize = 16 * 1024 * 1024;
+
+    // kept at the end of every segment for what runs between two checks, such as native code
+    static const unsigned long segmentReserveSize = 1024 * 1024;
+
+    // bounds the memory infinite recursion takes
+    static const unsigned long maxSegmentsSize = 1024ul * 1024 * 1024;
+};
+
+#endif //REPL_STACKGUARD_H
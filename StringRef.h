@@ -0,0 +1,61 @@
+#ifndef REPL_STRINGREF_H
+#define REPL_STRINGREF_H
+
+#include <cstring>
+#include <string>
+
+// non-owning view of characters stored elsewhere (source buffer, Arena or string literal)
+struct StringRef {
+    const char* data;
+    unsigned long length;
+
+    StringRef() : data(""), length(0) {};
+
+    StringRef(const char* data, unsigned long length) : data(data), length(length) {};
+
+    StringRef(const char* str) : data(str), length(std::strlen(str)) {};
+
+    StringRef(const std::string& str) : data(str.data()), length(str.size()) {};
+
+    operator std::string() const {
+        return std::string(data, length);
+    }
+
+    bool operator==(const StringRef& str) const {
+        return str.length == length && std::memcmp(data, str.data, length) == 0;
+    }
+
+    bool operator==(const char* str) const {
+        return *this == StringRef(str);
+    }
+
+    bool operator==(const std::string& str) const {
+        return *this == StringRef(str);
+    }
+
+    bool operator!=(const StringRef& str) const {
+        return !(*this == str);
+    }
+
+    bool operator!=(const char* str) const {
+        return !(*this == str);
+    }
+
+    bool operator!=(const std::string& str) const {
+        return !(*this == str);
+    }
+};
+
+inline std::string operator+(const std::string& lhs, const StringRef& rhs) {
+    return lhs + std::string(rhs);
+}
+
+inline std::string operator+(const char* lhs, const StringRef& rhs) {
+    return lhs + std::string(rhs);
+}
+
+inline std::string operator+(const StringRef& lhs, const char* rhs) {
+    return std::string(lhs) + rhs;
+}
+
+#endif //REPL_STRINGREF_H
@@ -6,45 +6,53 @@ bool SymbolTable::isIdExist(const std::string& identifierName) const {
 }
 
 void SymbolTable::addNewIdentifier(const std::string& name) {
-    symbolTable.emplace(name, Identifier{});
+    symbolTable.emplace(name, Symbol());
 }
 
 void SymbolTable::addNewIdentifier(const std::string& name, bool value) {
-    Identifier id;
-    id.Type = ValueType::Bool;
-    id.boolValue = value;
+    Symbol symbol;
+    symbol.id.Type = ValueType::Bool;
+    symbol.id.boolValue = value;
 
-    symbolTable.emplace(name, id);
+    symbolTable.emplace(name, symbol);
 }
 
 void SymbolTable::addNewIdentifier(const std::string& name, double value) {
-    Identifier id;
-    id.Type = ValueType::Number;
-    id.numValue = value;
+    Symbol symbol;
+    symbol.id.Type = ValueType::Number;
+    symbol.id.numValue = value;
 
-    symbolTable.emplace(name, id);
+    symbolTable.emplace(name, symbol);
 }
 
 void SymbolTable::setIdValueDouble(const std::string& identifierName, double value) {
-    symbolTable[identifierName].Type = ValueType::Number;
-    symbolTable[identifierName].numValue = value;
+    symbolTable[identifierName].id.Type = ValueType::Number;
+    symbolTable[identifierName].id.numValue = value;
 }
 
 void SymbolTable::setIdValueBool(const std::string& identifierName, bool value) {
-    symbolTable[identifierName].Type = ValueType::Bool;
-    symbolTable[identifierName].boolValue = value;
+    symbolTable[identifierName].id.Type = ValueType::Bool;
+    symbolTable[identifierName].id.boolValue = value;
 }
 
 double SymbolTable::getIdValueDouble(const std::string& identifierName) const {
-    return symbolTable.at(identifierName).numValue;
+    return symbolTable.at(identifierName).id.numValue;
 }
 
 bool SymbolTable::getIdValueBool(const std::string& identifierName) const {
-    return symbolTable.at(identifierName).boolValue;
+    return symbolTable.at(identifierName).id.boolValue;
 }
 
 ValueType::Type SymbolTable::getIdValueType(const std::string& identifierName) const {
-    return symbolTable.at(identifierName).Type;
+    return symbolTable.at(identifierName).id.Type;
+}
+
+void SymbolTable::setIdSlot(const std::string& identifierName, unsigned long slot) {
+    symbolTable[identifierName].slot = slot;
+}
+
+unsigned long SymbolTable::getIdSlot(const std::string& identifierName) const {
+    return symbolTable.at(identifierName).slot;
 }
 
 bool SymbolTable::isFuncExist(const std::string& funcName) {
@@ -55,6 +63,10 @@ void SymbolTable::addNewFunc(DeclFuncNode* funcDecl) {
     funcSymbolTable.emplace(funcDecl->name, funcDecl);
 }
 
+void SymbolTable::removeFunc(const std::string& funcName) {
+    funcSymbolTable.erase(funcName);
+}
+
 DeclFuncNode* SymbolTable::getFunc(const std::string& funcName) const {
     return funcSymbolTable.at(funcName);
 }
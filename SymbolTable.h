@@ -7,7 +7,14 @@
 
 class SymbolTable {
 private:
-    std::unordered_map<std::string, Identifier> symbolTable;
+    struct Symbol {
+        Identifier id;
+        unsigned long slot;
+
+        Symbol() : slot(0) {};
+    };
+
+    std::unordered_map<std::string, Symbol> symbolTable;
 
     std::unordered_map<std::string, DeclFuncNode*> funcSymbolTable;
 public:
@@ -29,10 +36,16 @@ public:
 
     ValueType::Type getIdValueType(const std::string& identifierName) const;
 
+    void setIdSlot(const std::string& identifierName, unsigned long slot);
+
+    unsigned long getIdSlot(const std::string& identifierName) const;
+
     bool isFuncExist(const std::string& funcName);
 
     void addNewFunc(DeclFuncNode* funcDecl);
 
+    void removeFunc(const std::string& funcName);
+
     DeclFuncNode* getFunc(const std::string& funcName) const;
 
     ValueType::Type getFuncValueType(const std::string& funcName) const;
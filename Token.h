@@ -1,10 +1,10 @@
 #ifndef BASHCOMPILER_TOKEN_H
 #define BASHCOMPILER_TOKEN_H
 
-#include <string>
+#include "StringRef.h"
 
 namespace TokenType {
-    enum {
+    enum : unsigned char {
         eof,
         NL,
         SEMICOLON,
@@ -39,13 +39,21 @@ namespace TokenType {
         BoolAND,
         BoolOR,
         Equal,
-        Break
+        Break,
+        TypesCount
     };
 }
 
+// Value points into the source buffer passed to Lexer (or to a static literal), so the buffer must outlive tokens
 struct Token {
-    int Type;
-    std::string Value;
+    unsigned char Type;
+    // counted from the first tokenize call of the Lexer, so REPL inputs keep increasing it
+    unsigned int line;
+    StringRef Value;
+
+    Token() : Type(TokenType::eof), line(0) {};
+
+    Token(unsigned char type, const StringRef& value, unsigned int line = 0) : Type(type), line(line), Value(value) {};
 };
 
 #endif //BASHCOMPILER_TOKEN_H
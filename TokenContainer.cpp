@@ -1,13 +1,49 @@
+#include <stdexcept>
 #include "TokenContainer.h"
+#include "Lexer.h"
+
+TokenContainer::TokenContainer(Lexer& lexer, ChunkReader& reader, unsigned long windowSize) :
+        tokens(windowSize < 2 ? 2 : windowSize), lexemes(4 * 1024), lexer(&lexer), reader(&reader), lexedCount(0),
+        windowValues(tokens.size()) {}
 
 const std::vector<Token>& TokenContainer::getTokens() const {
     return tokens;
 }
 
-Token TokenContainer::getNextToken() {
-    auto token = tokens[currentTokenNum];
-    currentTokenNum++;
-    return token;
+const Token& TokenContainer::getWindowToken(unsigned long tokenNum) {
+    while (lexedCount <= tokenNum) {
+        lexNextToken();
+    }
+    if (lexedCount - tokenNum > tokens.size()) {
+        throw std::runtime_error("Token " + std::to_string(tokenNum) + " left the token window");
+    }
+
+    return tokens[tokenNum % tokens.size()];
+}
+
+void TokenContainer::lexNextToken() {
+    unsigned long slot = lexedCount % tokens.size();
+    const Token& lastToken = tokens[(lexedCount + tokens.size() - 1) % tokens.size()];
+
+    // the parser may look past the end, it keeps getting eof
+    if (lexedCount != 0 && lastToken.Type == TokenType::eof) {
+        tokens[slot] = lastToken;
+        lexedCount++;
+        return;
+    }
+
+    unsigned char lastType = TokenType::eof;
+    if (lexedCount != 0) {
+        lastType = lastToken.Type;
+    }
+
+    Token& token = tokens[slot];
+    lexer->readToken(*reader, lastType, token);
+    if (reader->isInBuffer(token.Value.data)) {
+        windowValues[slot].assign(token.Value.data, token.Value.length);
+        token.Value = windowValues[slot];
+    }
+    lexedCount++;
 }
 
 void TokenContainer::returnToken() {
@@ -17,7 +53,3 @@ void TokenContainer::returnToken() {
 void TokenContainer::addNewToken(const Token& token) {
     tokens.emplace_back(token);
 }
-
-Token TokenContainer::lookNextToken() {
-    return tokens[currentTokenNum];
-}
@@ -1,27 +1,80 @@
 #ifndef REPL_TOKENCONTAINER_H
 #define REPL_TOKENCONTAINER_H
 
+#include <string>
 #include <vector>
 #include "Token.h"
+#include "Arena.h"
 
+class Lexer;
+
+class ChunkReader;
+
+// holds every token of the input, or, when built over a ChunkReader, lexes tokens as they are reached
+// and keeps only the last windowSize of them
 class TokenContainer {
 private:
+    // all tokens, or the window indexed by token number modulo its size
     std::vector<Token> tokens;
 
     unsigned long currentTokenNum = 0;
+
+    // values of tokens read from a ChunkReader
+    Arena lexemes;
+
+    Lexer* lexer;
+
+    ChunkReader* reader;
+
+    // tokens lexed so far in the lazy mode
+    unsigned long lexedCount;
+
+    // values of the window tokens that were slices of the reader buffer
+    std::vector<std::string> windowValues;
+
+    const Token& getWindowToken(unsigned long tokenNum);
+
+    void lexNextToken();
 public:
+    static const unsigned long defaultWindowSize = 64;
+
+    TokenContainer() : lexemes(4 * 1024), lexer(nullptr), reader(nullptr), lexedCount(0) {};
+
+    // tokens can be returned while they are in the window, the lexer and reader must outlive the container
+    TokenContainer(Lexer& lexer, ChunkReader& reader, unsigned long windowSize = defaultWindowSize);
+
+    StringRef copyLexeme(const StringRef& lexeme) {
+        return lexemes.copyString(lexeme);
+    }
+
+    // only for containers that hold every token
     const std::vector<Token>& getTokens() const;
 
-    Token getNextToken();
+    const Token& getNextToken() {
+        if (reader != nullptr) {
+            return getWindowToken(currentTokenNum++);
+        }
+        return tokens[currentTokenNum++];
+    }
 
-    Token lookNextToken();
+    const Token& lookNextToken() {
+        if (reader != nullptr) {
+            return getWindowToken(currentTokenNum);
+        }
+        return tokens[currentTokenNum];
+    }
 
     void returnToken();
 
     void addNewToken(const Token& token);
 
+    void reserve(unsigned long count) {
+        tokens.reserve(count);
+    }
+
+    // tokens lexed so far
     unsigned long size() {
-        return tokens.size();
+        return reader != nullptr ? lexedCount : tokens.size();
     }
 };
 
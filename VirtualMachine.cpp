@@ -0,0 +1,305 @@
+#include "VirtualMachine.h"
+#include <memory>
+
+EvalResult VirtualMachine::Evaluate(ASTNode* root) {
+    CollectResultSink sink;
+    Evaluate(root, sink);
+
+    return sink.getLastResult();
+}
+
+void VirtualMachine::Evaluate(ASTNode* root, ResultSink& sink) {
+    // released when run throws as well
+    std::unique_ptr<Chunk> chunk(compiler.compile(root));
+    globals.resize(compiler.getGlobalsSize());
+
+    if (profiler != nullptr) {
+        profiler->startProgram();
+    }
+    run(chunk.get(), sink);
+    if (profiler != nullptr) {
+        profiler->stopProgram();
+    }
+}
+
+void VirtualMachine::pushFrame(const Chunk* chunk, unsigned long base) {
+    frames.emplace_back(CallFrame{chunk, 0, base});
+    stack.resize(base + chunk->localsSize);
+}
+
+EvalResult VirtualMachine::toEvalResult(const Identifier& value) {
+    EvalResult result;
+
+    switch (value.Type) {
+        case ValueType::Number: {
+            if (value.isInt) {
+                result.setValueInt(value.intValue);
+            } else {
+                result.setValueDouble(value.numValue);
+            }
+            break;
+        }
+        case ValueType::Bool: {
+            result.setValueBool(value.boolValue);
+            break;
+        }
+        case ValueType::Void: {
+            result.setVoidResult();
+            break;
+        }
+        default: {
+        }
+    }
+
+    return result;
+}
+
+void VirtualMachine::run(const Chunk* chunk, ResultSink& sink) {
+    const std::vector<BytecodeFunction*>& functions = compiler.getFunctions();
+
+    stack.clear();
+    frames.clear();
+
+    pushFrame(chunk, 0);
+
+    const Instruction* code = chunk->code.data();
+    unsigned long ip = 0;
+    unsigned long base = 0;
+
+    while (true) {
+        const Instruction& instruction = code[ip++];
+        executedInstructions++;
+
+        switch (instruction.op) {
+            case OpCode::PushNumber: {
+                Identifier value;
+                value.Type = ValueType::Number;
+                value.numValue = chunk->numbers[instruction.operand];
+                stack.emplace_back(value);
+                break;
+            }
+            case OpCode::PushInt: {
+                Identifier value;
+                value.Type = ValueType::Number;
+                value.isInt = true;
+                value.intValue = chunk->ints[instruction.operand];
+                stack.emplace_back(value);
+                break;
+            }
+            case OpCode::PushBool: {
+                Identifier value;
+                value.Type = ValueType::Bool;
+                value.boolValue = instruction.operand != 0;
+                stack.emplace_back(value);
+                break;
+            }
+            case OpCode::PushUndefined: {
+                stack.emplace_back(Identifier());
+                break;
+            }
+            case OpCode::LoadLocal: {
+                Identifier value = stack[base + instruction.operand];
+                stack.emplace_back(value);
+                break;
+            }
+            case OpCode::StoreLocal: {
+                stack[base + instruction.operand] = stack.back();
+                stack.pop_back();
+                break;
+            }
+            case OpCode::LoadGlobal: {
+                stack.emplace_back(globals[instruction.operand]);
+                break;
+            }
+            case OpCode::StoreGlobal: {
+                globals[instruction.operand] = stack.back();
+                stack.pop_back();
+                break;
+            }
+            case OpCode::Pop: {
+                stack.pop_back();
+                break;
+            }
+            case OpCode::Add:
+            case OpCode::Sub:
+            case OpCode::Mul:
+            case OpCode::Div: {
+                Identifier rhs = stack.back();
+                stack.pop_back();
+                Identifier& lhs = stack.back();
+
+                if (lhs.isInt && rhs.isInt) {
+                    long long value;
+                    bool isExact;
+                    if (instruction.op == OpCode::Add) {
+                        isExact = IntArithmetic::add(lhs.intValue, rhs.intValue, value);
+                    } else if (instruction.op == OpCode::Sub) {
+                        isExact = IntArithmetic::sub(lhs.intValue, rhs.intValue, value);
+                    } else if (instruction.op == OpCode::Mul) {
+                        isExact = IntArithmetic::mul(lhs.intValue, rhs.intValue, value);
+                    } else {
+                        isExact = IntArithmetic::div(lhs.intValue, rhs.intValue, value);
+                    }
+
+                    if (isExact) {
+                        lhs.intValue = value;
+                        break;
+                    }
+                }
+
+                double lhsValue = lhs.getNumber();
+                double rhsValue = rhs.getNumber();
+                if (instruction.op == OpCode::Add) {
+                    lhs.numValue = lhsValue + rhsValue;
+                } else if (instruction.op == OpCode::Sub) {
+                    lhs.numValue = lhsValue - rhsValue;
+                } else if (instruction.op == OpCode::Mul) {
+                    lhs.numValue = lhsValue * rhsValue;
+                } else {
+                    lhs.numValue = lhsValue / rhsValue;
+                }
+                lhs.isInt = false;
+                lhs.Type = ValueType::Number;
+                break;
+            }
+            case OpCode::Equal: {
+                Identifier rhs = stack.back();
+                stack.pop_back();
+                Identifier& lhs = stack.back();
+
+                if (lhs.Type == ValueType::Number && lhs.isInt && rhs.isInt) {
+                    lhs.boolValue = lhs.intValue == rhs.intValue;
+                } else if (lhs.Type == ValueType::Number) {
+                    lhs.boolValue = lhs.getNumber() == rhs.getNumber();
+                } else {
+                    lhs.boolValue = lhs.boolValue == rhs.boolValue;
+                }
+                lhs.isInt = false;
+                lhs.Type = ValueType::Bool;
+                break;
+            }
+            case OpCode::Less:
+            case OpCode::Greater: {
+                Identifier rhs = stack.back();
+                stack.pop_back();
+                Identifier& lhs = stack.back();
+
+                if (lhs.isInt && rhs.isInt) {
+                    if (instruction.op == OpCode::Less) {
+                        lhs.boolValue = lhs.intValue < rhs.intValue;
+                    } else {
+                        lhs.boolValue = lhs.intValue > rhs.intValue;
+                    }
+                } else if (instruction.op == OpCode::Less) {
+                    lhs.boolValue = lhs.getNumber() < rhs.getNumber();
+                } else {
+                    lhs.boolValue = lhs.getNumber() > rhs.getNumber();
+                }
+                lhs.isInt = false;
+                lhs.Type = ValueType::Bool;
+                break;
+            }
+            case OpCode::Jump: {
+                unsigned long target = static_cast<unsigned long>(instruction.operand);
+                if (profiler != nullptr && target < ip) {
+                    // only for loops jump backwards
+                    for (const auto& currentLoop : chunk->loops) {
+                        if (currentLoop.start == target) {
+                            profiler->countLoopIteration(currentLoop.line);
+                        }
+                    }
+                }
+                ip = target;
+                break;
+            }
+            case OpCode::JumpIfFalse: {
+                bool condition = stack.back().boolValue;
+                stack.pop_back();
+                if (!condition) {
+                    ip = static_cast<unsigned long>(instruction.operand);
+                }
+                break;
+            }
+            case OpCode::JumpIfFalseOrPop:
+            case OpCode::JumpIfTrueOrPop: {
+                bool condition = stack.back().boolValue;
+                if (condition == (instruction.op == OpCode::JumpIfTrueOrPop)) {
+                    ip = static_cast<unsigned long>(instruction.operand);
+                } else {
+                    stack.pop_back();
+                }
+                break;
+            }
+            case OpCode::Call: {
+                const BytecodeFunction* func = functions[instruction.operand];
+                if (profiler != nullptr) {
+                    profiler->enterFunction(func->name, func->line);
+                }
+
+                frames.back().ip = ip;
+                pushFrame(&func->chunk, stack.size() - func->argsSize);
+
+                chunk = &func->chunk;
+                code = chunk->code.data();
+                ip = 0;
+                base = frames.back().base;
+                break;
+            }
+            case OpCode::Return:
+            case OpCode::ReturnVoid: {
+                Identifier returnValue;
+                if (instruction.op == OpCode::Return) {
+                    returnValue = stack.back();
+                } else {
+                    returnValue.Type = ValueType::Void;
+                }
+
+                stack.resize(base);
+                stack.emplace_back(returnValue);
+                frames.pop_back();
+                if (profiler != nullptr) {
+                    profiler->exitFunction();
+                }
+
+                const CallFrame& caller = frames.back();
+                chunk = caller.chunk;
+                code = chunk->code.data();
+                ip = caller.ip;
+                base = caller.base;
+                break;
+            }
+            case OpCode::ResultValue: {
+                sink.put(toEvalResult(stack.back()));
+                stack.pop_back();
+                break;
+            }
+            case OpCode::ResultStatus: {
+                EvalResult result;
+                result.setStatus(static_cast<ResultStatus::Type>(instruction.operand));
+                sink.put(result);
+                break;
+            }
+            case OpCode::ResultVoid: {
+                EvalResult result;
+                result.setVoidResult();
+                sink.put(result);
+                break;
+            }
+            case OpCode::ResultUndefined: {
+                sink.put(EvalResult());
+                break;
+            }
+            case OpCode::ResultOpenBlock: {
+                sink.openBlock();
+                break;
+            }
+            case OpCode::ResultCloseBlock: {
+                sink.closeBlock();
+                break;
+            }
+            case OpCode::Halt: {
+                return;
+            }
+        }
+    }
+}
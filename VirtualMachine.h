@@ -0,0 +1,58 @@
+#ifndef REPL_VIRTUALMACHINE_H
+#define REPL_VIRTUALMACHINE_H
+
+#include "ASTNode.h"
+#include "Identifier.h"
+#include "EvalResult.h"
+#include "Bytecode.h"
+#include "BytecodeCompiler.h"
+#include "ResultSink.h"
+#include "IntArithmetic.h"
+#include "Profiler.h"
+#include <vector>
+
+class VirtualMachine {
+private:
+    struct CallFrame {
+        const Chunk* chunk;
+        unsigned long ip;
+        unsigned long base;
+    };
+
+    void run(const Chunk* chunk, ResultSink& sink);
+
+    void pushFrame(const Chunk* chunk, unsigned long base);
+
+    EvalResult toEvalResult(const Identifier& value);
+
+    BytecodeCompiler compiler;
+
+    std::vector<Identifier> stack;
+
+    std::vector<Identifier> globals;
+
+    std::vector<CallFrame> frames;
+
+    unsigned long long executedInstructions;
+
+    Profiler* profiler;
+public:
+    VirtualMachine() : executedInstructions(0), profiler(nullptr) {};
+
+    // returns the result of the statement, nested results are kept in compound results
+    EvalResult Evaluate(ASTNode* root);
+
+    void Evaluate(ASTNode* root, ResultSink& sink);
+
+    // total over every Evaluate call, a machine independent measure of evaluation work
+    unsigned long long getExecutedInstructions() const {
+        return executedInstructions;
+    }
+
+    // not owned, nullptr detaches the profiler
+    void setProfiler(Profiler* newProfiler) {
+        profiler = newProfiler;
+    }
+};
+
+#endif //REPL_VIRTUALMACHINE_H
@@ -0,0 +1,27 @@
+#include <iostream>
+#include <stdexcept>
+#include "ProgramGenerator.h"
+
+// prints a synthetic program, the output can be fed to REPL, Compiler or PipelineBenchmark --input
+int main(int argc, char* argv[]) {
+    try {
+        ProgramShape shape;
+
+        for (int currentArg = 1; currentArg < argc; currentArg += 2) {
+            std::string option = argv[currentArg];
+            const char* value = currentArg + 1 < argc ? argv[currentArg + 1] : nullptr;
+
+            if (!ProgramGenerator::parseShapeOption(shape, option, value)) {
+                throw std::runtime_error("Unknown option " + option + "\n"
+                        "usage: GenerateProgram [shape options]\n" + ProgramGenerator::getShapeOptionsUsage());
+            }
+        }
+
+        std::cout << ProgramGenerator(shape).generate();
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
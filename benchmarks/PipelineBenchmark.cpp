@@ -0,0 +1,326 @@
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+#include <sys/resource.h>
+#include "../Lexer.h"
+#include "../Parser.h"
+#include "../SemanticAnalyzer.h"
+#include "../ASTOptimizer.h"
+#include "../Evaluator.h"
+#include "../VirtualMachine.h"
+#include "../ClosureEngine.h"
+#include "../ResultSink.h"
+#include "../BashGenerator.h"
+#include "ProgramGenerator.h"
+
+namespace {
+    struct StageTiming {
+        std::string name;
+        std::string unit;
+        unsigned long long items;
+        double bestSeconds;
+        // peak resident size of the process once the stage finished the first time
+        long peakKb;
+    };
+
+    struct BenchmarkOptions {
+        ProgramShape shape;
+        unsigned long repeat;
+        bool json;
+        std::string inputFile;
+
+        BenchmarkOptions() : repeat(5), json(false) {};
+    };
+
+    typedef std::chrono::steady_clock Clock;
+
+    double secondsSince(const Clock::time_point& start) {
+        return std::chrono::duration<double>(Clock::now() - start).count();
+    }
+
+    long getPeakResidentKb() {
+        rusage usage;
+        getrusage(RUSAGE_SELF, &usage);
+        return usage.ru_maxrss;
+    }
+
+    unsigned long countNodes(ASTNode* node) {
+        if (node == nullptr) {
+            return 0;
+        }
+
+        unsigned long count = 1;
+        switch (node->type) {
+            case NodeType::ProgramTranslation: {
+                for (const auto& currentStatement : static_cast<ProgramTranslationNode*>(node)->statements) {
+                    count += countNodes(currentStatement);
+                }
+                break;
+            }
+            case NodeType::BinOp: {
+                BinOpNode* binOp = static_cast<BinOpNode*>(node);
+                count += countNodes(binOp->left) + countNodes(binOp->right);
+                break;
+            }
+            case NodeType::DeclVar: {
+                DeclVarNode* declVar = static_cast<DeclVarNode*>(node);
+                count += countNodes(declVar->id) + countNodes(declVar->expr);
+                break;
+            }
+            case NodeType::DeclFunc: {
+                DeclFuncNode* declFunc = static_cast<DeclFuncNode*>(node);
+                for (const auto& currentArg : declFunc->args) {
+                    count += countNodes(currentArg);
+                }
+                count += countNodes(declFunc->body);
+                break;
+            }
+            case NodeType::FuncCall: {
+                for (const auto& currentArg : static_cast<FuncCallNode*>(node)->args) {
+                    count += countNodes(currentArg);
+                }
+                break;
+            }
+            case NodeType::CompoundStmt: {
+                for (const auto& currentStatement : static_cast<BlockStmtNode*>(node)->stmtList) {
+                    count += countNodes(currentStatement);
+                }
+                break;
+            }
+            case NodeType::IfStmt: {
+                IfStmtNode* ifStmt = static_cast<IfStmtNode*>(node);
+                count += countNodes(ifStmt->condition) + countNodes(ifStmt->body);
+                for (const auto& currentElseIf : ifStmt->elseIfStmts) {
+                    count += countNodes(currentElseIf);
+                }
+                count += countNodes(ifStmt->elseBody);
+                break;
+            }
+            case NodeType::ForLoop: {
+                ForLoopNode* forLoop = static_cast<ForLoopNode*>(node);
+                count += countNodes(forLoop->init) + countNodes(forLoop->condition) + countNodes(forLoop->inc) +
+                         countNodes(forLoop->body);
+                break;
+            }
+            case NodeType::ReturnStmt: {
+                count += countNodes(static_cast<ReturnStmtNode*>(node)->expression);
+                break;
+            }
+            default: {
+            }
+        }
+
+        return count;
+    }
+
+    void record(StageTiming& stage, double seconds, unsigned long long items) {
+        if (seconds < stage.bestSeconds) {
+            stage.bestSeconds = seconds;
+        }
+        if (stage.peakKb == 0) {
+            stage.peakKb = getPeakResidentKb();
+        }
+        stage.items = items;
+    }
+
+    double throughput(const StageTiming& stage) {
+        return stage.bestSeconds > 0 ? stage.items / stage.bestSeconds : 0;
+    }
+
+    std::string readProgram(const std::string& fileName) {
+        std::ifstream ifs(fileName);
+        if (!ifs) {
+            throw std::runtime_error("Can't open " + fileName);
+        }
+        std::stringstream ss;
+        ss << ifs.rdbuf();
+        return ss.str();
+    }
+
+    BenchmarkOptions parseOptions(int argc, char* argv[]) {
+        BenchmarkOptions options;
+
+        for (int currentArg = 1; currentArg < argc; currentArg++) {
+            std::string option = argv[currentArg];
+            const char* value = currentArg + 1 < argc ? argv[currentArg + 1] : nullptr;
+
+            if (option == "--json") {
+                options.json = true;
+                continue;
+            } else if (option == "--input") {
+                if (value == nullptr) {
+                    throw std::runtime_error("Value required for " + option);
+                }
+                options.inputFile = value;
+            } else if (option == "--repeat") {
+                if (value == nullptr) {
+                    throw std::runtime_error("Value required for " + option);
+                }
+                options.repeat = std::strtoul(value, nullptr, 10);
+            } else if (!ProgramGenerator::parseShapeOption(options.shape, option, value)) {
+                throw std::runtime_error("Unknown option " + option + "\n"
+                        "usage: PipelineBenchmark [--repeat N] [--input FILE] [--json] [shape options]\n" +
+                        ProgramGenerator::getShapeOptionsUsage());
+            }
+            currentArg++;
+        }
+
+        if (options.repeat == 0) {
+            options.repeat = 1;
+        }
+
+        return options;
+    }
+
+    void printText(const BenchmarkOptions& options, unsigned long sourceSize, const std::vector<StageTiming>& stages) {
+        if (options.inputFile.empty()) {
+            const ProgramShape& shape = options.shape;
+            std::cout << "program: statements " << shape.statements << ", nesting " << shape.nestingDepth
+                      << ", call depth " << shape.callDepth << ", loop trips " << shape.loopTrips
+                      << ", functions " << shape.functions << ", call density " << shape.callDensity
+                      << ", expression depth " << shape.expressionDepth << ", variables " << shape.variables
+                      << ", seed " << shape.seed;
+        } else {
+            std::cout << "program: " << options.inputFile;
+        }
+        std::cout << ", " << sourceSize << " bytes, best of " << options.repeat << "\n";
+
+        for (const auto& currentStage : stages) {
+            std::printf("%-12s %12.3f ms %12llu %-12s %14.0f %-10s %10ld KB peak\n", currentStage.name.c_str(),
+                        currentStage.bestSeconds * 1000, currentStage.items, currentStage.unit.c_str(),
+                        throughput(currentStage), (currentStage.unit + "/s").c_str(), currentStage.peakKb);
+        }
+    }
+
+    void printJson(const BenchmarkOptions& options, unsigned long sourceSize, const std::vector<StageTiming>& stages) {
+        std::cout << "{\n";
+        if (options.inputFile.empty()) {
+            const ProgramShape& shape = options.shape;
+            std::cout << "  \"program\": {\"statements\": " << shape.statements
+                      << ", \"nesting\": " << shape.nestingDepth
+                      << ", \"call_depth\": " << shape.callDepth
+                      << ", \"loop_trips\": " << shape.loopTrips
+                      << ", \"functions\": " << shape.functions
+                      << ", \"call_density\": " << shape.callDensity
+                      << ", \"expr_depth\": " << shape.expressionDepth
+                      << ", \"variables\": " << shape.variables
+                      << ", \"seed\": " << shape.seed
+                      << ", \"bytes\": " << sourceSize << "},\n";
+        } else {
+            std::cout << "  \"program\": {\"input\": \"" << options.inputFile << "\", \"bytes\": " << sourceSize
+                      << "},\n";
+        }
+        std::cout << "  \"repeat\": " << options.repeat << ",\n";
+        std::cout << "  \"stages\": [\n";
+        for (unsigned long currentStageNum = 0; currentStageNum != stages.size(); currentStageNum++) {
+            const StageTiming& stage = stages[currentStageNum];
+            std::printf("    {\"name\": \"%s\", \"seconds\": %.9f, \"items\": %llu, \"unit\": \"%s\", "
+                        "\"per_second\": %.1f, \"peak_kb\": %ld}%s\n", stage.name.c_str(), stage.bestSeconds,
+                        stage.items, stage.unit.c_str(), throughput(stage), stage.peakKb,
+                        currentStageNum + 1 != stages.size() ? "," : "");
+        }
+        std::cout << "  ]\n}" << std::endl;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    try {
+        BenchmarkOptions options = parseOptions(argc, argv);
+
+        std::string source;
+        if (options.inputFile.empty()) {
+            source = ProgramGenerator(options.shape).generate();
+        } else {
+            source = readProgram(options.inputFile);
+        }
+        source.push_back('\n');
+        source.push_back(EOF);
+
+        StageTiming lexerStage{"lexer", "tokens", 0, 1e300, 0};
+        StageTiming parserStage{"parser", "nodes", 0, 1e300, 0};
+        StageTiming checkStage{"semantic", "nodes", 0, 1e300, 0};
+        StageTiming optimizerStage{"optimizer", "nodes", 0, 1e300, 0};
+        StageTiming evaluatorStage{"evaluator", "ops", 0, 1e300, 0};
+        StageTiming vmStage{"vm", "ops", 0, 1e300, 0};
+        StageTiming closureStage{"closure", "ops", 0, 1e300, 0};
+        StageTiming bashStage{"bash", "nodes", 0, 1e300, 0};
+
+        for (unsigned long currentRepeat = 0; currentRepeat != options.repeat; currentRepeat++) {
+            Lexer lexer;
+            Parser parser;
+            SemanticAnalyzer semanticAnalyzer(0);
+            ASTOptimizer optimizer(parser.getArena());
+            Evaluator evaluator;
+            VirtualMachine virtualMachine;
+            ClosureEngine closureEngine;
+            BashGenerator bashGenerator;
+            DiscardResultSink sink;
+
+            Clock::time_point start = Clock::now();
+            TokenContainer tokens = lexer.tokenize(source);
+            record(lexerStage, secondsSince(start), tokens.size());
+
+            start = Clock::now();
+            ProgramTranslationNode* root = parser.parse(tokens);
+            double parseSeconds = secondsSince(start);
+            unsigned long nodesCount = countNodes(root);
+            record(parserStage, parseSeconds, nodesCount);
+
+            start = Clock::now();
+            SemanticAnalysisResult checkResult = semanticAnalyzer.checkProgram(root);
+            record(checkStage, secondsSince(start), nodesCount);
+            if (checkResult.isError()) {
+                throw std::runtime_error(checkResult.what());
+            }
+
+            start = Clock::now();
+            optimizer.optimize(root);
+            record(optimizerStage, secondsSince(start), nodesCount);
+
+            // all engines do the same work, so the executed bytecode instructions measure it for each of them
+            start = Clock::now();
+            for (const auto& currentStatement : root->statements) {
+                virtualMachine.Evaluate(currentStatement, sink);
+            }
+            double vmSeconds = secondsSince(start);
+            record(vmStage, vmSeconds, virtualMachine.getExecutedInstructions());
+
+            start = Clock::now();
+            for (const auto& currentStatement : root->statements) {
+                closureEngine.Evaluate(currentStatement, sink);
+            }
+            record(closureStage, secondsSince(start), virtualMachine.getExecutedInstructions());
+
+            start = Clock::now();
+            for (const auto& currentStatement : root->statements) {
+                evaluator.Evaluate(currentStatement, sink);
+            }
+            record(evaluatorStage, secondsSince(start), virtualMachine.getExecutedInstructions());
+
+            start = Clock::now();
+            std::string bashCode = bashGenerator.generate(root);
+            record(bashStage, secondsSince(start), countNodes(root));
+
+            parser.getArena().release();
+        }
+
+        // in the order the stages run, so peak memory only grows down the list
+        std::vector<StageTiming> stages{lexerStage, parserStage, checkStage, optimizerStage, vmStage,
+                                        closureStage, evaluatorStage, bashStage};
+        if (options.json) {
+            printJson(options, source.size(), stages);
+        } else {
+            printText(options, source.size(), stages);
+        }
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
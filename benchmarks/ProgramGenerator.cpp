@@ -0,0 +1,219 @@
+#include <algorithm>
+#include <cstdlib>
+#include <stdexcept>
+#include "ProgramGenerator.h"
+
+namespace {
+    // calls from top-level statements may go this many functions deep,
+    // so every call does at most 1 + d + d^2 calls for call density d
+    const unsigned long callBudget = 2;
+
+    const unsigned long maxIndent = 8;
+
+    const char* const usage =
+            "  --statements N        top-level statements\n"
+            "  --nesting N           levels of for/if nesting\n"
+            "  --call-depth N        length of the function call chain\n"
+            "  --loop-trips N        iterations of every for loop\n"
+            "  --functions N         functions calling earlier functions\n"
+            "  --call-density N      calls from every function to earlier ones\n"
+            "  --expr-depth N        levels of nested parentheses in expressions\n"
+            "  --variables N         global variables\n"
+            "  --seed N              seed of the random choices\n";
+}
+
+std::string ProgramGenerator::generate() {
+    program.clear();
+    indent = 0;
+    random.seed(shape.seed);
+    if (shape.variables == 0) {
+        shape.variables = 1;
+    }
+
+    generateChainFunctions();
+    generateFunctions();
+    for (unsigned long currentVarNum = 0; currentVarNum != shape.variables; currentVarNum++) {
+        addLine("var " + var(currentVarNum) + " = " + std::to_string(currentVarNum % 100));
+    }
+
+    for (unsigned long currentStmtNum = 0; currentStmtNum != shape.statements; currentStmtNum++) {
+        generateStatement(currentStmtNum);
+    }
+
+    return program;
+}
+
+void ProgramGenerator::generateChainFunctions() {
+    if (shape.callDepth == 0) {
+        return;
+    }
+
+    // callee has to be declared before its caller
+    addLine("func int chain" + std::to_string(shape.callDepth - 1) + "(var int n) {");
+    addLine("    return n");
+    addLine("}");
+
+    for (unsigned long currentFuncNum = shape.callDepth - 1; currentFuncNum > 0; currentFuncNum--) {
+        addLine("func int chain" + std::to_string(currentFuncNum - 1) + "(var int n) {");
+        addLine("    return chain" + std::to_string(currentFuncNum) + "(n + 1) - 1");
+        addLine("}");
+    }
+}
+
+void ProgramGenerator::generateFunctions() {
+    const std::vector<std::string> operands{"n", "r"};
+
+    for (unsigned long currentFuncNum = 0; currentFuncNum != shape.functions; currentFuncNum++) {
+        addLine("func int f" + std::to_string(currentFuncNum) + "(var int n) {");
+        indent++;
+        addLine("var r = n");
+
+        // only earlier functions can be called, so the call graph has no cycles
+        if (currentFuncNum != 0 && shape.callDensity != 0) {
+            addLine("if (n > 0) {");
+            for (unsigned long currentCallNum = 0; currentCallNum != shape.callDensity; currentCallNum++) {
+                std::string callee = "f" + std::to_string(random() % currentFuncNum);
+                addLine("    r = r " + std::string(currentCallNum % 2 == 0 ? "+" : "-") + " " + callee + "(n - 1)");
+            }
+            addLine("}");
+        }
+
+        addLine("return r + " + generateExpression(shape.expressionDepth, operands));
+        indent--;
+        addLine("}");
+    }
+}
+
+void ProgramGenerator::generateStatement(unsigned long stmtNum) {
+    std::string a = var(random());
+    std::string b = var(random());
+    std::string c = var(random());
+
+    switch (stmtNum % 5) {
+        case 0: {
+            addLine(a + " = " + generateExpression(shape.expressionDepth, {b, c}));
+            break;
+        }
+        case 1: {
+            generateNestedStatement(stmtNum, 0);
+            break;
+        }
+        case 2: {
+            if (shape.callDepth != 0) {
+                addLine(a + " = chain0(" + b + ")");
+            } else {
+                addLine(a + " = " + b);
+            }
+            break;
+        }
+        case 3: {
+            if (shape.functions != 0) {
+                std::string callee = "f" + std::to_string(random() % shape.functions);
+                addLine(a + " = " + callee + "(" + std::to_string(callBudget) + ") - " + b);
+            } else {
+                addLine(a + " = " + b + " + 1");
+            }
+            break;
+        }
+        default: {
+            addLine("if (" + a + " > " + b + " && " + c + " < " + std::to_string(stmtNum) + ") {");
+            addLine("    " + a + " = " + b);
+            addLine("} else {");
+            addLine("    " + c + " = " + c + " + 1");
+            addLine("}");
+        }
+    }
+}
+
+void ProgramGenerator::generateNestedStatement(unsigned long stmtNum, unsigned long depth) {
+    std::string a = var(stmtNum + depth);
+
+    if (depth == shape.nestingDepth) {
+        addLine(a + " = " + a + " + 1");
+        return;
+    }
+
+    // for loops and if statements alternate, so loop trips multiply only on every other level
+    if (depth % 2 == 0) {
+        std::string i = "i" + std::to_string(depth);
+        addLine("for (var " + i + " = 0; " + i + " < " + std::to_string(shape.loopTrips) + "; " +
+                i + " = " + i + " + 1) {");
+    } else {
+        addLine("if (" + a + " > " + var(stmtNum + depth + 1) + " || " + a + " < 1000) {");
+    }
+
+    indent++;
+    generateNestedStatement(stmtNum, depth + 1);
+    indent--;
+
+    addLine("}");
+}
+
+std::string ProgramGenerator::generateExpression(unsigned long depth, const std::vector<std::string>& operands) {
+    // nested to the right, so the size grows linearly with depth
+    std::string expr;
+    for (unsigned long currentDepth = 0; currentDepth != depth; currentDepth++) {
+        if (random() % 2 == 0) {
+            expr += operands[random() % operands.size()];
+        } else {
+            expr += std::to_string(random() % 10);
+        }
+        expr += random() % 2 == 0 ? " + (" : " - (";
+    }
+
+    expr += operands[random() % operands.size()];
+    expr.append(depth, ')');
+
+    return expr;
+}
+
+std::string ProgramGenerator::var(unsigned long num) const {
+    return "v" + std::to_string(num % shape.variables);
+}
+
+void ProgramGenerator::addLine(const std::string& line) {
+    // deeper indentation would make the source grow with the square of the nesting depth
+    program.append(std::min(indent, maxIndent) * 4, ' ');
+    program += line;
+    program.push_back('\n');
+}
+
+bool ProgramGenerator::parseShapeOption(ProgramShape& shape, const std::string& option, const char* value) {
+    unsigned long* field;
+    if (option == "--statements") {
+        field = &shape.statements;
+    } else if (option == "--nesting") {
+        field = &shape.nestingDepth;
+    } else if (option == "--call-depth") {
+        field = &shape.callDepth;
+    } else if (option == "--loop-trips") {
+        field = &shape.loopTrips;
+    } else if (option == "--functions") {
+        field = &shape.functions;
+    } else if (option == "--call-density") {
+        field = &shape.callDensity;
+    } else if (option == "--expr-depth") {
+        field = &shape.expressionDepth;
+    } else if (option == "--variables") {
+        field = &shape.variables;
+    } else if (option == "--seed") {
+        field = &shape.seed;
+    } else {
+        return false;
+    }
+
+    if (value == nullptr) {
+        throw std::runtime_error("Value required for " + option);
+    }
+    char* end;
+    *field = std::strtoul(value, &end, 10);
+    if (*end != '\0' || *value == '\0') {
+        throw std::runtime_error("Invalid value for " + option + ": " + value);
+    }
+
+    return true;
+}
+
+const char* ProgramGenerator::getShapeOptionsUsage() {
+    return usage;
+}
@@ -0,0 +1,68 @@
+#ifndef REPL_PROGRAMGENERATOR_H
+#define REPL_PROGRAMGENERATOR_H
+
+#include <random>
+#include <string>
+#include <vector>
+
+// shape of a synthetic program, every statement kind is emitted in turn
+struct ProgramShape {
+    // top-level statements after the declarations
+    unsigned long statements;
+    // levels of for/if nesting in compound statements
+    unsigned long nestingDepth;
+    // length of the chain of functions calling each other
+    unsigned long callDepth;
+    // iterations of every generated for loop
+    unsigned long loopTrips;
+    // functions calling randomly chosen earlier functions
+    unsigned long functions;
+    // calls from every such function to earlier ones
+    unsigned long callDensity;
+    // levels of nested parentheses in arithmetic expressions
+    unsigned long expressionDepth;
+    // global variables used by the statements
+    unsigned long variables;
+    unsigned long seed;
+
+    ProgramShape() : statements(1000), nestingDepth(3), callDepth(4), loopTrips(4), functions(16), callDensity(2),
+                     expressionDepth(3), variables(8), seed(1) {};
+};
+
+// emits valid programs of the given shape, the same shape always gives the same program
+class ProgramGenerator {
+private:
+    void generateChainFunctions();
+
+    void generateFunctions();
+
+    void generateStatement(unsigned long stmtNum);
+
+    void generateNestedStatement(unsigned long stmtNum, unsigned long depth);
+
+    std::string generateExpression(unsigned long depth, const std::vector<std::string>& operands);
+
+    std::string var(unsigned long num) const;
+
+    void addLine(const std::string& line);
+
+    ProgramShape shape;
+
+    std::string program;
+
+    unsigned long indent;
+
+    // mt19937 gives the same sequence with every standard library
+    std::mt19937 random;
+public:
+    explicit ProgramGenerator(const ProgramShape& shape) : shape(shape), indent(0) {};
+
+    std::string generate();
+
+    // sets the shape field of a --option, returns false for options that are not about the shape
+    static bool parseShapeOption(ProgramShape& shape, const std::string& option, const char* value);
+
+    static const char* getShapeOptionsUsage();
+};
+
+#endif //REPL_PROGRAMGENERATOR_H
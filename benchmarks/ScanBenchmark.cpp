@@ -0,0 +1,123 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <stdexcept>
+#include <vector>
+#include "../CharScanner.h"
+#include "../Lexer.h"
+#include "ProgramGenerator.h"
+
+// compares the scalar and vector CharScanner kernels on their own and inside the Lexer,
+// on a generated program and on a text of long identifiers, numbers and space runs
+namespace {
+    typedef std::chrono::steady_clock Clock;
+
+    double secondsSince(const Clock::time_point& start) {
+        return std::chrono::duration<double>(Clock::now() - start).count();
+    }
+
+    std::string generateLongRuns(unsigned long size) {
+        std::string text;
+        unsigned long currentRun = 0;
+        while (text.size() < size) {
+            text += "long_identifier_" + std::to_string(currentRun) + "_with_many_word_chars";
+            text += std::string(8 + currentRun % 32, ' ');
+            text += "= 31415926535897932384626433.83279502884197169399";
+            text += currentRun % 4 == 0 ? "\n" : " + ";
+            currentRun++;
+        }
+        text.push_back('\n');
+        return text;
+    }
+
+    // walks src through the runs the scanner finds, returns the number of runs
+    unsigned long scanRuns(const CharScanner& scanner, const std::string& src) {
+        const char* currentChar = src.data();
+        const char* end = currentChar + src.size();
+        unsigned long runs = 0;
+
+        while (currentChar != end) {
+            char first = *currentChar;
+            if (first == ' ') {
+                currentChar = scanner.skipSpaces(currentChar + 1, end);
+            } else if ((first >= 'a' && first <= 'z') || (first >= 'A' && first <= 'Z') || first == '_') {
+                currentChar = scanner.skipWord(currentChar + 1, end);
+            } else if (first >= '0' && first <= '9') {
+                currentChar = scanner.skipNumber(currentChar + 1, end);
+            } else {
+                currentChar++;
+            }
+            runs++;
+        }
+
+        return runs;
+    }
+
+    void measure(const std::string& inputName, const std::string& src, unsigned long repeat) {
+        std::string lexerSrc = src;
+        lexerSrc.push_back(EOF);
+
+        for (ScanKind::Type currentKind : {ScanKind::Scalar, ScanKind::SSE2, ScanKind::AVX2}) {
+            if (!CharScanner::isSupported(currentKind)) {
+                std::printf("%-10s %-8s %12s\n", inputName.c_str(), CharScanner::getKindName(currentKind),
+                            "unsupported");
+                continue;
+            }
+
+            CharScanner scanner(currentKind);
+            double scanSeconds = 1e300;
+            double lexerSeconds = 1e300;
+            unsigned long runs = 0;
+            unsigned long tokensCount = 0;
+
+            for (unsigned long currentRepeat = 0; currentRepeat != repeat; currentRepeat++) {
+                Clock::time_point start = Clock::now();
+                runs = scanRuns(scanner, src);
+                scanSeconds = std::min(scanSeconds, secondsSince(start));
+
+                Lexer lexer(currentKind);
+                start = Clock::now();
+                tokensCount = lexer.tokenize(lexerSrc).size();
+                lexerSeconds = std::min(lexerSeconds, secondsSince(start));
+            }
+
+            std::printf("%-10s %-8s %10.1f MB/s %12lu runs %10.1f Mtokens/s %10lu tokens\n", inputName.c_str(),
+                        CharScanner::getKindName(currentKind), src.size() / scanSeconds / 1e6, runs,
+                        tokensCount / lexerSeconds / 1e6, tokensCount);
+        }
+    }
+}
+
+int main(int argc, char* argv[]) {
+    try {
+        ProgramShape shape;
+        shape.statements = 100000;
+        unsigned long repeat = 5;
+
+        for (int currentArg = 1; currentArg < argc; currentArg += 2) {
+            std::string option = argv[currentArg];
+            const char* value = currentArg + 1 < argc ? argv[currentArg + 1] : nullptr;
+
+            if (option == "--repeat" && value != nullptr) {
+                repeat = std::max(1ul, std::strtoul(value, nullptr, 10));
+            } else if (!ProgramGenerator::parseShapeOption(shape, option, value)) {
+                throw std::runtime_error("Unknown option " + option + "\n"
+                        "usage: ScanBenchmark [--repeat N] [shape options]\n" +
+                        ProgramGenerator::getShapeOptionsUsage());
+            }
+        }
+
+        std::string program = ProgramGenerator(shape).generate();
+        program.push_back('\n');
+
+        measure("program", program, repeat);
+        measure("long-runs", generateLongRuns(program.size()), repeat);
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,42 @@
+#!/usr/bin/env bash
+# compares generated bash scripts for recursive samples against the legacy
+# `$(f args | tail -n1)` calling convention
+#
+# usage: benchmarks/bash_calls.sh <path to Compiler> [runs]
+
+set -e
+
+compiler=$(realpath "${1:?usage: $0 <path to Compiler> [runs]}")
+runs=${2:-3}
+root=$(cd "$(dirname "$0")/.." && pwd)
+work=$(mktemp -d)
+trap 'rm -rf "$work"' EXIT
+
+measure() {
+    local start end
+    start=$(date +%s%N)
+    for ((run = 0; run < runs; run++)); do
+        bash "$1" > "$work/output"
+    done
+    end=$(date +%s%N)
+    echo $(((end - start) / runs / 1000000))
+}
+
+printf "%-12s %12s %12s %10s\n" "sample" "legacy, ms" "current, ms" "speedup"
+
+for legacy in "$root"/benchmarks/legacy/*.sh; do
+    sample=$(basename "$legacy" .sh)
+
+    sed '/^----$/,$d' "$root/docs/LanguageSamples/$sample" > "$work/$sample"
+    (cd "$work" && "$compiler" "$sample" && mv bash_program.sh "$sample.sh")
+
+    if [ "$(bash "$legacy")" != "$(bash "$work/$sample.sh")" ]; then
+        echo "$sample: outputs differ" >&2
+        exit 1
+    fi
+
+    legacyTime=$(measure "$legacy")
+    currentTime=$(measure "$work/$sample.sh")
+    printf "%-12s %12d %12d %9sx\n" "$sample" "$legacyTime" "$currentTime" \
+        "$(awk "BEGIN { printf \"%.1f\", $legacyTime / ($currentTime > 0 ? $currentTime : 1) }")"
+done
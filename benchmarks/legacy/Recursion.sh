@@ -0,0 +1,35 @@
+function fib {
+    local n=$1
+    if (($n < 2)); then {
+        echo $n; return
+    }
+    fi
+    echo $(($(fib $(($n - 1)) | tail -n1) + $(fib $(($n - 2)) | tail -n1))); return
+}
+function fact {
+    local n=$1
+    result_805aa383122b4fe8a5c315c56332a00d=1
+    if (($n > 1)); then {
+        result_805aa383122b4fe8a5c315c56332a00d=$(($n * $(fact $(($n - 1)) | tail -n1)))
+    }
+    fi
+    echo $result_805aa383122b4fe8a5c315c56332a00d; return
+}
+function countLeaves {
+    local depth=$1
+    total_22c79c4ded154ba5ac8017d461b1ec9c=0
+    for ((i_9bc44868e0d24bb8a0fa9db77f089037=0; $(($i_9bc44868e0d24bb8a0fa9db77f089037 < 3)); i_9bc44868e0d24bb8a0fa9db77f089037=$(($i_9bc44868e0d24bb8a0fa9db77f089037 + 1)))) {
+        if (($depth > 0)); then {
+            total_22c79c4ded154ba5ac8017d461b1ec9c=$(($total_22c79c4ded154ba5ac8017d461b1ec9c + $(countLeaves $(($depth - 1)) | tail -n1)))
+        }
+        else {
+            total_22c79c4ded154ba5ac8017d461b1ec9c=$(($total_22c79c4ded154ba5ac8017d461b1ec9c + 1))
+        }
+        fi
+    }
+
+    echo $total_22c79c4ded154ba5ac8017d461b1ec9c; return
+}
+echo $(fib 15 | tail -n1)
+echo $(fact 10 | tail -n1)
+echo $(countLeaves 3 | tail -n1)
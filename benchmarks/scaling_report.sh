@@ -0,0 +1,69 @@
+#!/usr/bin/env bash
+# grows one dimension of the synthetic program at a time and prints, for every stage, the time per unit
+# of the dimension and the peak memory it adds, a column that keeps growing down a table is superlinear
+#
+# usage: benchmarks/scaling_report.sh <build directory> [dimension=size,size,... ...]
+#        dimensions are the PipelineBenchmark shape options without dashes, e.g. statements=1000,10000
+
+set -e
+
+build=$(realpath "${1:?usage: $0 <build directory> [dimension=size,size,... ...]}")
+shift
+
+if [ $# -eq 0 ]; then
+    set -- statements=1000,10000,100000 \
+        nesting=10,100,300 \
+        functions=100,1000,10000 \
+        expr-depth=10,100,1000 \
+        variables=100,1000,10000
+fi
+
+# the other dimensions stay small, so the grown one dominates
+base_shape="--statements 1000 --loop-trips 1"
+
+stages="lexer parser semantic optimizer vm closure evaluator bash"
+
+# prints "<stage> <seconds> <peak_kb>" for every stage of PipelineBenchmark --json output
+stage_lines() {
+    awk -F'"' '/"name"/ {
+        seconds = $0; sub(/.*"seconds": /, "", seconds); sub(/,.*/, "", seconds)
+        peak = $0; sub(/.*"peak_kb": /, "", peak); sub(/}.*/, "", peak)
+        print $4, seconds, peak
+    }'
+}
+
+for dimension_sizes in "$@"; do
+    dimension=${dimension_sizes%%=*}
+    sizes=${dimension_sizes#*=}
+
+    echo "== $dimension: time per $dimension, us"
+    printf "%10s" "$dimension"
+    for stage in $stages; do
+        printf " %10s" "$stage"
+    done
+    printf " | %10s" "peak KB"
+    for stage in $stages; do
+        printf " %10s" "+$stage"
+    done
+    echo
+
+    for size in ${sizes//,/ }; do
+        # shellcheck disable=SC2086
+        report=$("$build/benchmarks/PipelineBenchmark" --json --repeat 3 $base_shape "--$dimension" "$size" |
+            stage_lines)
+
+        printf "%10s" "$size"
+        while read -r stage seconds peak; do
+            awk -v s="$seconds" -v n="$size" 'BEGIN { printf " %10.3f", s * 1e6 / n }'
+        done <<< "$report"
+
+        printf " | %10s" "$(tail -n1 <<< "$report" | cut -d' ' -f3)"
+        previous=0
+        while read -r stage seconds peak; do
+            printf " %10s" "$((peak - previous))"
+            previous=$peak
+        done <<< "$report"
+        echo
+    done
+    echo
+done
@@ -0,0 +1,56 @@
+#!/usr/bin/env bash
+# runs a loop guarded by `cheap || expensive` and the same loop with swapped operands,
+# the first one must not call expensive() at all
+#
+# usage: benchmarks/short_circuit.sh <build directory> [iterations]
+
+set -e
+
+build=$(realpath "${1:?usage: $0 <build directory> [iterations]}")
+iterations=${2:-2000}
+work=$(mktemp -d)
+trap 'rm -rf "$work"' EXIT
+
+program() {
+    cat <<PROGRAM
+var expensiveCalls = 0
+func bool expensive(var int n) {
+expensiveCalls = expensiveCalls + 1
+var sum = 0
+for (var i = 0; i < n; i = i + 1) {
+sum = sum + i
+}
+return sum > 0
+}
+func bool cheap() {
+return true
+}
+var hits = 0
+for (var i = 0; i < $iterations; i = i + 1) {
+if ($1) {
+hits = hits + 1
+}
+}
+expensiveCalls
+PROGRAM
+}
+
+measure() {
+    local start end output
+    start=$(date +%s%N)
+    output=$("$@" | tail -n1)
+    end=$(date +%s%N)
+    printf "%10d %10d" "$(((end - start) / 1000000))" "$output"
+}
+
+printf "%-28s %10s %10s %10s %10s\n" "guard" "REPL, ms" "calls" "bash, ms" "calls"
+
+for guard in "cheap() || expensive(100)" "expensive(100) || cheap()"; do
+    program "$guard" > "$work/program"
+    # bash output ends with the value of the last statement too
+    { sed '$d' "$work/program"; echo "print(expensiveCalls)"; } > "$work/program.src"
+    (cd "$work" && "$build/Compiler" program.src)
+
+    printf "%-28s %s %s\n" "$guard" "$(measure "$build/REPL" < "$work/program")" \
+        "$(measure bash "$work/bash_program.sh")"
+done
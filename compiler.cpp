@@ -1,47 +1,89 @@
 #include <iostream>
 #include <fstream>
-#include <sstream>
 #include "Lexer.h"
 #include "Parser.h"
 #include "SemanticAnalyzer.h"
+#include "ASTOptimizer.h"
 #include "BashGenerator.h"
-
-std::string readProgram(const std::string fileName) {
-    std::string input;
-    std::stringstream ss;
-    std::ifstream ifs(fileName);
-    ss << ifs.rdbuf();
-    input = ss.str();
-    ifs.close();
-    return input;
-}
+#include "CGenerator.h"
+#include "PassTimer.h"
 
 int main(int argc, char* argv[]) {
-    if (argc != 2) {
-        throw std::runtime_error("Source code file required");
+    bool timePasses = false;
+    std::string target = "bash";
+    int argNum = 1;
+    for (; argNum < argc - 1; argNum++) {
+        std::string arg = argv[argNum];
+        if (arg == "--time-passes") {
+            timePasses = true;
+        } else if (arg == "--target" && argNum + 1 < argc - 1) {
+            target = argv[++argNum];
+        } else {
+            break;
+        }
+    }
+    if (argNum != argc - 1 || (target != "bash" && target != "c")) {
+        throw std::runtime_error("Usage: Compiler [--time-passes] [--target bash|c] <source code file>");
     }
+    PassTimer passTimer(timePasses);
     Lexer lexer;
     Parser parser;
     SemanticAnalyzer semanticAnalyzer(1);
-    BashGenerator bashGenerator;
+    ASTOptimizer optimizer(parser.getArena());
+
+    std::ifstream sourceFile(argv[argc - 1], std::ios::binary);
+    if (!sourceFile) {
+        throw std::runtime_error(std::string("Can't open ") + argv[argc - 1]);
+    }
+
+    // the source is read chunk by chunk and lexed as the parser reaches it, timed runs lex it all before parsing,
+    // so the lexer keeps its own pass
+    ChunkReader reader(sourceFile);
+    ProgramTranslationNode* ast;
+    if (passTimer.isEnabled()) {
+        passTimer.startPass("lexer");
+        TokenContainer tokens = lexer.tokenize(reader);
+        passTimer.stopPass();
 
-    std::string source = readProgram(argv[1]);
-    source.push_back('\n');
-    source.push_back(EOF);
+        passTimer.startPass("parser");
+        ast = parser.parse(tokens);
+        passTimer.stopPass();
+    } else {
+        TokenContainer tokens(lexer, reader);
+        ast = parser.parse(tokens);
+    }
 
-    const TokenContainer& tokens = lexer.tokenize(source);
-    ProgramTranslationNode* ast = parser.parse(tokens);
+    passTimer.startPass("semantic");
     const SemanticAnalysisResult& checkResult = semanticAnalyzer.checkProgram(ast);
+    passTimer.stopPass();
     if (checkResult.isError()) {
         throw std::runtime_error(checkResult.what());
     }
-    std::string bashCode = bashGenerator.generate(ast);
 
-    delete ast;
+    passTimer.startPass("optimizer");
+    optimizer.optimize(ast);
+    passTimer.stopPass();
+
+    passTimer.startPass(target);
+    std::string code;
+    if (target == "c") {
+        CGenerator cGenerator;
+        code = cGenerator.generate(ast);
+    } else {
+        BashGenerator bashGenerator;
+        code = bashGenerator.generate(ast);
+    }
+    passTimer.stopPass();
 
-    std::ofstream outFile("bash_program.sh");
-    outFile << bashCode;
+    parser.getArena().release();
+
+    passTimer.startPass("write");
+    std::ofstream outFile(target == "c" ? "c_program.c" : "bash_program.sh");
+    outFile << code;
     outFile.close();
+    passTimer.stopPass();
+
+    passTimer.report(std::cerr);
 
     return 0;
 }
\ No newline at end of file
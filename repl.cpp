@@ -1,10 +1,17 @@
 #include <iostream>
+#include <fstream>
+#include <sstream>
 #include "Lexer.h"
 #include "Parser.h"
+#include "VirtualMachine.h"
+#include "ClosureEngine.h"
 #include "Evaluator.h"
-#include "EvalResult.h"
+#include "ResultSink.h"
 #include "SemanticAnalyzer.h"
 #include "SemanticAnalysisResult.h"
+#include "ASTOptimizer.h"
+#include "PassTimer.h"
+#include "Profiler.h"
 
 bool isInputForLoop(const std::string& input) {
     return input.find("for") != std::string::npos;
@@ -67,29 +74,48 @@ std::string readCompoundStatement(const std::string& input) {
     return stmt;
 }
 
-void printResult(const EvalResult& result, int tabCount = 0) {
-    ValueType::Type resultType = result.getResultType();
+// ":profile on|off|reset|report|dump <file>", returns false for inputs that are not profiler commands
+template<typename Engine>
+bool runProfilerCommand(const std::string& input, Profiler& profiler, Engine& engine) {
+    std::istringstream command(input);
+    std::string name;
+    std::string action;
+    std::string fileName;
+    command >> name >> action >> fileName;
+
+    if (name != ":profile") {
+        return false;
+    }
 
-    if (resultType == ValueType::Number) {
-        std::cout << result.getResultDouble() << std::endl;
-    } else if (resultType == ValueType::Bool) {
-        std::cout << (result.getResultBool() ? "true" : "false") << std::endl;
-    } else if (resultType == ValueType::Compound) {
-        for (const auto& currentResult : result.getResultBlock()) {
-            printResult(currentResult, tabCount);
-        }
-    } else if (resultType == ValueType::String) {
-        std::cout << result.getResultString() << std::endl;
+    if (action == "on") {
+        engine.setProfiler(&profiler);
+    } else if (action == "off") {
+        engine.setProfiler(nullptr);
+    } else if (action == "reset") {
+        profiler.reset();
+    } else if (action == "report") {
+        profiler.report(std::cout);
+    } else if (action == "dump" && !fileName.empty()) {
+        std::ofstream outFile(fileName);
+        profiler.writeFoldedStacks(outFile);
+    } else {
+        std::cerr << "Usage: :profile on|off|reset|report|dump <file>" << std::endl;
     }
+
+    return true;
 }
 
-int main() {
+template<typename Engine>
+int runRepl(bool timePasses) {
+    // reports go to stderr after every input, so they never mix with results
+    PassTimer passTimer(timePasses);
     Lexer lexer;
     Parser parser;
     SemanticAnalyzer semanticAnalyzer(0);
-    Evaluator evaluator;
-
-    std::vector<ProgramTranslationNode*> nodes;
+    ASTOptimizer optimizer(parser.getArena());
+    Engine engine;
+    StreamResultSink resultSink(std::cout);
+    Profiler profiler;
 
     while (true) {
         std::string input;
@@ -99,7 +125,11 @@ int main() {
             break;
         }
 
-        if (input.size() != 0) {
+        if (input.size() != 0 && input[0] == ':') {
+            if (!runProfilerCommand(input, profiler, engine)) {
+                std::cerr << "Unknown command " << input << std::endl;
+            }
+        } else if (input.size() != 0) {
             if (isInputIfStmt(input) || isInputForLoop(input) || isInputFuncDecl(input)) {
                 countOpenBrackets(input);
                 countEndBrackets(input);
@@ -108,23 +138,66 @@ int main() {
             input.push_back('\n');
             input.push_back(EOF);
 
-            const TokenContainer& tokens = lexer.tokenize(input);
+            passTimer.startPass("lexer");
+            TokenContainer tokens = lexer.tokenize(input);
+            passTimer.stopPass();
+
+            passTimer.startPass("parser");
             ProgramTranslationNode* root = parser.parse(tokens);
+            passTimer.stopPass();
+
+            passTimer.startPass("semantic");
             SemanticAnalysisResult checkResult = semanticAnalyzer.checkProgram(root);
+            passTimer.stopPass();
             if (checkResult.isError()) {
                 std::cerr << checkResult.what() << std::endl;
             } else {
-                EvalResult result = evaluator.Evaluate(root->statements[0]);
-                printResult(result);
+                passTimer.startPass("optimizer");
+                optimizer.optimize(root);
+                passTimer.stopPass();
+
+                passTimer.startPass("evaluate");
+                // the Evaluator throws on calls deeper than its limit and stays usable
+                try {
+                    engine.Evaluate(root->statements[0], resultSink);
+                } catch (const std::runtime_error& e) {
+                    std::cerr << e.what() << std::endl;
+                }
+                passTimer.stopPass();
             }
+            passTimer.report(std::cerr);
+        }
+    }
+
+    // functions declared earlier are referenced by later lines, so every program lives until exit
+    parser.getArena().release();
 
-            nodes.emplace_back(root);
+    return 0;
+}
+int main(int argc, char* argv[]) {
+    bool timePasses = false;
+    std::string engineName = "vm";
+    for (int currentArg = 1; currentArg < argc; currentArg++) {
+        std::string option = argv[currentArg];
+        if (option == "--time-passes") {
+            timePasses = true;
+        } else if (option == "--engine" && currentArg + 1 < argc) {
+            engineName = argv[++currentArg];
+        } else {
+            engineName.clear();
+            break;
         }
     }
 
-    for (const auto& currentNode : nodes) {
-        delete currentNode;
+    if (engineName == "vm") {
+        return runRepl<VirtualMachine>(timePasses);
+    } else if (engineName == "closure") {
+        return runRepl<ClosureEngine>(timePasses);
+    } else if (engineName == "eval") {
+        // the tree walker with native code for numeric functions, memoized pure calls and tail calls
+        return runRepl<Evaluator>(timePasses);
     }
 
-    return 0;
-}
\ No newline at end of file
+    std::cerr << "Usage: REPL [--time-passes] [--engine vm|closure|eval]" << std::endl;
+    return EXIT_FAILURE;
+}
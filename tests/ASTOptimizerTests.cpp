@@ -0,0 +1,163 @@
+#include "catch.hpp"
+#include "../Lexer.h"
+#include "../Parser.h"
+#include "../ASTNode.h"
+#include "../TokenContainer.h"
+#include "../SemanticAnalyzer.h"
+#include "../ASTOptimizer.h"
+#include "../Evaluator.h"
+
+class ExpressionHandler {
+private:
+    static Lexer lexer;
+
+    static Parser parser;
+
+    SemanticAnalyzer semanticAnalyzer{0};
+
+    ASTOptimizer optimizer{parser.getArena()};
+
+    Evaluator evaluator;
+public:
+    unsigned long removedNodesCount = 0;
+
+    ASTNode* handleExpression(const std::string src) {
+        std::string expr = src;
+        expr.push_back('\n');
+        expr.push_back(EOF);
+
+        TokenContainer tokens = lexer.tokenize(expr);
+
+        ProgramTranslationNode* root = parser.parse(tokens);
+        SemanticAnalysisResult checkResult = semanticAnalyzer.checkProgram(root);
+        if (checkResult.isError()) {
+            throw std::runtime_error(checkResult.what());
+        }
+        removedNodesCount = optimizer.optimize(root);
+
+        return root->statements[0];
+    }
+
+    EvalResult evaluateExpression(const std::string src) {
+        return evaluator.Evaluate(handleExpression(src));
+    }
+
+    ~ExpressionHandler() {
+        parser.getArena().release();
+    }
+};
+
+Lexer ExpressionHandler::lexer = Lexer();
+Parser ExpressionHandler::parser = Parser();
+
+TEST_CASE("Fold constant math expression", "[ASTOptimizer]") {
+    ExpressionHandler expressionHandler;
+
+    ASTNode* node = expressionHandler.handleExpression("200 + 2 * 3 - 4 / 2");
+
+    REQUIRE(node->type == NodeType::ConstNumber);
+    REQUIRE(static_cast<ConstNumberNode*>(node)->value == 204);
+    REQUIRE(expressionHandler.removedNodesCount == 8);
+}
+
+TEST_CASE("Fold unary minus of constant", "[ASTOptimizer]") {
+    ExpressionHandler expressionHandler;
+
+    ASTNode* node = expressionHandler.handleExpression("-5");
+
+    REQUIRE(node->type == NodeType::ConstNumber);
+    REQUIRE(static_cast<ConstNumberNode*>(node)->value == -5);
+    REQUIRE(expressionHandler.removedNodesCount == 2);
+}
+
+TEST_CASE("Fold constant subexpression next to variable", "[ASTOptimizer]") {
+    ExpressionHandler expressionHandler;
+
+    expressionHandler.handleExpression("var a = 1");
+    ASTNode* node = expressionHandler.handleExpression("2 * 3 + a");
+
+    REQUIRE(node->type == NodeType::BinOp);
+    BinOpNode* binOp = static_cast<BinOpNode*>(node);
+    REQUIRE(binOp->left->type == NodeType::ConstNumber);
+    REQUIRE(static_cast<ConstNumberNode*>(binOp->left)->value == 6);
+    REQUIRE(binOp->right->type == NodeType::Id);
+}
+
+TEST_CASE("Keep inexact division", "[ASTOptimizer]") {
+    ExpressionHandler expressionHandler;
+
+    ASTNode* node = expressionHandler.handleExpression("7 / 2");
+
+    REQUIRE(node->type == NodeType::BinOp);
+    REQUIRE(expressionHandler.removedNodesCount == 0);
+}
+
+TEST_CASE("Keep division by zero", "[ASTOptimizer]") {
+    ExpressionHandler expressionHandler;
+
+    ASTNode* node = expressionHandler.handleExpression("1 / 0");
+
+    REQUIRE(node->type == NodeType::BinOp);
+}
+
+TEST_CASE("Simplify math identities", "[ASTOptimizer]") {
+    ExpressionHandler expressionHandler;
+
+    expressionHandler.handleExpression("var a = 1");
+    ASTNode* node = expressionHandler.handleExpression("(a + 0) * 1 - 0 + 0 * 5");
+
+    REQUIRE(node->type == NodeType::Id);
+    REQUIRE(expressionHandler.removedNodesCount == 10);
+}
+
+TEST_CASE("Simplify bool identities", "[ASTOptimizer]") {
+    ExpressionHandler expressionHandler;
+
+    expressionHandler.handleExpression("var a = true");
+
+    REQUIRE(expressionHandler.handleExpression("true && a")->type == NodeType::Id);
+    REQUIRE(expressionHandler.handleExpression("false || a")->type == NodeType::Id);
+    REQUIRE(expressionHandler.handleExpression("a && true")->type == NodeType::Id);
+    REQUIRE(expressionHandler.handleExpression("a || false")->type == NodeType::Id);
+
+    ASTNode* node = expressionHandler.handleExpression("false && a");
+    REQUIRE(node->type == NodeType::ConstBool);
+    REQUIRE_FALSE(static_cast<ConstBoolNode*>(node)->value);
+}
+
+TEST_CASE("Keep bool operand with side effects", "[ASTOptimizer]") {
+    ExpressionHandler expressionHandler;
+
+    expressionHandler.handleExpression("func bool f() {"
+                                       "return true\n"
+                                       "}");
+    ASTNode* node = expressionHandler.handleExpression("f() && false");
+
+    REQUIRE(node->type == NodeType::BinOp);
+}
+
+TEST_CASE("Fold constant comparison", "[ASTOptimizer]") {
+    ExpressionHandler expressionHandler;
+
+    ASTNode* node = expressionHandler.handleExpression("2 * 3 > 5 && (true == false || 1 < 2)");
+
+    REQUIRE(node->type == NodeType::ConstBool);
+    REQUIRE(static_cast<ConstBoolNode*>(node)->value);
+}
+
+TEST_CASE("Fold expressions inside statements", "[ASTOptimizer]") {
+    ExpressionHandler expressionHandler;
+
+    expressionHandler.evaluateExpression("func int f(var int n) {"
+                                         "var sum = 0\n"
+                                         "for (var i = 0; i < n * 1; i = i + 2 - 1) {"
+                                         "if (i > 10 - 10) {"
+                                         "sum = sum + 2 * 5\n"
+                                         "}\n"
+                                         "}\n"
+                                         "return sum + 0\n"
+                                         "}");
+
+    REQUIRE(expressionHandler.removedNodesCount == 8);
+    REQUIRE(expressionHandler.evaluateExpression("f(5)").getResultDouble() == 40);
+}
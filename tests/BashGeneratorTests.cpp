@@ -32,10 +32,23 @@ std::string readOutput(const std::string fileName) {
     return input.substr(delimiterPos + delimiter.size(), input.size() - delimiterPos - delimiter.size());
 }
 
+bool isUuidAt(const std::string& word, unsigned long pos) {
+    // generated names get '_' and 32 hex digits appended
+    if (pos + 33 > word.size() || word[pos] != '_') {
+        return false;
+    }
+    for (unsigned long currentCharNum = pos + 1; currentCharNum < pos + 33; currentCharNum++) {
+        if (!isxdigit(word[currentCharNum])) {
+            return false;
+        }
+    }
+    return true;
+}
+
 std::string replaceUuid(const std::string& word, const std::string& properWord) {
     std::string result;
     for (unsigned long currentCharNum = 0; currentCharNum < word.size(); currentCharNum++) {
-        if (word[currentCharNum] != '_') {
+        if (!isUuidAt(word, currentCharNum) || !isUuidAt(properWord, currentCharNum)) {
             result += word[currentCharNum];
         } else {
             for (int i = 0; i < 33; i++) {
@@ -77,7 +90,7 @@ private:
 
     static Parser parser;
 
-    SemanticAnalyzer semanticAnalyzer = SemanticAnalyzer(1);
+    SemanticAnalyzer semanticAnalyzer{1};
 
     static BashGenerator bashGenerator;
 public:
@@ -86,7 +99,7 @@ public:
         input.push_back('\n');
         input.push_back(EOF);
 
-        const TokenContainer& tokens = lexer.tokenize(input);
+        TokenContainer tokens = lexer.tokenize(input);
         ProgramTranslationNode* root = parser.parse(tokens);
         SemanticAnalysisResult checkResult = semanticAnalyzer.checkProgram(root);
         if (checkResult.isError()) {
@@ -94,7 +107,7 @@ public:
         }
         const std::string& bashCode = bashGenerator.generate(root);
 
-        delete root;
+        parser.getArena().release();
 
         const std::string& properResult = readOutput(fileName);
         matchResult(bashCode, properResult);
@@ -128,4 +141,13 @@ TEST_CASE("For Loop Statements", "[Bash Generator]") {
 TEST_CASE("Complain Test", "[Bash Generator]") {
     ExpressionHandler expressionHandler;
     expressionHandler.handleExpression("./LanguageSamples/ComplainTest");
-}
\ No newline at end of file
+}
+TEST_CASE("Recursion", "[Bash Generator]") {
+    ExpressionHandler expressionHandler;
+    expressionHandler.handleExpression("./LanguageSamples/Recursion");
+}
+
+TEST_CASE("Short Circuit", "[Bash Generator]") {
+    ExpressionHandler expressionHandler;
+    expressionHandler.handleExpression("./LanguageSamples/ShortCircuit");
+}
@@ -0,0 +1,141 @@
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include "catch.hpp"
+#include "../Lexer.h"
+#include "../Parser.h"
+#include "../ASTNode.h"
+#include "../TokenContainer.h"
+#include "../SemanticAnalyzer.h"
+#include "../ASTOptimizer.h"
+#include "../CGenerator.h"
+
+namespace {
+    const std::string sourceFile = "/tmp/repl_cgenerator_test.c";
+    const std::string binaryFile = "/tmp/repl_cgenerator_test";
+    const std::string outputFile = "/tmp/repl_cgenerator_test.out";
+
+    std::string readFile(const std::string& fileName) {
+        std::ifstream ifs(fileName);
+        std::stringstream ss;
+        ss << ifs.rdbuf();
+        return ss.str();
+    }
+
+    std::string readSample(const std::string& fileName) {
+        const std::string delimiter = "\n----\n";
+        const std::string& input = readFile(fileName);
+        return input.substr(0, input.find(delimiter));
+    }
+
+    std::string generateProgram(const std::string& src) {
+        std::string input = src;
+        input.push_back('\n');
+        input.push_back(EOF);
+
+        Lexer lexer;
+        Parser parser;
+        TokenContainer tokens = lexer.tokenize(input);
+        ProgramTranslationNode* root = parser.parse(tokens);
+
+        SemanticAnalyzer semanticAnalyzer(1);
+        SemanticAnalysisResult checkResult = semanticAnalyzer.checkProgram(root);
+        if (checkResult.isError()) {
+            throw std::runtime_error(checkResult.what());
+        }
+        ASTOptimizer optimizer(parser.getArena());
+        optimizer.optimize(root);
+
+        CGenerator generator;
+        return generator.generate(root);
+    }
+
+    bool hasCompiler() {
+        return std::system("cc --version > /dev/null 2>&1") == 0;
+    }
+
+    // compiles the generated program with the system compiler and returns what it prints
+    std::string runProgram(const std::string& src) {
+        std::ofstream outFile(sourceFile);
+        outFile << generateProgram(src);
+        outFile.close();
+
+        std::string compile = "cc -std=c99 -o " + binaryFile + " " + sourceFile + " -lm";
+        REQUIRE(std::system(compile.c_str()) == 0);
+        REQUIRE(std::system((binaryFile + " > " + outputFile).c_str()) == 0);
+
+        return readFile(outputFile);
+    }
+}
+
+TEST_CASE("Samples compile to C", "[CGenerator]") {
+    if (!hasCompiler()) {
+        WARN("no C compiler, skipped");
+        return;
+    }
+
+    // ComplainTest runs forever
+    REQUIRE(runProgram(readSample("./LanguageSamples/Recursion")) == "610\n3628800\n81\n");
+    REQUIRE(runProgram(readSample("./LanguageSamples/FuncCalls")) == "11\n500\n");
+    REQUIRE(runProgram(readSample("./LanguageSamples/ShortCircuit")) == "5\n4\n9\n");
+    REQUIRE(runProgram(readSample("./LanguageSamples/DeclAssignVar")).empty());
+    REQUIRE(runProgram(readSample("./LanguageSamples/IfStatements")).empty());
+    REQUIRE(runProgram(readSample("./LanguageSamples/ForLoopStatements")).empty());
+}
+
+TEST_CASE("Numbers keep int64 and double semantics in C", "[CGenerator]") {
+    if (!hasCompiler()) {
+        WARN("no C compiler, skipped");
+        return;
+    }
+
+    REQUIRE(runProgram("func int half(var int n) {\n"
+                       "    return n / 2\n"
+                       "}\n"
+                       "var big = 3037000500 * 3037000500\n"
+                       "print(big)\n"
+                       "print(big - big)\n"
+                       "print(half(8))\n"
+                       "print(half(7))\n"
+                       "print(0 - 9223372036854775807 - 1)\n"
+                       "print(2.5 * 2 == 5)\n"
+                       "print(half(3) > 1 && true)\n") ==
+            "9.22337e+18\n0\n4\n3.5\n-9223372036854775808\ntrue\ntrue\n");
+}
+
+TEST_CASE("Scopes, control flow and call order in C", "[CGenerator]") {
+    if (!hasCompiler()) {
+        WARN("no C compiler, skipped");
+        return;
+    }
+
+    REQUIRE(runProgram("var x = 1\n"
+                       "func int bump() {\n"
+                       "    x = x * 10\n"
+                       "    return x\n"
+                       "}\n"
+                       "print(x + bump())\n"
+                       "print(bump() + x)\n"
+                       "var s = 5\n"
+                       "if (s > 10) {\n"
+                       "    print(1)\n"
+                       "} else if (s > 3) {\n"
+                       "    var s = s * 10\n"
+                       "    print(s)\n"
+                       "} else {\n"
+                       "    print(3)\n"
+                       "}\n"
+                       "print(s)\n"
+                       "var found\n"
+                       "for (var i = 0; ; i = i + 1) {\n"
+                       "    if (i == 3) {\n"
+                       "        found = i == 3\n"
+                       "        break\n"
+                       "    }\n"
+                       "}\n"
+                       "print(found)\n"
+                       "func void noValue() {\n"
+                       "    return\n"
+                       "}\n") ==
+            "11\n200\n50\n5\ntrue\n");
+}
@@ -8,7 +8,22 @@
 #include "../Evaluator.h"
 #include "../EvalResult.h"
 #include "../TokenContainer.h"
+#include "../ChunkReader.h"
 #include "../SemanticAnalyzer.h"
+#include "../VirtualMachine.h"
+#include "../ClosureEngine.h"
+#include "../ResultSink.h"
+#include "../Profiler.h"
+#include <sstream>
+
+// the same cases run against the tree-walking Evaluator, the bytecode VirtualMachine and the ClosureEngine
+#if defined(TEST_VIRTUAL_MACHINE)
+typedef VirtualMachine EvaluationEngine;
+#elif defined(TEST_CLOSURE_ENGINE)
+typedef ClosureEngine EvaluationEngine;
+#else
+typedef Evaluator EvaluationEngine;
+#endif
 
 class ExpressionHandler {
 private:
@@ -16,18 +31,16 @@ private:
 
     static Parser parser;
 
-    SemanticAnalyzer semanticAnalyzer = SemanticAnalyzer(0);
+    SemanticAnalyzer semanticAnalyzer{0};
 
-    Evaluator evaluator;
-
-    std::vector<ProgramTranslationNode*> nodes;
+    EvaluationEngine evaluator;
 public:
     EvalResult handleExpression(const std::string src) {
         std::string expr = src;
         expr.push_back('\n');
         expr.push_back(EOF);
 
-        const TokenContainer& tokens = lexer.tokenize(expr);
+        TokenContainer tokens = lexer.tokenize(expr);
 
         ProgramTranslationNode* root = parser.parse(tokens);
         SemanticAnalysisResult checkResult = semanticAnalyzer.checkProgram(root);
@@ -36,15 +49,30 @@ public:
         }
         const EvalResult& result = evaluator.Evaluate(root->statements[0]);
 
-        nodes.emplace_back(root);
-
         return result;
     }
 
-    ~ExpressionHandler() {
-        for (const auto& currentNode : nodes) {
-            delete currentNode;
+    void handleExpression(const std::string src, ResultSink& sink) {
+        std::string expr = src;
+        expr.push_back('\n');
+        expr.push_back(EOF);
+
+        TokenContainer tokens = lexer.tokenize(expr);
+
+        ProgramTranslationNode* root = parser.parse(tokens);
+        SemanticAnalysisResult checkResult = semanticAnalyzer.checkProgram(root);
+        if (checkResult.isError()) {
+            throw std::runtime_error(checkResult.what());
         }
+        evaluator.Evaluate(root->statements[0], sink);
+    }
+
+    void setProfiler(Profiler* profiler) {
+        evaluator.setProfiler(profiler);
+    }
+
+    ~ExpressionHandler() {
+        parser.getArena().release();
     }
 };
 
@@ -466,6 +494,64 @@ TEST_CASE("Bool expression evaluation with using of variables", "[Evaluator]") {
     REQUIRE(result.getResultBool() == properResult);
 }
 
+TEST_CASE("Bool expression evaluation: right operand of Logical AND is skipped", "[Evaluator]") {
+    ExpressionHandler expressionHandler;
+
+    std::string expr1 = "var calls = 0";
+    std::string expr2 = "func bool touch(var bool value) {"
+                        "calls = calls + 1\n"
+                        "return value\n"
+                        "}";
+    std::string expr3 = "false && touch(true)";
+    std::string expr4 = "touch(false) && touch(true)";
+    std::string expr5 = "calls";
+
+    expressionHandler.handleExpression(expr1);
+    expressionHandler.handleExpression(expr2);
+
+    REQUIRE_FALSE(expressionHandler.handleExpression(expr3).getResultBool());
+    REQUIRE_FALSE(expressionHandler.handleExpression(expr4).getResultBool());
+    REQUIRE(expressionHandler.handleExpression(expr5).getResultDouble() == 1);
+}
+
+TEST_CASE("Bool expression evaluation: right operand of Logical OR is skipped", "[Evaluator]") {
+    ExpressionHandler expressionHandler;
+
+    std::string expr1 = "var calls = 0";
+    std::string expr2 = "func bool touch(var bool value) {"
+                        "calls = calls + 1\n"
+                        "return value\n"
+                        "}";
+    std::string expr3 = "true || touch(false)";
+    std::string expr4 = "touch(true) || touch(false)";
+    std::string expr5 = "calls";
+
+    expressionHandler.handleExpression(expr1);
+    expressionHandler.handleExpression(expr2);
+
+    REQUIRE(expressionHandler.handleExpression(expr3).getResultBool());
+    REQUIRE(expressionHandler.handleExpression(expr4).getResultBool());
+    REQUIRE(expressionHandler.handleExpression(expr5).getResultDouble() == 1);
+}
+
+TEST_CASE("Bool expression evaluation: operands are evaluated left to right", "[Evaluator]") {
+    ExpressionHandler expressionHandler;
+
+    std::string expr1 = "var order = 0";
+    std::string expr2 = "func bool visit(var int id, var bool value) {"
+                        "order = order * 10 + id\n"
+                        "return value\n"
+                        "}";
+    std::string expr3 = "visit(1, false) || visit(2, true) && visit(3, false) || visit(4, true)";
+    std::string expr4 = "order";
+
+    expressionHandler.handleExpression(expr1);
+    expressionHandler.handleExpression(expr2);
+
+    REQUIRE(expressionHandler.handleExpression(expr3).getResultBool());
+    REQUIRE(expressionHandler.handleExpression(expr4).getResultDouble() == 1234);
+}
+
 TEST_CASE("Declare & assign bool expr to variable", "[Evaluator]") {
     ExpressionHandler expressionHandler;
 
@@ -1386,4 +1472,466 @@ TEST_CASE("Use built-in print function : pass bool expr", "[Evaluator]") {
     EvalResult result = expressionHandler.handleExpression(expr1);
     REQUIRE(result.getResultType() == ValueType::Bool);
     REQUIRE(result.getResultBool() == true);
-}
\ No newline at end of file
+}
+TEST_CASE("Recursive function call", "[Evaluator]") {
+    ExpressionHandler expressionHandler;
+
+    std::string expr1 = "func int fib(var int n) {"
+                       "if (n < 2) {"
+                       "    return n\n"
+                       "}\n"
+                       "return fib(n - 1) + fib(n - 2)\n"
+                       "}";
+    std::string expr2 = "fib(15)";
+
+    expressionHandler.handleExpression(expr1);
+
+    EvalResult result = expressionHandler.handleExpression(expr2);
+    REQUIRE(result.getResultType() == ValueType::Number);
+    REQUIRE(result.getResultDouble() == 610);
+}
+
+TEST_CASE("Stream results of for statement", "[Evaluator]") {
+    ExpressionHandler expressionHandler;
+
+    std::string expr1 = "func int square(var int x) {"
+                        "var result = x * x\n"
+                        "return result\n"
+                        "}";
+    std::string expr2 = "for (var i = 0; i < 4; i = i + 1) {"
+                        "if (i == 3) {"
+                        "break\n"
+                        "}\n"
+                        "square(i)\n"
+                        "i > 1\n"
+                        "}";
+
+    std::ostringstream output;
+    StreamResultSink sink(output);
+
+    expressionHandler.handleExpression(expr1, sink);
+    expressionHandler.handleExpression(expr2, sink);
+
+    REQUIRE(output.str() == "Declare func\n"
+                            "0\nfalse\n"
+                            "1\nfalse\n"
+                            "4\ntrue\n");
+}
+
+TEST_CASE("Discard results of for statement", "[Evaluator]") {
+    ExpressionHandler expressionHandler;
+
+    std::string expr1 = "var sum = 0";
+    std::string expr2 = "for (var i = 0; i < 1000; i = i + 1) {"
+                        "sum = sum + i\n"
+                        "}";
+    std::string expr3 = "sum";
+
+    DiscardResultSink sink;
+    expressionHandler.handleExpression(expr1, sink);
+    expressionHandler.handleExpression(expr2, sink);
+
+    EvalResult result = expressionHandler.handleExpression(expr3);
+    REQUIRE(result.getResultDouble() == 499500);
+}
+
+TEST_CASE("Evaluate else statement after not matched else if", "[Evaluator]") {
+    ExpressionHandler expressionHandler;
+
+    std::string expr1 = "var a = 5";
+    std::string expr2 = "if (a < 0) {"
+                        "1\n"
+                        "} else if (a == 0) {"
+                        "2\n"
+                        "} else {"
+                        "3\n"
+                        "}";
+
+    expressionHandler.handleExpression(expr1);
+
+    EvalResult result = expressionHandler.handleExpression(expr2);
+    REQUIRE(result.getResultType() == ValueType::Compound);
+    REQUIRE(result.getResultBlock()[0].getResultDouble() == 3);
+}
+
+TEST_CASE("Integer arithmetic stays exact above 2^53", "[Evaluator]") {
+    ExpressionHandler expressionHandler;
+
+    std::string expr1 = "var a = 9007199254740993";
+    std::string expr2 = "a * 2 - a + 2";
+
+    expressionHandler.handleExpression(expr1);
+
+    EvalResult result = expressionHandler.handleExpression(expr2);
+    REQUIRE(result.isResultInt());
+    REQUIRE(result.getResultInt() == 9007199254740995LL);
+}
+
+TEST_CASE("Integer division falls back to double when inexact", "[Evaluator]") {
+    ExpressionHandler expressionHandler;
+
+    EvalResult exactResult = expressionHandler.handleExpression("12 / 4");
+    REQUIRE(exactResult.isResultInt());
+    REQUIRE(exactResult.getResultInt() == 3);
+
+    EvalResult inexactResult = expressionHandler.handleExpression("7 / 2");
+    REQUIRE_FALSE(inexactResult.isResultInt());
+    REQUIRE(inexactResult.getResultDouble() == 3.5);
+}
+
+TEST_CASE("Integer overflow falls back to double", "[Evaluator]") {
+    ExpressionHandler expressionHandler;
+
+    EvalResult result = expressionHandler.handleExpression("9223372036854775807 + 1");
+    REQUIRE_FALSE(result.isResultInt());
+    REQUIRE(result.getResultDouble() == 9223372036854775808.0);
+}
+
+TEST_CASE("Loop counter and integer function results stay integer", "[Evaluator]") {
+    ExpressionHandler expressionHandler;
+
+    std::string expr1 = "func int fact(var int n) {"
+                        "if (n < 2) {"
+                        "return 1\n"
+                        "}\n"
+                        "return n * fact(n - 1)\n"
+                        "}";
+    std::string expr2 = "var sum = 0";
+    std::string expr3 = "for (var i = 1; i < 21; i = i + 1) {"
+                        "sum = sum + fact(i)\n"
+                        "}";
+    std::string expr4 = "sum";
+
+    expressionHandler.handleExpression(expr1);
+    expressionHandler.handleExpression(expr2);
+    expressionHandler.handleExpression(expr3);
+
+    EvalResult result = expressionHandler.handleExpression(expr4);
+    REQUIRE(result.isResultInt());
+    REQUIRE(result.getResultInt() == 2561327494111820313LL);
+}
+
+TEST_CASE("Stream integer results without exponent", "[Evaluator]") {
+    ExpressionHandler expressionHandler;
+
+    std::ostringstream output;
+    StreamResultSink sink(output);
+
+    expressionHandler.handleExpression("1000000 * 1000", sink);
+    expressionHandler.handleExpression("1 / 4", sink);
+
+    REQUIRE(output.str() == "1000000000\n0.25\n");
+}
+
+TEST_CASE("Profile function calls and loop iterations", "[Evaluator][Profiler]") {
+    ExpressionHandler expressionHandler;
+    Profiler profiler;
+    expressionHandler.setProfiler(&profiler);
+
+    std::string expr1 = "func int fib(var int n) {"
+                        "if (n < 2) {"
+                        "return n\n"
+                        "}\n"
+                        "return fib(n - 1) + fib(n - 2)\n"
+                        "}";
+    std::string expr2 = "var sum = 0";
+    std::string expr3 = "for (var i = 0; i < 5; i = i + 1) {"
+                        "if (i == 3) {"
+                        "break\n"
+                        "}\n"
+                        "sum = sum + fib(i)\n"
+                        "}";
+
+    expressionHandler.handleExpression(expr1);
+    expressionHandler.handleExpression(expr2);
+    expressionHandler.handleExpression(expr3);
+
+    // fib(0), fib(1) and fib(2) make 1 + 1 + 3 calls
+    unsigned long fibCalls = 0;
+    unsigned long topLevelCalls = 0;
+    for (const auto& currentFunc : profiler.getFunctionStats()) {
+        if (currentFunc.name == "fib") {
+            fibCalls = currentFunc.calls;
+            REQUIRE(currentFunc.line != 0);
+            REQUIRE(currentFunc.inclusiveSeconds >= 0);
+            REQUIRE(currentFunc.exclusiveSeconds <= currentFunc.inclusiveSeconds + 1e-9);
+        } else if (currentFunc.name == "<toplevel>") {
+            topLevelCalls = currentFunc.calls;
+        }
+    }
+    REQUIRE(fibCalls == 5);
+    REQUIRE(topLevelCalls == 3);
+
+    // the iteration left by break is not counted
+    const std::vector<Profiler::LoopStats>& loopStats = profiler.getLoopStats();
+    REQUIRE(loopStats.size() == 1);
+    REQUIRE(loopStats[0].iterations == 3);
+    REQUIRE(loopStats[0].function == "<toplevel>");
+
+    std::ostringstream foldedStacks;
+    profiler.writeFoldedStacks(foldedStacks);
+    REQUIRE(foldedStacks.str().find("<toplevel>;fib;fib") != std::string::npos);
+}
+
+TEST_CASE("Detached profiler records nothing", "[Evaluator][Profiler]") {
+    ExpressionHandler expressionHandler;
+    Profiler profiler;
+    expressionHandler.setProfiler(&profiler);
+    expressionHandler.setProfiler(nullptr);
+
+    expressionHandler.handleExpression("var sum = 0");
+    expressionHandler.handleExpression("for (var i = 0; i < 5; i = i + 1) {"
+                                       "sum = sum + i\n"
+                                       "}");
+
+    REQUIRE(profiler.getFunctionStats().empty());
+    REQUIRE(profiler.getLoopStats().empty());
+}
+
+TEST_CASE("Programs parsed from a lazy token container", "[Evaluator][TokenContainer]") {
+    std::string program = "func int fib(var int n) {\n"
+                          "    if (n < 2) {\n"
+                          "        return n\n"
+                          "    }\n"
+                          "    return fib(n - 1) + fib(n - 2)\n"
+                          "}\n"
+                          "var total = 0\n"
+                          "for (var i = 0; i < 10; i = i + 1) {\n"
+                          "    if (i == 3) {\n"
+                          "        total = total + fib(i)\n"
+                          "    }\n"
+                          "    else if (i > 7) {\n"
+                          "        total = total - -i\n"
+                          "    } else {\n"
+                          "        total = total + 1\n"
+                          "    }\n"
+                          "}\n"
+                          "total\n"
+                          "fib(total)";
+
+    // chunks of one char make every token straddle a refill, the parser looks back by one token at most
+    std::istringstream input(program);
+    ChunkReader reader(input, 1);
+    Lexer lexer;
+    TokenContainer tokens(lexer, reader, 2);
+    Parser parser;
+    ProgramTranslationNode* root = parser.parse(tokens);
+    SemanticAnalyzer semanticAnalyzer(0);
+    REQUIRE(!semanticAnalyzer.checkProgram(root).isError());
+
+    EvaluationEngine evaluator;
+    CollectResultSink sink;
+    for (const auto& currentStatement : root->statements) {
+        evaluator.Evaluate(currentStatement, sink);
+    }
+    REQUIRE(sink.getLastResult().getResultInt() == 121393);
+}
+
+#if !defined(TEST_VIRTUAL_MACHINE) && !defined(TEST_CLOSURE_ENGINE)
+TEST_CASE("Results of pure functions are reused", "[Evaluator]") {
+    std::string src = "func int fib(var int n) {\n"
+                      "    if (n < 2) {\n"
+                      "        return n\n"
+                      "    }\n"
+                      "    return fib(n - 1) + fib(n - 2)\n"
+                      "}\n"
+                      "func int printed(var int n) {\n"
+                      "    print(n)\n"
+                      "    return n\n"
+                      "}\n"
+                      "fib(25)\n"
+                      "printed(7)\n"
+                      "printed(7)\n";
+    src.push_back('\n');
+    src.push_back(EOF);
+
+    Lexer lexer;
+    Parser parser;
+    TokenContainer tokens = lexer.tokenize(src);
+    ProgramTranslationNode* root = parser.parse(tokens);
+    SemanticAnalyzer semanticAnalyzer(0);
+    REQUIRE(!semanticAnalyzer.checkProgram(root).isError());
+
+    // native code would run fib without the interpreter
+    Evaluator evaluator;
+    evaluator.setJitEnabled(false);
+    std::ostringstream output;
+    StreamResultSink sink(output);
+    for (const auto& currentStatement : root->statements) {
+        evaluator.Evaluate(currentStatement, sink);
+    }
+
+    // every fib(n) is computed once, printed is never looked up
+    REQUIRE(output.str() == "Declare func\nDeclare func\n75025\n7\n7\n");
+    REQUIRE(evaluator.getCallCache().getMisses() == 26);
+    REQUIRE(evaluator.getCallCache().getHits() == 23);
+    REQUIRE(evaluator.getCallCache().size() == 26);
+}
+
+namespace {
+    ProgramTranslationNode* parseRecursion(Parser& parser, SemanticAnalyzer& semanticAnalyzer) {
+        std::string src = "func int depth(var int n) {\n"
+                          "    if (n == 0) {\n"
+                          "        return 0\n"
+                          "    }\n"
+                          "    return depth(n - 1) + 1\n"
+                          "}\n"
+                          "func int count(var int n, var int acc) {\n"
+                          "    if (n == 0) {\n"
+                          "        return acc\n"
+                          "    }\n"
+                          "    return count(n - 1, acc + 1)\n"
+                          "}\n";
+        src.push_back('\n');
+        src.push_back(EOF);
+
+        Lexer lexer;
+        TokenContainer tokens = lexer.tokenize(src);
+        ProgramTranslationNode* root = parser.parse(tokens);
+        REQUIRE(!semanticAnalyzer.checkProgram(root).isError());
+
+        return root;
+    }
+
+    EvalResult evaluateCall(Evaluator& evaluator, Parser& parser, SemanticAnalyzer& semanticAnalyzer,
+                            const std::string& call) {
+        std::string src = call;
+        src.push_back('\n');
+        src.push_back(EOF);
+
+        Lexer lexer;
+        TokenContainer tokens = lexer.tokenize(src);
+        ProgramTranslationNode* root = parser.parse(tokens);
+        REQUIRE(!semanticAnalyzer.checkProgram(root).isError());
+
+        return evaluator.Evaluate(root->statements[0]);
+    }
+}
+
+TEST_CASE("Calls in tail position don't nest", "[Evaluator]") {
+    Parser parser;
+    SemanticAnalyzer semanticAnalyzer(0);
+    ProgramTranslationNode* root = parseRecursion(parser, semanticAnalyzer);
+
+    // native code and the cache would hide the interpreted recursion
+    Evaluator evaluator;
+    evaluator.setJitEnabled(false);
+    evaluator.setMemoEnabled(false);
+    evaluator.setMaxCallDepth(100);
+    for (const auto& currentStatement : root->statements) {
+        evaluator.Evaluate(currentStatement);
+    }
+
+    REQUIRE(evaluateCall(evaluator, parser, semanticAnalyzer, "count(200000, 0)").getResultInt() == 200000);
+}
+
+TEST_CASE("Calls deeper than the limit throw", "[Evaluator]") {
+    Parser parser;
+    SemanticAnalyzer semanticAnalyzer(0);
+    ProgramTranslationNode* root = parseRecursion(parser, semanticAnalyzer);
+
+    Evaluator evaluator;
+    evaluator.setJitEnabled(false);
+    evaluator.setMemoEnabled(false);
+    evaluator.setMaxCallDepth(100);
+    for (const auto& currentStatement : root->statements) {
+        evaluator.Evaluate(currentStatement);
+    }
+
+    REQUIRE(evaluateCall(evaluator, parser, semanticAnalyzer, "depth(99)").getResultInt() == 99);
+    REQUIRE_THROWS_AS(evaluateCall(evaluator, parser, semanticAnalyzer, "depth(100)"), std::runtime_error);
+    // the failed call leaves nothing behind
+    REQUIRE(evaluateCall(evaluator, parser, semanticAnalyzer, "depth(99)").getResultInt() == 99);
+}
+
+TEST_CASE("Native frames count against the call depth limit", "[Evaluator]") {
+    Parser parser;
+    SemanticAnalyzer semanticAnalyzer(0);
+    ProgramTranslationNode* root = parseRecursion(parser, semanticAnalyzer);
+
+    Evaluator evaluator;
+    evaluator.setMemoEnabled(false);
+    evaluator.setMaxCallDepth(100);
+    for (const auto& currentStatement : root->statements) {
+        evaluator.Evaluate(currentStatement);
+    }
+
+    REQUIRE(evaluateCall(evaluator, parser, semanticAnalyzer, "depth(99)").getResultInt() == 99);
+    REQUIRE(evaluator.getNativeCallsCount() == 1);
+    REQUIRE_THROWS_AS(evaluateCall(evaluator, parser, semanticAnalyzer, "depth(100)"), std::runtime_error);
+}
+
+TEST_CASE("Calls deeper than the native stack continue in stack segments", "[Evaluator]") {
+    Parser parser;
+    SemanticAnalyzer semanticAnalyzer(0);
+    ProgramTranslationNode* root = parseRecursion(parser, semanticAnalyzer);
+
+    Evaluator evaluator;
+    evaluator.setJitEnabled(false);
+    evaluator.setMemoEnabled(false);
+    for (const auto& currentStatement : root->statements) {
+        evaluator.Evaluate(currentStatement);
+    }
+
+    REQUIRE(evaluateCall(evaluator, parser, semanticAnalyzer, "depth(50000)").getResultInt() == 50000);
+
+    // the global keeps the function away from native code and the cache, nested blocks make frames larger
+    evaluateCall(evaluator, parser, semanticAnalyzer, "var step = 1");
+    evaluateCall(evaluator, parser, semanticAnalyzer, "func int nested(var int n) {\n"
+                                                      "    for (var i = 0; i < 1; i = i + 1) {\n"
+                                                      "        if (n > 0) {\n"
+                                                      "            for (var j = 0; j < 1; j = j + 1) {\n"
+                                                      "                if (j == 0) {\n"
+                                                      "                    return nested(n - step) + 1\n"
+                                                      "                }\n"
+                                                      "            }\n"
+                                                      "        }\n"
+                                                      "    }\n"
+                                                      "    return 0\n"
+                                                      "}");
+    evaluator.setJitEnabled(true);
+    evaluator.setMemoEnabled(true);
+    REQUIRE(evaluateCall(evaluator, parser, semanticAnalyzer, "nested(20000)").getResultInt() == 20000);
+    REQUIRE(evaluator.getNativeCallsCount() == 0);
+}
+#endif
+
+#if defined(TEST_CLOSURE_ENGINE)
+TEST_CASE("Calls deeper than the native stack allows throw", "[ClosureEngine]") {
+    ExpressionHandler handler;
+    handler.handleExpression("func int depth(var int n) {\n"
+                             "    if (n == 0) {\n"
+                             "        return 0\n"
+                             "    }\n"
+                             "    return depth(n - 1) + 1\n"
+                             "}");
+
+    REQUIRE_THROWS_AS(handler.handleExpression("depth(1000000)"), std::runtime_error);
+    // the failed call leaves nothing behind
+    REQUIRE(handler.handleExpression("depth(1000)").getResultInt() == 1000);
+}
+
+TEST_CASE("Calls deeper than the limit throw", "[ClosureEngine]") {
+    Parser parser;
+    std::string src = "func int depth(var int n) {\n"
+                      "    if (n == 0) {\n"
+                      "        return 0\n"
+                      "    }\n"
+                      "    return depth(n - 1) + 1\n"
+                      "}\n"
+                      "depth(99)\n"
+                      "depth(100)\n";
+    src.push_back(EOF);
+    Lexer lexer;
+    TokenContainer tokens = lexer.tokenize(src);
+    ProgramTranslationNode* root = parser.parse(tokens);
+    SemanticAnalyzer semanticAnalyzer(0);
+    REQUIRE(!semanticAnalyzer.checkProgram(root).isError());
+
+    ClosureEngine engine;
+    engine.setMaxCallDepth(100);
+    engine.Evaluate(root->statements[0]);
+    REQUIRE(engine.Evaluate(root->statements[1]).getResultInt() == 99);
+    REQUIRE_THROWS_AS(engine.Evaluate(root->statements[2]), std::runtime_error);
+}
+#endif
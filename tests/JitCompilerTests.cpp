@@ -0,0 +1,266 @@
+#include <fstream>
+#include <sstream>
+#include "catch.hpp"
+#include "../Lexer.h"
+#include "../Parser.h"
+#include "../ASTNode.h"
+#include "../TokenContainer.h"
+#include "../SemanticAnalyzer.h"
+#include "../Evaluator.h"
+#include "../ResultSink.h"
+#include "../JitCompiler.h"
+
+namespace {
+    std::string readSample(const std::string& fileName) {
+        const std::string delimiter = "\n----\n";
+        std::ifstream ifs(fileName);
+        std::stringstream ss;
+        ss << ifs.rdbuf();
+        const std::string& input = ss.str();
+        return input.substr(0, input.find(delimiter));
+    }
+
+    ProgramTranslationNode* parseProgram(Parser& parser, const std::string& src) {
+        std::string input = src;
+        input.push_back('\n');
+        input.push_back(EOF);
+
+        Lexer lexer;
+        TokenContainer tokens = lexer.tokenize(input);
+        ProgramTranslationNode* root = parser.parse(tokens);
+
+        SemanticAnalyzer semanticAnalyzer(0);
+        SemanticAnalysisResult checkResult = semanticAnalyzer.checkProgram(root);
+        if (checkResult.isError()) {
+            throw std::runtime_error(checkResult.what());
+        }
+
+        return root;
+    }
+
+    std::string evaluateProgram(const std::string& src, bool isJitEnabled) {
+        Parser parser;
+        ProgramTranslationNode* root = parseProgram(parser, src);
+
+        Evaluator evaluator;
+        evaluator.setJitEnabled(isJitEnabled);
+        std::ostringstream output;
+        StreamResultSink sink(output);
+        for (const auto& currentStatement : root->statements) {
+            evaluator.Evaluate(currentStatement, sink);
+        }
+
+        return output.str();
+    }
+
+    void matchInterpreter(const std::string& src) {
+        REQUIRE(evaluateProgram(src, true) == evaluateProgram(src, false));
+    }
+
+    // names of the declared functions the JIT translated
+    std::vector<std::string> getTranslatedFunctions(const std::string& src) {
+        Parser parser;
+        ProgramTranslationNode* root = parseProgram(parser, src);
+
+        JitCompiler jit;
+        std::vector<std::string> names;
+        for (const auto& currentStatement : root->statements) {
+            if (currentStatement->type == NodeType::DeclFunc) {
+                DeclFuncNode* func = static_cast<DeclFuncNode*>(currentStatement);
+                if (jit.compile(func)) {
+                    names.emplace_back(func->name);
+                }
+            }
+        }
+
+        return names;
+    }
+}
+
+TEST_CASE("Numeric functions are translated to native code", "[JIT]") {
+    const std::string src = "func int fib(var int n) {\n"
+                            "    if (n < 2) {\n"
+                            "        return n\n"
+                            "    }\n"
+                            "    return fib(n - 1) + fib(n - 2)\n"
+                            "}\n"
+                            "func bool isEven(var int n) {\n"
+                            "    return n / 2 * 2 == n\n"
+                            "}\n"
+                            "func int sumEven(var int n) {\n"
+                            "    var sum = 0\n"
+                            "    for (var i = 0; i < n; i = i + 1) {\n"
+                            "        if (isEven(i) && i > 0 || false) {\n"
+                            "            sum = sum + i\n"
+                            "        }\n"
+                            "    }\n"
+                            "    return sum\n"
+                            "}\n"
+                            "var g = 1\n"
+                            "func int readGlobal(var int n) {\n"
+                            "    return n + g\n"
+                            "}\n"
+                            "func int printed(var int n) {\n"
+                            "    print(n)\n"
+                            "    return n\n"
+                            "}\n"
+                            "func void noValue() {\n"
+                            "    return\n"
+                            "}\n";
+
+    REQUIRE(getTranslatedFunctions(src) == std::vector<std::string>{"fib", "isEven", "sumEven"});
+}
+
+TEST_CASE("Native functions give the same results as the interpreter", "[JIT]") {
+    matchInterpreter("func int fib(var int n) {\n"
+                     "    if (n < 2) {\n"
+                     "        return n\n"
+                     "    }\n"
+                     "    return fib(n - 1) + fib(n - 2)\n"
+                     "}\n"
+                     "func int gcd(var int a, var int b) {\n"
+                     "    for (var step = 0; step < 100; step = step + 1) {\n"
+                     "        if (b == 0) {\n"
+                     "            break\n"
+                     "        }\n"
+                     "        var r = a - a / b * b\n"
+                     "        a = b\n"
+                     "        b = r\n"
+                     "    }\n"
+                     "    return a\n"
+                     "}\n"
+                     "func bool between(var int x, var int low, var int high) {\n"
+                     "    return x > low && x < high\n"
+                     "}\n"
+                     "fib(20)\n"
+                     "gcd(1071, 462)\n"
+                     "gcd(-48, 18)\n"
+                     "between(fib(10), 50, 60)\n"
+                     "between(-5, 0, 10)\n");
+}
+
+TEST_CASE("Results that leave int64 fall back to the interpreter", "[JIT]") {
+    matchInterpreter("func int fact(var int n) {\n"
+                     "    if (n < 2) {\n"
+                     "        return 1\n"
+                     "    }\n"
+                     "    return n * fact(n - 1)\n"
+                     "}\n"
+                     "func int half(var int n) {\n"
+                     "    return n / 2\n"
+                     "}\n"
+                     "func int depth(var int n) {\n"
+                     "    if (n == 0) {\n"
+                     "        return 0\n"
+                     "    }\n"
+                     "    return depth(n - 1) + 1\n"
+                     "}\n"
+                     "func int noReturn(var int n) {\n"
+                     "    if (n > 0) {\n"
+                     "        return n\n"
+                     "    }\n"
+                     "}\n"
+                     "fact(20)\n"
+                     "fact(25)\n"
+                     "half(8)\n"
+                     "half(7)\n"
+                     "half(2.5)\n"
+                     "depth(2000)\n"
+                     "noReturn(-1)\n");
+}
+
+TEST_CASE("Samples give the same results with native functions", "[JIT]") {
+    // ComplainTest runs forever
+    const std::vector<std::string> samples{"DeclAssignVar", "FuncCalls", "IfStatements", "ForLoopStatements",
+                                           "Recursion", "ShortCircuit"};
+    for (const auto& currentSample : samples) {
+        INFO(currentSample);
+        matchInterpreter(readSample("./LanguageSamples/" + currentSample));
+    }
+}
+
+TEST_CASE("Redeclared functions replace their native code", "[JIT]") {
+    Parser firstParser;
+    ProgramTranslationNode* first = parseProgram(firstParser, "func int f(var int n) {\n"
+                                                              "    return n + 1\n"
+                                                              "}\n"
+                                                              "func int g(var int n) {\n"
+                                                              "    return f(n) * 2\n"
+                                                              "}\n");
+    Parser secondParser;
+    ProgramTranslationNode* second = parseProgram(secondParser, "func int f(var int n) {\n"
+                                                                "    return n + 2\n"
+                                                                "}\n");
+    Parser thirdParser;
+    ProgramTranslationNode* third = parseProgram(thirdParser, "func int f(var int n) {\n"
+                                                              "    print(n)\n"
+                                                              "    return n\n"
+                                                              "}\n");
+
+    Parser fourthParser;
+    ProgramTranslationNode* fourth = parseProgram(fourthParser, "func void f(var int n) {\n"
+                                                                "    n = n + 1\n"
+                                                                "}\n");
+
+    JitCompiler jit;
+    for (const auto& currentStatement : first->statements) {
+        REQUIRE(jit.compile(static_cast<DeclFuncNode*>(currentStatement)));
+    }
+    REQUIRE(jit.getFunction("g") != nullptr);
+
+    long long result;
+    REQUIRE(jit.compile(static_cast<DeclFuncNode*>(second->statements[0])));
+    REQUIRE(JitCompiler::call(jit.getFunction("f"), {5}, JitCompiler::maxCallDepth, result));
+    REQUIRE(result == 7);
+    // g called the old code of f
+    REQUIRE(jit.getFunction("g") == nullptr);
+
+    REQUIRE_FALSE(jit.compile(static_cast<DeclFuncNode*>(third->statements[0])));
+    REQUIRE(jit.getFunction("f") == nullptr);
+
+    // a signature the JIT doesn't handle releases the old code as well
+    REQUIRE(jit.compile(static_cast<DeclFuncNode*>(second->statements[0])));
+    REQUIRE(jit.compile(static_cast<DeclFuncNode*>(first->statements[1])));
+    REQUIRE_FALSE(jit.compile(static_cast<DeclFuncNode*>(fourth->statements[0])));
+    REQUIRE(jit.getFunction("f") == nullptr);
+    REQUIRE(jit.getFunction("g") == nullptr);
+}
+
+TEST_CASE("Calls made after a native bail-out are interpreted", "[JIT]") {
+    Parser parser;
+    ProgramTranslationNode* root = parseProgram(parser, "func int depth(var int n) {\n"
+                                                        "    if (n == 0) {\n"
+                                                        "        return 0\n"
+                                                        "    }\n"
+                                                        "    return depth(n - 1) + 1\n"
+                                                        "}\n"
+                                                        "func int fact(var int n) {\n"
+                                                        "    if (n < 2) {\n"
+                                                        "        return 1\n"
+                                                        "    }\n"
+                                                        "    return n * fact(n - 1)\n"
+                                                        "}\n"
+                                                        "func int countDown(var int n) {\n"
+                                                        "    if (n > 0) {\n"
+                                                        "        return countDown(n - 1)\n"
+                                                        "    }\n"
+                                                        "}\n"
+                                                        "depth(3000)\n"
+                                                        "fact(25)\n"
+                                                        "countDown(3000)\n"
+                                                        "depth(10)\n");
+
+    Evaluator evaluator;
+    evaluator.setMemoEnabled(false);
+    // every call below the one that bailed out would run out of native depth again
+    std::vector<unsigned long> nativeCalls;
+    for (const auto& currentStatement : root->statements) {
+        unsigned long oldCount = evaluator.getNativeCallsCount();
+        evaluator.Evaluate(currentStatement);
+        if (currentStatement->type == NodeType::FuncCall) {
+            nativeCalls.emplace_back(evaluator.getNativeCallsCount() - oldCount);
+        }
+    }
+
+    REQUIRE(nativeCalls == std::vector<unsigned long>{1, 1, 1, 1});
+}
@@ -1,9 +1,13 @@
 #include "catch.hpp"
 #include "../Lexer.h"
+#include "../CharScanner.h"
+#include "../ChunkReader.h"
 #include "../TokenContainer.h"
 #include "../Token.h"
 #include "../Identifier.h"
+#include <sstream>
 #include <vector>
+#include <unistd.h>
 
 Lexer LexerTestsLexer;
 
@@ -770,4 +774,257 @@ TEST_CASE("Tokenize passing value along with unary minus after comma", "[Lexer]"
     properTokens.emplace_back(Token{TokenType::eof, "EOF"});
 
     matchTokens(tokens, properTokens);
-}
\ No newline at end of file
+}
+TEST_CASE("Keywords are only matched as whole words", "[Lexer]") {
+    std::string expr = "var variable = iff + for_1 - returns\nelse";
+    expr.push_back(EOF);
+
+    const TokenContainer& data = LexerTestsLexer.tokenize(expr);
+    const std::vector<Token>& tokens = data.getTokens();
+
+    std::vector<Token> properTokens;
+    properTokens.emplace_back(Token{TokenType::DeclareId, "var"});
+    properTokens.emplace_back(Token{TokenType::Id, "variable"});
+    properTokens.emplace_back(Token{TokenType::Assign, "="});
+    properTokens.emplace_back(Token{TokenType::Id, "iff"});
+    properTokens.emplace_back(Token{TokenType::Add, "+"});
+    properTokens.emplace_back(Token{TokenType::Id, "for_1"});
+    properTokens.emplace_back(Token{TokenType::Sub, "-"});
+    properTokens.emplace_back(Token{TokenType::Id, "returns"});
+    properTokens.emplace_back(Token{TokenType::NL, "\n"});
+    properTokens.emplace_back(Token{TokenType::ElseStmt, "else"});
+    properTokens.emplace_back(Token{TokenType::eof, "EOF"});
+
+    matchTokens(tokens, properTokens);
+}
+
+TEST_CASE("Invalid chars are reported", "[Lexer]") {
+    std::string expr = "a & b";
+    expr.push_back(EOF);
+    REQUIRE_THROWS_WITH(LexerTestsLexer.tokenize(expr), "Invalid char '&'");
+
+    expr = "a = .5";
+    expr.push_back(EOF);
+    REQUIRE_THROWS_WITH(LexerTestsLexer.tokenize(expr), "Invalid char '.'");
+
+    expr = "a = 1\t";
+    expr.push_back(EOF);
+    REQUIRE_THROWS_WITH(LexerTestsLexer.tokenize(expr), "Invalid char '\t'");
+}
+
+TEST_CASE("Every keyword is recognized, words sharing its length and ends are not", "[Lexer]") {
+    std::string expr = "var func bool int void return break false true if else for "
+                       "vxr fxnc bxxl ixt vxxd rxxxxn bxxxk fxxxe txxe ixf exxe fxr";
+    expr.push_back(EOF);
+
+    const TokenContainer& data = LexerTestsLexer.tokenize(expr);
+    const std::vector<Token>& tokens = data.getTokens();
+
+    std::vector<Token> properTokens;
+    properTokens.emplace_back(Token{TokenType::DeclareId, "var"});
+    properTokens.emplace_back(Token{TokenType::DeclareFunc, "func"});
+    properTokens.emplace_back(Token{TokenType::BoolType, "bool"});
+    properTokens.emplace_back(Token{TokenType::IntType, "int"});
+    properTokens.emplace_back(Token{TokenType::FuncReturnVoid, "void"});
+    properTokens.emplace_back(Token{TokenType::Return, "return"});
+    properTokens.emplace_back(Token{TokenType::Break, "break"});
+    properTokens.emplace_back(Token{TokenType::Bool, "0"});
+    properTokens.emplace_back(Token{TokenType::Bool, "1"});
+    properTokens.emplace_back(Token{TokenType::IfStmt, "if"});
+    properTokens.emplace_back(Token{TokenType::ElseStmt, "else"});
+    properTokens.emplace_back(Token{TokenType::ForLoopStmt, "for"});
+    for (const char* currentWord : {"vxr", "fxnc", "bxxl", "ixt", "vxxd", "rxxxxn", "bxxxk", "fxxxe", "txxe", "ixf",
+                                    "exxe", "fxr"}) {
+        properTokens.emplace_back(Token{TokenType::Id, currentWord});
+    }
+    properTokens.emplace_back(Token{TokenType::eof, "EOF"});
+
+    matchTokens(tokens, properTokens);
+}
+
+TEST_CASE("Vector scanners find the same run ends as the scalar one", "[Lexer][CharScanner]") {
+    CharScanner scalarScanner(ScanKind::Scalar);
+
+    // runs of every length around the 16 and 32 byte vector widths, ended by every kind of char
+    std::string src;
+    for (unsigned long currentLength = 0; currentLength != 70; currentLength++) {
+        src += std::string(currentLength, ' ') + "x";
+        for (unsigned long currentChar = 0; currentChar != currentLength; currentChar++) {
+            src.push_back("aZ_09q"[currentChar % 6]);
+        }
+        src += currentLength % 2 == 0 ? "(" : "\xe9";
+        for (unsigned long currentChar = 0; currentChar != currentLength; currentChar++) {
+            src.push_back("0123.9"[currentChar % 6]);
+        }
+        src += "@`[{/:";
+    }
+
+    for (ScanKind::Type currentKind : {ScanKind::SSE2, ScanKind::AVX2}) {
+        if (!CharScanner::isSupported(currentKind)) {
+            continue;
+        }
+        CharScanner scanner(currentKind);
+
+        const char* begin = src.data();
+        // every end checks that vector loads stop before it
+        for (const char* end : {begin + src.size(), begin + src.size() / 2, begin + 17}) {
+            for (const char* currentChar = begin; currentChar < end; currentChar++) {
+                REQUIRE(scanner.skipSpaces(currentChar, end) == scalarScanner.skipSpaces(currentChar, end));
+                REQUIRE(scanner.skipWord(currentChar, end) == scalarScanner.skipWord(currentChar, end));
+                REQUIRE(scanner.skipNumber(currentChar, end) == scalarScanner.skipNumber(currentChar, end));
+            }
+        }
+    }
+}
+
+TEST_CASE("Tokens do not depend on the scan kind", "[Lexer][CharScanner]") {
+    std::string expr = "var a_very_long_identifier_name_that_spans_vectors = 1234567890123456789012345678901234.5\n"
+                       "                                          print(a_very_long_identifier_name_that_spans_vectors)";
+    expr.push_back(EOF);
+
+    Lexer scalarLexer(ScanKind::Scalar);
+    const TokenContainer& properData = scalarLexer.tokenize(expr);
+    const std::vector<Token>& properTokens = properData.getTokens();
+    REQUIRE(properTokens.size() == 10);
+
+    for (ScanKind::Type currentKind : {ScanKind::SSE2, ScanKind::AVX2}) {
+        if (CharScanner::isSupported(currentKind)) {
+            Lexer lexer(currentKind);
+            const TokenContainer& data = lexer.tokenize(expr);
+            matchTokens(data.getTokens(), properTokens);
+        }
+    }
+}
+
+TEST_CASE("Chunked input gives the same tokens for every chunk size", "[Lexer][ChunkReader]") {
+    std::string program = "func int fib(var int n) {\n"
+                          "    if (n < 2) {\n"
+                          "        return n\n"
+                          "    }\n"
+                          "    return fib(n - 1) + fib(n - 2)\n"
+                          "}\n"
+                          "var a_long_identifier_straddling_chunks = -fib(10) * 2.75\n"
+                          "print(a_long_identifier_straddling_chunks == 0 || false && true)";
+
+    std::string src = program + "\n";
+    src.push_back(EOF);
+    Lexer stringLexer;
+    const TokenContainer& properData = stringLexer.tokenize(src);
+    const std::vector<Token>& properTokens = properData.getTokens();
+
+    for (unsigned long currentChunkSize = 1; currentChunkSize != 40; currentChunkSize++) {
+        std::istringstream input(program);
+        ChunkReader reader(input, currentChunkSize);
+        Lexer lexer;
+        const TokenContainer& data = lexer.tokenize(reader);
+        const std::vector<Token>& tokens = data.getTokens();
+
+        matchTokens(tokens, properTokens);
+        for (unsigned long currentTokenNum = 0; currentTokenNum != tokens.size(); currentTokenNum++) {
+            REQUIRE(tokens[currentTokenNum].line == properTokens[currentTokenNum].line);
+        }
+        // one chunk plus the longest token
+        REQUIRE(reader.getCapacity() <= currentChunkSize + 40);
+        // the "\n" and EOF appended at the end are consumed as well
+        REQUIRE(reader.getConsumedSize() == program.size() + 2);
+    }
+}
+
+TEST_CASE("Chunked input is read from a file descriptor", "[Lexer][ChunkReader]") {
+    int fds[2];
+    REQUIRE(pipe(fds) == 0);
+    std::string program = "var x = 10\nprint(x - 1)";
+    REQUIRE(write(fds[1], program.data(), program.size()) == static_cast<ssize_t>(program.size()));
+    close(fds[1]);
+
+    ChunkReader reader(fds[0], 4);
+    const TokenContainer& data = LexerTestsLexer.tokenize(reader);
+    close(fds[0]);
+
+    std::vector<Token> properTokens;
+    properTokens.emplace_back(Token{TokenType::DeclareId, "var"});
+    properTokens.emplace_back(Token{TokenType::Id, "x"});
+    properTokens.emplace_back(Token{TokenType::Assign, "="});
+    properTokens.emplace_back(Token{TokenType::Number, "10"});
+    properTokens.emplace_back(Token{TokenType::NL, "\n"});
+    properTokens.emplace_back(Token{TokenType::FuncCall, "print"});
+    properTokens.emplace_back(Token{TokenType::ROUND_BRACKET_START, "("});
+    properTokens.emplace_back(Token{TokenType::Id, "x"});
+    properTokens.emplace_back(Token{TokenType::Sub, "-"});
+    properTokens.emplace_back(Token{TokenType::Number, "1"});
+    properTokens.emplace_back(Token{TokenType::ROUND_BRACKET_END, ")"});
+    properTokens.emplace_back(Token{TokenType::NL, "\n"});
+    properTokens.emplace_back(Token{TokenType::eof, "EOF"});
+
+    matchTokens(data.getTokens(), properTokens);
+}
+
+TEST_CASE("Lazy container lexes the same tokens as the eager one", "[Lexer][TokenContainer]") {
+    std::string program = "func int twice(var int n) {\n"
+                          "    return n * 2\n"
+                          "}\n"
+                          "var a_long_identifier_straddling_chunks = -twice(21) - 0.5\n"
+                          "print(a_long_identifier_straddling_chunks)";
+
+    std::string src = program + "\n";
+    src.push_back(EOF);
+    Lexer eagerLexer;
+    const TokenContainer& properData = eagerLexer.tokenize(src);
+    const std::vector<Token>& properTokens = properData.getTokens();
+
+    for (unsigned long currentChunkSize : {1ul, 3ul, 16ul, 4096ul}) {
+        std::istringstream input(program);
+        ChunkReader reader(input, currentChunkSize);
+        Lexer lexer;
+        TokenContainer tokens(lexer, reader, 4);
+
+        for (const auto& properToken : properTokens) {
+            REQUIRE(tokens.lookNextToken().Type == properToken.Type);
+
+            // one step back is always inside the window
+            const Token& token = tokens.getNextToken();
+            tokens.returnToken();
+            REQUIRE(&tokens.getNextToken() == &token);
+
+            REQUIRE(token.Type == properToken.Type);
+            REQUIRE(token.Value == properToken.Value);
+            REQUIRE(token.line == properToken.line);
+        }
+        REQUIRE(tokens.getNextToken().Type == TokenType::eof);
+        REQUIRE(tokens.size() == properTokens.size() + 1);
+    }
+}
+
+TEST_CASE("Lazy container lexes only as far as it is read", "[Lexer][TokenContainer]") {
+    std::istringstream input("var x = 1\n" + std::string(1000, ' ') + "$");
+    ChunkReader reader(input, 16);
+    Lexer lexer;
+    TokenContainer tokens(lexer, reader, 4);
+
+    for (unsigned long currentTokenNum = 0; currentTokenNum != 5; currentTokenNum++) {
+        tokens.getNextToken();
+    }
+    REQUIRE(tokens.size() == 5);
+    REQUIRE(!reader.isFinished());
+    REQUIRE(reader.getCapacity() <= 32);
+
+    REQUIRE_THROWS_WITH(tokens.lookNextToken(), "Invalid char '$'");
+}
+
+TEST_CASE("Tokens can't be returned past the lazy container window", "[Lexer][TokenContainer]") {
+    std::istringstream input("a + b + c + d + e");
+    ChunkReader reader(input);
+    Lexer lexer;
+    TokenContainer tokens(lexer, reader, 4);
+
+    for (unsigned long currentTokenNum = 0; currentTokenNum != 8; currentTokenNum++) {
+        tokens.getNextToken();
+    }
+    for (unsigned long currentTokenNum = 0; currentTokenNum != 4; currentTokenNum++) {
+        tokens.returnToken();
+    }
+    REQUIRE(tokens.lookNextToken().Value == "c");
+
+    tokens.returnToken();
+    REQUIRE_THROWS_WITH(tokens.lookNextToken(), "Token 3 left the token window");
+}
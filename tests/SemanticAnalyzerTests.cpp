@@ -14,30 +14,24 @@ private:
 
     static Parser parser;
 
-    SemanticAnalyzer semanticAnalyzer = SemanticAnalyzer(0);
-
-    std::vector<ProgramTranslationNode*> nodes;
+    SemanticAnalyzer semanticAnalyzer{0};
 public:
     SemanticAnalysisResult handleExpression(const std::string src) {
         std::string expr = src;
         expr.push_back('\n');
         expr.push_back(EOF);
 
-        const TokenContainer& tokens = lexer.tokenize(expr);
+        TokenContainer tokens = lexer.tokenize(expr);
 
         ProgramTranslationNode* root = parser.parse(tokens);
 
         const SemanticAnalysisResult& analysisResult = semanticAnalyzer.checkProgram(root);
 
-        nodes.emplace_back(root);
-
         return analysisResult;
     }
 
     ~ExpressionHandler() {
-        for (const auto& currentStmt : nodes) {
-            delete currentStmt;
-        }
+        parser.getArena().release();
     }
 };
 
@@ -1131,4 +1125,75 @@ TEST_CASE("Assert print function can not take as parameter itself", "[SemanticAn
     const SemanticAnalysisResult& result = expressionHandler.handleExpression(expr);
     REQUIRE(result.isError());
     REQUIRE(result.errorCode == SemanticAnalysisResult::INVALID_VALUE_TYPE);
-}
\ No newline at end of file
+}
+TEST_CASE("Assert function can call itself", "[SemanticAnalyzer]") {
+    ExpressionHandler expressionHandler;
+
+    std::string expr = "func int fact(var int n) {"
+                       "if (n < 2) {"
+                       "    return 1\n"
+                       "}\n"
+                       "return n * fact(n - 1)\n"
+                       "}";
+
+    const SemanticAnalysisResult& result = expressionHandler.handleExpression(expr);
+    REQUIRE(!result.isError());
+}
+
+TEST_CASE("Assert function with invalid body is not declared", "[SemanticAnalyzer]") {
+    ExpressionHandler expressionHandler;
+
+    std::string expr1 = "func int getInt() {"
+                        "return true\n"
+                        "}";
+    std::string expr2 = "getInt()";
+
+    expressionHandler.handleExpression(expr1);
+
+    const SemanticAnalysisResult& result = expressionHandler.handleExpression(expr2);
+    REQUIRE(result.errorCode == SemanticAnalysisResult::UNDECLARED_FUNC);
+}
+
+TEST_CASE("Assert functions without globals and print are pure", "[SemanticAnalyzer]") {
+    std::string src = "var g = 1\n"
+                      "func int fib(var int n) {\n"
+                      "    if (n < 2) {\n"
+                      "        return n\n"
+                      "    }\n"
+                      "    return fib(n - 1) + fib(n - 2)\n"
+                      "}\n"
+                      "func int twice(var int n) {\n"
+                      "    var result = fib(n)\n"
+                      "    return result * 2\n"
+                      "}\n"
+                      "func int readGlobal(var int n) {\n"
+                      "    return n + g\n"
+                      "}\n"
+                      "func void writeGlobal(var int n) {\n"
+                      "    g = n\n"
+                      "}\n"
+                      "func int printed(var int n) {\n"
+                      "    print(n)\n"
+                      "    return n\n"
+                      "}\n"
+                      "func int callsImpure(var int n) {\n"
+                      "    return printed(n)\n"
+                      "}\n";
+    src.push_back('\n');
+    src.push_back(EOF);
+
+    Lexer lexer;
+    Parser parser;
+    TokenContainer tokens = lexer.tokenize(src);
+    ProgramTranslationNode* root = parser.parse(tokens);
+    SemanticAnalyzer semanticAnalyzer(0);
+    REQUIRE(!semanticAnalyzer.checkProgram(root).isError());
+
+    std::vector<std::string> pureFunctions;
+    for (const auto& currentStatement : root->statements) {
+        if (currentStatement->type == NodeType::DeclFunc && static_cast<DeclFuncNode*>(currentStatement)->isPure) {
+            pureFunctions.emplace_back(static_cast<DeclFuncNode*>(currentStatement)->name);
+        }
+    }
+    REQUIRE(pureFunctions == std::vector<std::string>{"fib", "twice"});
+}